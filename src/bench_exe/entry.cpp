@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2026 Daniel Meszaros
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <std/Arena.h>
+#include <std/Benchmark.hpp>
+#include <std/Check.h>
+#include <std/Chronometry.h>
+#include <std/log.h>
+#include <std/Slice.hpp>
+#include <std/SliceUtils.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+SnBench *gSnBenchFirst = nullptr;
+SnBench *gSnBenchPrev = nullptr;
+f64 gSnBenchMinSeconds = 0.5;
+
+// Benchmarks work on large inputs; let the scratch arenas grow on demand
+static const size_t SIZ_ARENA_RESERVE =
+    sizeof(void *) == 8 ? size_t(16) << 30 : size_t(512) << 20;
+
+extern "C" void checkFail(const char *pExpr, const char *pFile, unsigned line) {
+  log_fatal("\n  Assertion failed: %s\n    at %s:%u\n", pExpr, pFile, line);
+  abort();
+}
+
+extern "C" void handleOOM(Arena *arena) {
+  log_fatal("\n  Arena %p is out of memory", arena);
+  abort();
+}
+
+void snBenchReport(const char *caseName,
+                   u64 numItems,
+                   const SnBenchSample &sample) {
+  printf("  %-44s %12.3f us %12.3f us (mean)", caseName,
+         sample.secondsBest * 1e6, sample.secondsMean * 1e6);
+  if (numItems != 0) {
+    f64 itemsPerSecond = f64(numItems) / sample.secondsBest;
+    printf(" %10.2f Mitems/s", itemsPerSecond / 1e6);
+  }
+  printf(" [%llu iterations]\n", (unsigned long long)sample.numIterations);
+  fflush(stdout);
+}
+
+void snBenchReportValue(const char *caseName, f64 value, const char *unit) {
+  printf("  %-44s %12.2f %s\n", caseName, value, unit);
+  fflush(stdout);
+}
+
+int main(int numArgs, char **arrArgs) {
+  Slice<char> suiteNameFilter;
+
+  for (int idxArg = 1; idxArg < numArgs; idxArg++) {
+    Slice<char> arg = fromCStr(arrArgs[idxArg]);
+
+    if (arg.startsWith(sliceFromConstChar("--suite="))) {
+      suiteNameFilter = arg.subarray(arg.indexOf('=').value());
+      suiteNameFilter.shift();  // eat '='
+
+      printf("Benchmark suite filter: \"%.*s\"\n", FMT_SLICE(suiteNameFilter));
+    } else if (arg.startsWith(sliceFromConstChar("--min-time="))) {
+      gSnBenchMinSeconds = atof(arrArgs[idxArg] + strlen("--min-time="));
+    }
+  }
+
+  Arena arena0 = createGrowableArena(SIZ_ARENA_RESERVE);
+  Arena arena1 = createGrowableArena(SIZ_ARENA_RESERVE);
+  CHECK(arena0.reserveBeg != nullptr && arena1.reserveBeg != nullptr);
+  setAllocatorsForThread(&arena0, &arena1);
+
+  for (SnBench *cur = gSnBenchFirst; cur != nullptr; cur = cur->next) {
+    const SnBenchMetadata *meta = cur->metadata;
+    if (!suiteNameFilter.empty() &&
+        fromCStr(meta->suiteName) != suiteNameFilter) {
+      continue;
+    }
+
+    printf("[%s] %s\n", meta->suiteName, meta->name);
+
+    Arena arena0Saved = arena0;
+    Arena arena1Saved = arena1;
+    cur->pfnBench();
+    restoreArena(&arena0, arena0Saved);
+    restoreArena(&arena1, arena1Saved);
+  }
+
+  setAllocatorsForThread(nullptr, nullptr);
+  destroyGrowableArena(&arena1);
+  destroyGrowableArena(&arena0);
+
+  log_shutdown();
+  return 0;
+}
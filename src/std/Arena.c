@@ -10,10 +10,20 @@
 #include "std/Check.h"
 #include "std/Sanitizer.h"
 #include "std/Types.h"
+#include "std/log.h"
+#include "std/os/OsInfo.h"
 
 #include <stdint.h>
 #include <string.h>
 
+#if SN_STD_SYSTEM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #if SN_GCC || SN_CLANG
 #define SN_STD_LIKELY(Expr) __builtin_expect((Expr), 1)
 #define SN_STD_UNLIKELY(Expr) __builtin_expect((Expr), 0)
@@ -22,6 +32,169 @@
 #define SN_STD_UNLIKELY(Expr) (Expr)
 #endif
 
+/** Growable arenas commit at least this many bytes at once. */
+#define ARENA_COMMIT_GRANULARITY ((size_t)64 * 1024)
+/** Growable arenas never commit more than this many bytes at once. */
+#define ARENA_COMMIT_STEP_MAX ((size_t)16 * 1024 * 1024)
+/**
+ * Number of bytes below the restored state that stay committed, so that an
+ * arena that is repeatedly reset around a page boundary doesn't thrash.
+ */
+#define ARENA_DECOMMIT_SLACK ARENA_COMMIT_GRANULARITY
+
+static size_t getPageSize(void) {
+  static size_t sizPage = 0;
+  if (sizPage == 0) {
+#if SN_STD_SYSTEM_WINDOWS
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    sizPage = info.dwPageSize;
+#else
+    long rc = sysconf(_SC_PAGESIZE);
+    sizPage = rc > 0 ? (size_t)rc : 4096;
+#endif
+  }
+
+  return sizPage;
+}
+
+#if SN_STD_SYSTEM_WINDOWS
+static u8 *reserveAddressSpace(size_t siz) {
+  return (u8 *)VirtualAlloc(NULL, siz, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+static int commitPages(u8 *addr, size_t siz) {
+  return VirtualAlloc(addr, siz, MEM_COMMIT, PAGE_READWRITE) != NULL;
+}
+
+static void decommitPages(u8 *addr, size_t siz) {
+  BOOL rc = VirtualFree(addr, siz, MEM_DECOMMIT);
+  DCHECK(rc);
+  (void)rc;
+}
+
+static void releaseAddressSpace(u8 *addr, size_t siz) {
+  (void)siz;
+  BOOL rc = VirtualFree(addr, 0, MEM_RELEASE);
+  DCHECK(rc);
+  (void)rc;
+}
+#else
+static u8 *reserveAddressSpace(size_t siz) {
+  void *addr = mmap(NULL, siz, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (addr == MAP_FAILED) {
+    return NULL;
+  }
+
+  return (u8 *)addr;
+}
+
+static int commitPages(u8 *addr, size_t siz) {
+  return mprotect(addr, siz, PROT_READ | PROT_WRITE) == 0;
+}
+
+static void decommitPages(u8 *addr, size_t siz) {
+  // Give the pages back to the OS, then make the range inaccessible again so
+  // that stray accesses fault instead of silently committing memory
+  int rc = madvise(addr, siz, MADV_DONTNEED);
+  DCHECK(rc == 0);
+  rc = mprotect(addr, siz, PROT_NONE);
+  DCHECK(rc == 0);
+  (void)rc;
+}
+
+static void releaseAddressSpace(u8 *addr, size_t siz) {
+  int rc = munmap(addr, siz);
+  DCHECK(rc == 0);
+  (void)rc;
+}
+#endif
+
+/**
+ * Commits pages below `a->beg` so that at least `sizRequired` bytes are
+ * available below `a->end`.
+ * \returns A value indicating whether the arena has grown
+ */
+static int growArena(Arena *a, size_t sizRequired) {
+  if (a->reserveBeg == NULL) {
+    return 0;
+  }
+
+  size_t sizReservable = (size_t)(a->end - a->reserveBeg);
+  if (sizRequired > sizReservable) {
+    return 0;
+  }
+
+  const size_t sizPage = getPageSize();
+  const size_t sizCommitted = (size_t)(a->reserveEnd - a->beg);
+
+  // The committed size grows geometrically, up to a limit
+  size_t sizStep = sizCommitted;
+  if (sizStep < ARENA_COMMIT_GRANULARITY) {
+    sizStep = ARENA_COMMIT_GRANULARITY;
+  } else if (sizStep > ARENA_COMMIT_STEP_MAX) {
+    sizStep = ARENA_COMMIT_STEP_MAX;
+  }
+
+  uintptr_t begRequired = (uintptr_t)a->end - sizRequired;
+  uintptr_t begNew = (uintptr_t)a->beg - sizStep;
+  if (sizStep > (size_t)(a->beg - a->reserveBeg)) {
+    begNew = (uintptr_t)a->reserveBeg;
+  }
+
+  if (begRequired < begNew) {
+    begNew = begRequired;
+  }
+
+  begNew &= ~(uintptr_t)(sizPage - 1);
+  if (begNew < (uintptr_t)a->reserveBeg) {
+    begNew = (uintptr_t)a->reserveBeg;
+  }
+
+  DCHECK(begNew < (uintptr_t)a->beg);
+  if (!commitPages((u8 *)begNew, (uintptr_t)a->beg - begNew)) {
+    return 0;
+  }
+
+  a->beg = (u8 *)begNew;
+  return 1;
+}
+
+/**
+ * Updates the committed range of a growable arena that has just been restored
+ * to a saved state; `begCommitted` is where the committed range began before
+ * the restore.
+ */
+static void syncCommittedRange(Arena *a, u8 *begCommitted) {
+  if (begCommitted == a->beg) {
+    return;
+  }
+
+  if (a->beg < begCommitted) {
+    // Restored to a state that had more memory committed than we currently
+    // have; this can happen when states are restored out of order
+    int ok = commitPages(a->beg, (size_t)(begCommitted - a->beg));
+    CHECK(ok);
+    return;
+  }
+
+  // Keep some of the pages committed after the saved state
+  u8 *begKeep = a->reserveBeg;
+  if ((size_t)(a->beg - a->reserveBeg) > ARENA_DECOMMIT_SLACK) {
+    begKeep = a->beg - ARENA_DECOMMIT_SLACK;
+  }
+
+  if (begKeep < begCommitted) {
+    begKeep = begCommitted;
+  }
+
+  if (begCommitted < begKeep) {
+    decommitPages(begCommitted, (size_t)(begKeep - begCommitted));
+  }
+
+  a->beg = begKeep;
+}
+
 static u8 *allocImpl(Arena *a,
                      size_t sizObj,
                      size_t sizAlign,
@@ -52,7 +225,11 @@ static u8 *allocImpl(Arena *a,
       }
     }
 
-    handleOOM(a);
+    // Worst case padding needed to align the allocation
+    size_t sizRequired = sizAlloc + (sizAlign - 1);
+    if (sizRequired < sizAlloc || !growArena(a, sizRequired)) {
+      handleOOM(a);
+    }
   } while (1);
 
   a->end -= pad;
@@ -86,7 +263,69 @@ u8 *alloc(Arena *a, size_t sizObj, size_t sizAlign, size_t numObjects) {
 void restoreArena(Arena *dst, Arena saved) {
   u8 *regionStart = dst->end;
   u8 *regionEnd = saved.end;
-  SN_ASAN_POISON(regionStart, regionEnd - regionStart);
+  if (regionStart < regionEnd) {
+    SN_ASAN_POISON(regionStart, regionEnd - regionStart);
+  } else {
+    // Restoring out of order; the allocations in the saved state are live
+    // again
+    SN_ASAN_UNPOISON(regionEnd, regionStart - regionEnd);
+  }
 
+  u8 *begCommitted = dst->beg;
   *dst = saved;
+
+  if (dst->reserveBeg != NULL) {
+    syncCommittedRange(dst, begCommitted);
+  }
+}
+
+Arena createGrowableArena(size_t sizReserve) {
+  Arena ret = {NULL, NULL, NULL, NULL};
+
+  const size_t sizPage = getPageSize();
+  if (sizReserve == 0 || sizReserve > SIZE_MAX - sizPage) {
+    return ret;
+  }
+
+  sizReserve = (sizReserve + sizPage - 1) & ~(sizPage - 1);
+  u8 *base = reserveAddressSpace(sizReserve);
+  if (base == NULL) {
+    return ret;
+  }
+
+  // Nothing is committed until the first allocation
+  ret.reserveBeg = base;
+  ret.reserveEnd = base + sizReserve;
+  ret.beg = ret.reserveEnd;
+  ret.end = ret.reserveEnd;
+  return ret;
+}
+
+void destroyGrowableArena(Arena *arena) {
+  DCHECK(arena->reserveBeg != NULL);
+  if (arena->reserveBeg == NULL) {
+    return;
+  }
+
+  // The address range may be handed out again by the OS; don't leave our
+  // poisoning behind
+  SN_ASAN_UNPOISON(arena->reserveBeg,
+                   (size_t)(arena->reserveEnd - arena->reserveBeg));
+  releaseAddressSpace(arena->reserveBeg,
+                      (size_t)(arena->reserveEnd - arena->reserveBeg));
+
+  arena->beg = arena->end = NULL;
+  arena->reserveBeg = arena->reserveEnd = NULL;
+}
+
+#if SN_MSVC
+void handleOOMDefault(Arena *arena) {
+  log_fatal("Arena %p is out of memory", (void *)arena);
+  NOTREACHED();
+}
+#else  /* !SN_MSVC */
+SN_STD_WEAK_SYMBOL void handleOOM(Arena *arena) {
+  log_fatal("Arena %p is out of memory", (void *)arena);
+  NOTREACHED();
 }
+#endif /* !SN_MSVC */
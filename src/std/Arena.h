@@ -31,6 +31,14 @@ struct Arena {
   u8 *beg;
   u8 *end;
 
+  /**
+   * Bounds of the address space reserved for a growable arena, or NULL for
+   * arenas over a fixed buffer. `[beg, reserveEnd)` is committed memory;
+   * `[reserveBeg, beg)` is reserved but not yet backed by pages.
+   */
+  u8 *reserveBeg;
+  u8 *reserveEnd;
+
 #if __cplusplus
   struct Scope;
 #endif
@@ -112,8 +120,43 @@ u8 *allocNZ(Arena *arena, size_t sizObject, size_t sizAlign, size_t numObjects);
  */
 SN_STD_API ArenaSaved getScratch(Arena **pConflicts, u32 numConflicts);
 SN_STD_API void setAllocatorsForThread(Arena *arena0, Arena *arena1);
+
+/**
+ * \brief Called when an allocation can't be satisfied by the arena.
+ *
+ * The library provides a default implementation that fails a CHECK; it can be
+ * overridden by defining this function in the program. If the handler returns,
+ * the allocation is retried, so the handler must either make space in the arena
+ * or not return.
+ */
 void handleOOM(Arena *arena);
 
+/**
+ * \brief Creates an arena that reserves `sizReserve` bytes of address space
+ * and commits pages on demand as allocations need them.
+ *
+ * Restoring the arena to an earlier state (`restoreArena`, `Arena::Scope`,
+ * `releaseScratch`) decommits the pages that were committed after that state
+ * was saved, so the resident memory drops back after a burst of allocations.
+ * The arena is out of memory only once the whole reservation is in use.
+ *
+ * On platforms without virtual memory (Emscripten), the reservation is backed
+ * by memory up front.
+ *
+ * \param sizReserve Size of the address space to reserve; rounded up to the
+ * page size.
+ *
+ * \returns The new arena, or an arena with a NULL `reserveBeg` if the address
+ * space couldn't be reserved.
+ */
+Arena createGrowableArena(size_t sizReserve);
+
+/**
+ * \brief Releases the address space of an arena created by
+ * `createGrowableArena`. Every allocation made from the arena is invalidated.
+ */
+void destroyGrowableArena(Arena *arena);
+
 static inline ArenaSaved getScratchFor(Arena *arena) {
   return getScratch(&arena, 1);
 }
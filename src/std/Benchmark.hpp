@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2026 Daniel Meszaros
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "std/Chronometry.h"
+#include "std/CompilerInfo.h"
+#include "std/Types.h"
+
+#ifndef SN_BENCH_EXECUTABLE
+#define SN_BENCH_EXECUTABLE 0
+#endif
+
+struct SnBench;
+extern SnBench *gSnBenchFirst;
+extern SnBench *gSnBenchPrev;
+
+/** Minimum amount of time spent measuring a single case, in seconds. */
+extern f64 gSnBenchMinSeconds;
+
+struct SnBenchMetadata {
+  const char *suiteName;
+  const char *name;
+
+  const char *file;
+  int line;
+};
+
+struct SnBench {
+  SnBench *next;
+  const SnBenchMetadata *metadata;
+
+  void (*pfnBench)(void);
+
+  SnBench(const SnBenchMetadata *metadata, void (*pfnBench)(void))
+      : next(nullptr), metadata(metadata), pfnBench(pfnBench) {
+    if (gSnBenchFirst != nullptr) {
+      gSnBenchPrev->next = this;
+      gSnBenchPrev = this;
+    } else {
+      gSnBenchFirst = gSnBenchPrev = this;
+    }
+  }
+};
+
+struct SnBenchSample {
+  u64 numIterations;
+  // Duration of the fastest iteration
+  f64 secondsBest;
+  // Average duration of an iteration
+  f64 secondsMean;
+};
+
+/**
+ * \brief Prints the results of a measurement. Implemented by the benchmark
+ * executable.
+ *
+ * \param numItems Number of items processed in one iteration; used to compute
+ * the throughput. Pass 0 if it doesn't make sense for the case.
+ */
+void snBenchReport(const char *caseName,
+                   u64 numItems,
+                   const SnBenchSample &sample);
+
+/**
+ * \brief Prints a quantity other than time that was measured for a case, like
+ * memory use. Implemented by the benchmark executable.
+ */
+void snBenchReportValue(const char *caseName, f64 value, const char *unit);
+
+/**
+ * \brief Measures `fn` by calling it repeatedly, for at least
+ * `gSnBenchMinSeconds` and at least three times, then reports the results.
+ *
+ * `setup` is called before every iteration and is not included in the
+ * measurement; use it to restore the input that `fn` has modified.
+ */
+template <typename Setup, typename Fn>
+void snBenchMeasure(const char *caseName,
+                    u64 numItems,
+                    const Setup &setup,
+                    const Fn &fn) {
+  SnBenchSample sample = {
+      .numIterations = 0,
+      .secondsBest = 0,
+      .secondsMean = 0,
+  };
+  f64 secondsTotal = 0;
+
+  while (sample.numIterations < 3 || secondsTotal < gSnBenchMinSeconds) {
+    setup();
+
+    TimePoint t0 = chrono_getCurrentTime();
+    fn();
+    TimePoint t1 = chrono_getCurrentTime();
+
+    f64 seconds = chrono_secondsBetween(t0, t1);
+    if (sample.numIterations == 0 || seconds < sample.secondsBest) {
+      sample.secondsBest = seconds;
+    }
+    secondsTotal += seconds;
+    sample.numIterations++;
+  }
+
+  sample.secondsMean = secondsTotal / f64(sample.numIterations);
+  snBenchReport(caseName, numItems, sample);
+}
+
+/**
+ * \brief Measures `fn` by calling it repeatedly; see the other overload.
+ */
+template <typename Fn>
+void snBenchMeasure(const char *caseName, u64 numItems, const Fn &fn) {
+  snBenchMeasure(caseName, numItems, [] {}, fn);
+}
+
+/**
+ * \brief Keeps the compiler from optimizing away the computation of `value`.
+ */
+template <typename T>
+inline void snBenchDoNotOptimize(const T &value) {
+#if SN_GCC || SN_CLANG
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static const T *volatile sink;
+  sink = &value;
+#endif
+}
+
+#define SN_BENCH_STRINGIFY2(X) #X
+#define SN_BENCH_STRINGIFY(X) SN_BENCH_STRINGIFY2(X)
+
+/** \brief Declares a benchmark function */
+#define SN_BENCH_DECL_FUNC(SuiteName, BenchName) \
+  static void bench_func_##SuiteName##_##BenchName(void)
+
+#if SN_BENCH_EXECUTABLE
+/** \brief Creates a benchmark definition */
+#define SN_BENCH_DEFINE_DESC(SuiteName, BenchName)                     \
+  static const SnBenchMetadata bench_meta_##SuiteName##_##BenchName = { \
+      .suiteName = SN_BENCH_STRINGIFY(SuiteName),                       \
+      .name = SN_BENCH_STRINGIFY(BenchName),                            \
+      .file = __FILE__,                                                 \
+      .line = __LINE__,                                                 \
+  };                                                                    \
+  static SnBench bench_##SuiteName##_##BenchName =                      \
+      SnBench(&bench_meta_##SuiteName##_##BenchName,                    \
+              bench_func_##SuiteName##_##BenchName)
+#else
+#define SN_BENCH_DEFINE_DESC(SuiteName, BenchName)
+#endif
+
+/**
+ * \brief Defines a benchmark. The body sets up its input and calls
+ * `snBenchMeasure` once for every case it wants to report.
+ */
+#define SN_BENCH(SuiteName, BenchName)        \
+  SN_BENCH_DECL_FUNC(SuiteName, BenchName);   \
+  SN_BENCH_DEFINE_DESC(SuiteName, BenchName); \
+  static void bench_func_##SuiteName##_##BenchName(void)
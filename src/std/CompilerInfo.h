@@ -21,6 +21,7 @@
 
 #define SN_FORCEINLINE __attribute__((always_inline)) inline
 #define SN_STD_WEAK_SYMBOL __attribute__((weak))
+#define SN_PREFETCH(addr) __builtin_prefetch(addr)
 
 #elif defined(__GNUC__) || defined(__GNUG__)
 #define SN_COMPILER SN_COMPILER_GCC
@@ -30,6 +31,7 @@
 
 #define SN_FORCEINLINE __attribute__((always_inline)) inline
 #define SN_STD_WEAK_SYMBOL __attribute__((weak))
+#define SN_PREFETCH(addr) __builtin_prefetch(addr)
 
 #elif defined(_MSC_VER)
 #define SN_COMPILER SN_COMPILER_MSVC
@@ -39,6 +41,12 @@
 
 #define SN_FORCEINLINE __forceinline
 #define SN_STD_WEAK_SYMBOL
+#if defined(_M_X64) || defined(_M_IX86)
+#include <xmmintrin.h>
+#define SN_PREFETCH(addr) _mm_prefetch((const char *)(addr), _MM_HINT_T0)
+#else
+#define SN_PREFETCH(addr) ((void)(addr))
+#endif
 
 #else
 #define SN_COMPILER SN_COMPILER_UNKNOWN
@@ -48,4 +56,5 @@
 
 #define SN_FORCEINLINE inline
 #define SN_STD_WEAK_SYMBOL
+#define SN_PREFETCH(addr) ((void)(addr))
 #endif
@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2026 Daniel Meszaros
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <std/Arena.h>
+#include <std/SwissMap.hpp>
+#include <std/SwissTable.hpp>
+#include <std/Types.h>
+
+#include <atomic>
+#include <new>
+#include <thread>
+#include <type_traits>
+
+namespace impl {
+/**
+ * \brief Entry of a slot that was claimed by an insertion whose key and value
+ * are not written yet. Lookups never match it and probe past it.
+ */
+static const u64 CW_ENTRY_BUSY = 0xFF;
+}  // namespace impl
+
+/**
+ * \brief A Swiss table of trivially copyable keys and values that many
+ * threads can insert into and look up in at the same time.
+ *
+ * Lookups take no lock: they load the control word of every group they probe
+ * with acquire semantics and only match slots whose key and value were
+ * published before. Insertions take the spin lock of the stripe that the home
+ * group of the key falls into, so two threads can't insert the same key
+ * twice, then claim an unused slot with a CAS on its control word.
+ *
+ * The capacity is fixed when the map is created; the table never grows and
+ * keys are never removed, so pointers to values stay valid for the lifetime
+ * of the arena.
+ *
+ * \tparam K Key type
+ * \tparam V Value type
+ * \tparam Hasher Function object that maps a key to a 64-bit hash; see
+ * `DefaultHash`
+ */
+template <typename K, typename V, typename Hasher = DefaultHash<K>>
+struct ConcurrentSwissMap {
+  static_assert(std::is_trivially_copyable_v<K> &&
+                    std::is_trivially_copyable_v<V>,
+                "Keys and values must be trivially copyable");
+
+  struct Slot {
+    K key;
+    V value;
+  };
+
+  struct alignas(64) Stripe {
+    std::atomic<bool> lock;
+  };
+
+  /** \brief Largest number of lock stripes */
+  static constexpr size_t MAX_STRIPES = 256;
+
+  /** \brief Control word of each group */
+  std::atomic<u64> *controlWords = nullptr;
+  /** \brief Slots of each group; slot `j` of group `i` is `slots[8 * i + j]` */
+  Slot *slots = nullptr;
+  /** \brief Insertion locks; group `i` belongs to stripe `i % numStripes` */
+  Stripe *stripes = nullptr;
+  /** \brief Number of groups in the table; always a power of two */
+  size_t numGroups = 0;
+  /** \brief Number of lock stripes; always a power of two */
+  size_t numStripes = 0;
+
+  /**
+   * \brief Initializes a map that can hold at least `capacity` keys, with its
+   * control words and slots allocated from the provided arena.
+   *
+   * The map must be created before it's shared with other threads.
+   */
+  ConcurrentSwissMap(Arena *arena, size_t capacity) {
+    DCHECK(arena != nullptr);
+    // Keep the load factor at most 7/8 when the map holds `capacity` keys
+    numGroups = 1;
+    while (numGroups * 7 < capacity) {
+      numGroups *= 2;
+    }
+    numStripes = numGroups < MAX_STRIPES ? numGroups : MAX_STRIPES;
+
+    controlWords = alloc<std::atomic<u64>>(arena, numGroups);
+    slots = alloc<Slot>(arena, numGroups * 8);
+    stripes = alloc<Stripe>(arena, numStripes);
+    for (size_t i = 0; i < numGroups; i++) {
+      new (&controlWords[i]) std::atomic<u64>(impl::CW_MASK_EMPTY);
+    }
+    for (size_t i = 0; i < numStripes; i++) {
+      new (&stripes[i].lock) std::atomic<bool>(false);
+    }
+  }
+
+  /**
+   * \brief Looks up a key in the map and returns a pointer to the associated
+   * value. Never blocks.
+   * \returns A valid pointer to the associated value if the key is present in
+   * the map, or nullptr.
+   */
+  V *get(const K &key) const {
+    u64 h1;
+    u8 h2;
+    impl::splitHash(Hasher{}(key), h1, h2);
+
+    const size_t MASK = numGroups - 1;
+    const size_t homeGroup = impl::homeGroup(h1, numGroups);
+    for (size_t i = 0; i < numGroups; i++) {
+      size_t group = (homeGroup + i) & MASK;
+      u64 controlWord = controlWords[group].load(std::memory_order_acquire);
+
+      Slot *slot = _findWithinGroup(group, controlWord, key, h2);
+      if (slot != nullptr) {
+        return &slot->value;
+      }
+
+      // Unused slots are only ever claimed, never given back, so an insertion
+      // of the key would have taken this one
+      if (impl::hasUnusedSlot(controlWord)) {
+        return nullptr;
+      }
+    }
+
+    return nullptr;
+  }
+
+  /**
+   * \brief Inserts the key with the specified value if it's not in the map
+   * yet; an existing value is left untouched.
+   * \param inserted If not null, receives whether the key was inserted
+   * \returns A valid pointer to the value associated with the key, or nullptr
+   * if the key is not in the map and the map is full
+   */
+  V *insert(const K &key, const V &value, bool *inserted = nullptr) {
+    u64 h1;
+    u8 h2;
+    impl::splitHash(Hasher{}(key), h1, h2);
+
+    const size_t MASK = numGroups - 1;
+    const size_t homeGroup = impl::homeGroup(h1, numGroups);
+    std::atomic<bool> &lock = stripes[homeGroup & (numStripes - 1)].lock;
+    while (lock.exchange(true, std::memory_order_acquire)) {
+      while (lock.load(std::memory_order_relaxed)) {
+        std::this_thread::yield();
+      }
+    }
+
+    // Every insertion of this key holds the lock, so if the key is not found
+    // here, nobody else can insert it until we're done
+    Slot *slot = nullptr;
+    size_t i = 0;
+    for (; i < numGroups; i++) {
+      size_t group = (homeGroup + i) & MASK;
+      u64 controlWord = controlWords[group].load(std::memory_order_acquire);
+
+      slot = _findWithinGroup(group, controlWord, key, h2);
+      if (slot != nullptr || impl::hasUnusedSlot(controlWord)) {
+        break;
+      }
+    }
+
+    bool isNew = false;
+    if (slot == nullptr) {
+      // Keys of other stripes may take the unused slots in the meantime, in
+      // which case the probe continues into the next groups
+      for (; i < numGroups && slot == nullptr; i++) {
+        size_t group = (homeGroup + i) & MASK;
+        u8 idxSlot;
+        if (_claimUnusedSlot(controlWords[group], idxSlot)) {
+          slot = &slots[group * 8 + idxSlot];
+          slot->key = key;
+          slot->value = value;
+          _publish(controlWords[group], idxSlot, h2);
+          isNew = true;
+        }
+      }
+    }
+
+    lock.store(false, std::memory_order_release);
+
+    if (inserted != nullptr) {
+      *inserted = isNew;
+    }
+    return slot != nullptr ? &slot->value : nullptr;
+  }
+
+  Slot *_findWithinGroup(size_t idxGroup,
+                         u64 controlWord,
+                         const K &key,
+                         u8 h2) const {
+    u8 candidateMask = impl::hasKey(controlWord, h2);
+    while (candidateMask != 0) {
+      u8 idxSlot = u8(7 - countTrailingZeros(candidateMask));
+      Slot *slot = &slots[idxGroup * 8 + idxSlot];
+      if (impl::keysEqual(slot->key, key)) {
+        return slot;
+      }
+
+      candidateMask &= candidateMask - 1;
+    }
+
+    return nullptr;
+  }
+
+  /**
+   * \brief Marks the first unused slot of the group busy.
+   * \returns false if the group has no unused slot left
+   */
+  static bool _claimUnusedSlot(std::atomic<u64> &controlWord, u8 &idxSlot) {
+    u64 expected = controlWord.load(std::memory_order_relaxed);
+    for (;;) {
+      u8 unusedMask = impl::hasKey(expected, u8(impl::CW_ENTRY_UNUSED));
+      if (unusedMask == 0) {
+        return false;
+      }
+
+      // Slot 0 is the most significant bit of the mask
+      idxSlot = u8(countLeadingZeros(u32(unusedMask)) - 24);
+      u64 desired = expected;
+      impl::setSlotEntry(desired, idxSlot, u8(impl::CW_ENTRY_BUSY));
+      if (controlWord.compare_exchange_weak(expected, desired,
+                                            std::memory_order_acquire,
+                                            std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+  }
+
+  /**
+   * \brief Replaces the busy entry of a slot with `h2`, making its key and
+   * value visible to lookups.
+   */
+  static void _publish(std::atomic<u64> &controlWord, u8 idxSlot, u8 h2) {
+    // Other slots of the group may change concurrently
+    u64 expected = controlWord.load(std::memory_order_relaxed);
+    u64 desired;
+    do {
+      desired = expected;
+      impl::setSlotEntry(desired, idxSlot, h2);
+    } while (!controlWord.compare_exchange_weak(expected, desired,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed));
+  }
+};
@@ -0,0 +1,552 @@
+/*
+ * Copyright (c) 2026 Daniel Meszaros
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <std/Arena.h>
+#include <std/CompilerInfo.h>
+#include <std/Hash.h>
+#include <std/SliceUtils.hpp>
+#include <std/SwissTable.hpp>
+#include <std/Types.h>
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace impl {
+/** \brief Number of slots in a group of a `FlatSwissTable` */
+static const size_t GROUP16_WIDTH = 16;
+
+/**
+ * \brief Compares every control byte of a group against `value`.
+ * \param controlBytes Control bytes of the group; must be 16-byte aligned
+ * \returns A 16-bit mask where bit `i` is set if control byte `i` is equal to
+ * `value`.
+ */
+static inline u32 matchControlBytes16(const u8 *controlBytes, u8 value) {
+#if defined(__SSE2__) || defined(_M_X64)
+  __m128i group =
+      _mm_load_si128(reinterpret_cast<const __m128i *>(controlBytes));
+  __m128i res = _mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(value)));
+  return u32(_mm_movemask_epi8(res));
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  static const u8 bitOfLane[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                   1, 2, 4, 8, 16, 32, 64, 128};
+  uint8x16_t res = vceqq_u8(vld1q_u8(controlBytes), vdupq_n_u8(value));
+  uint8x16_t bits = vandq_u8(res, vld1q_u8(bitOfLane));
+  return u32(vaddv_u8(vget_low_u8(bits))) |
+         (u32(vaddv_u8(vget_high_u8(bits))) << 8);
+#else
+  u32 ret = 0;
+  for (u32 i = 0; i < GROUP16_WIDTH; i++) {
+    ret |= u32(controlBytes[i] == value) << i;
+  }
+  return ret;
+#endif
+}
+
+/**
+ * \brief Finds the slots of a group whose control byte is equal to `h2`.
+ * \returns A 16-bit mask where bit `i` is set if slot `i` may hold the key.
+ */
+static inline u32 hasKey16(const u8 *controlBytes, u8 h2) {
+  return matchControlBytes16(controlBytes, h2);
+}
+
+/**
+ * \brief Finds the unused slots of a group.
+ * \returns A 16-bit mask where bit `i` is set if slot `i` was never used.
+ */
+static inline u32 unusedSlots16(const u8 *controlBytes) {
+  return matchControlBytes16(controlBytes, u8(CW_ENTRY_UNUSED));
+}
+
+/**
+ * \brief Finds the empty slots (either unused or deleted) of a group.
+ * \returns A 16-bit mask where bit `i` is set if slot `i` is empty.
+ */
+static inline u32 emptySlots16(const u8 *controlBytes) {
+#if defined(__SSE2__) || defined(_M_X64)
+  // Empty entries are exactly the ones with their MSB set
+  __m128i group =
+      _mm_load_si128(reinterpret_cast<const __m128i *>(controlBytes));
+  return u32(_mm_movemask_epi8(group));
+#else
+  return matchControlBytes16(controlBytes, u8(CW_ENTRY_UNUSED)) |
+         matchControlBytes16(controlBytes, u8(CW_ENTRY_DELETED));
+#endif
+}
+
+/**
+ * \brief Control bytes and slots of a Swiss table with 16-wide groups; shared
+ * by `FlatSwissTable`, `SwissMap` and `SwissSet`.
+ *
+ * Lookups and insertions are split into a probe and a fill step, so that the
+ * tables built on top of it decide how keys are compared and stored.
+ *
+ * \tparam Slot Slot type; must be trivially copyable
+ * \tparam SlotHash Function object that returns the hash of the key held by a
+ * slot; used when the table is rehashed
+ */
+template <typename Slot, typename SlotHash>
+struct FlatTable {
+  /** \brief Arena used to allocate control bytes and slots */
+  Arena *arena;
+  /** \brief Control bytes of every slot; `numGroups * 16` entries */
+  u8 *controlBytes = nullptr;
+  /** \brief Slots of every group; `numGroups * 16` entries */
+  Slot *slots = nullptr;
+  /** \brief Number of groups; always zero or a power of two */
+  size_t numGroups = 0;
+  /** \brief Number of keys in the table */
+  size_t numEntries = 0;
+  /** \brief Number of unused slots that can be filled before growing */
+  size_t growthLeft = 0;
+
+  FlatTable(Arena *arena) : arena(arena) {}
+
+  /**
+   * \brief Makes room for at least `n` keys, so that inserting that many keys
+   * doesn't rehash the table.
+   */
+  void reserve(size_t n) {
+    size_t numGroupsNew = 1;
+    while (_maxEntriesForCapacity(numGroupsNew * GROUP16_WIDTH) < n) {
+      numGroupsNew *= 2;
+    }
+
+    if (numGroupsNew > numGroups) {
+      _resize(numGroupsNew);
+    }
+  }
+
+  /** \brief Number of slots in the table */
+  size_t _capacity() const { return numGroups * GROUP16_WIDTH; }
+
+  bool _empty() const { return numGroups == 0; }
+
+  /**
+   * \brief Number of slots that can be filled while keeping the load factor
+   * at or below 7/8.
+   */
+  static size_t _maxEntriesForCapacity(size_t capacity) {
+    return capacity - capacity / 8;
+  }
+
+  /**
+   * \brief Finds the slot of a key.
+   * \param isKey Called with the candidate slots whose control byte matches
+   * the hash; returns whether the slot holds the key
+   * \returns The slot holding the key, or nullptr
+   */
+  template <typename IsKey>
+  Slot *_find(u64 hash, const IsKey &isKey) {
+    if (_empty()) {
+      return nullptr;
+    }
+
+    const size_t MASK = numGroups - 1;
+
+    u64 h1;
+    u8 h2;
+    splitHash(hash, h1, h2);
+
+    size_t group = h1 & MASK;
+    // Triangular probing visits every group when their number is a power of
+    // two
+    for (size_t i = 1; i <= numGroups; i++) {
+      const u8 *groupControlBytes = &controlBytes[group * GROUP16_WIDTH];
+      Slot *groupSlots = &slots[group * GROUP16_WIDTH];
+
+      u32 candidateMask = hasKey16(groupControlBytes, h2);
+      while (candidateMask != 0) {
+        Slot &slot = groupSlots[countTrailingZeros(candidateMask)];
+        if (isKey(slot)) {
+          return &slot;
+        }
+        candidateMask &= candidateMask - 1;
+      }
+
+      if (unusedSlots16(groupControlBytes) != 0) {
+        // An insertion would have used that slot, therefore the key is not
+        // present
+        return nullptr;
+      }
+
+      group = (group + i) & MASK;
+    }
+
+    return nullptr;
+  }
+
+  /** \brief Number of keys `_findBatch` processes together */
+  static constexpr size_t FIND_BATCH_SIZE = 16;
+  /** \brief `_findBatch` only prefetches if the slots take this many bytes */
+  static constexpr size_t FIND_BATCH_MIN_PREFETCH_BYTES = 512 * 1024;
+
+  /**
+   * \brief Finds the slots of many keys, overlapping their cache misses.
+   *
+   * Keys are processed in small batches: all of them are hashed first, then
+   * the control bytes of their home groups are prefetched, then the slots of
+   * the candidates, and only then are the lookups resolved.
+   *
+   * \param numKeys Number of keys
+   * \param hashOf Called with the index of a key; returns its hash
+   * \param isKey Called with the index of a key and a candidate slot; returns
+   * whether the slot holds the key
+   * \param found Called with the index of every key and its slot, or nullptr
+   */
+  template <typename HashOf, typename IsKey, typename Found>
+  void _findBatch(size_t numKeys,
+                  const HashOf &hashOf,
+                  const IsKey &isKey,
+                  const Found &found) {
+    if (_empty()) {
+      for (size_t i = 0; i < numKeys; i++) {
+        found(i, nullptr);
+      }
+      return;
+    }
+
+    if (_capacity() * sizeof(Slot) < FIND_BATCH_MIN_PREFETCH_BYTES) {
+      // The table is likely to be in the cache already; prefetching would
+      // only add overhead
+      for (size_t i = 0; i < numKeys; i++) {
+        found(i, _find(hashOf(i), [&isKey, i](const Slot &slot) {
+                return isKey(i, slot);
+              }));
+      }
+      return;
+    }
+
+    const size_t MASK = numGroups - 1;
+    u64 hashes[FIND_BATCH_SIZE];
+
+    for (size_t base = 0; base < numKeys; base += FIND_BATCH_SIZE) {
+      const size_t n = numKeys - base < FIND_BATCH_SIZE ? numKeys - base
+                                                        : FIND_BATCH_SIZE;
+
+      for (size_t i = 0; i < n; i++) {
+        u64 h1;
+        u8 h2;
+        hashes[i] = hashOf(base + i);
+        splitHash(hashes[i], h1, h2);
+        SN_PREFETCH(&controlBytes[(h1 & MASK) * GROUP16_WIDTH]);
+      }
+
+      for (size_t i = 0; i < n; i++) {
+        u64 h1;
+        u8 h2;
+        splitHash(hashes[i], h1, h2);
+        size_t idxGroupBase = (h1 & MASK) * GROUP16_WIDTH;
+        u32 candidateMask = hasKey16(&controlBytes[idxGroupBase], h2);
+        if (candidateMask != 0) {
+          SN_PREFETCH(&slots[idxGroupBase + countTrailingZeros(candidateMask)]);
+        }
+      }
+
+      for (size_t i = 0; i < n; i++) {
+        const size_t idxKey = base + i;
+        found(idxKey, _find(hashes[i], [&isKey, idxKey](const Slot &slot) {
+                return isKey(idxKey, slot);
+              }));
+      }
+    }
+  }
+
+  /**
+   * \brief Claims an empty slot for a key that is not in the table yet,
+   * growing or rehashing the table if needed.
+   * \returns The slot; the caller must fill it in before the table is
+   * modified again. It may still hold the contents of a removed key.
+   */
+  Slot *_prepareInsert(u64 hash) {
+    size_t idxSlot = _findEmptySlot(hash);
+    if (controlBytes[idxSlot] == CW_ENTRY_UNUSED) {
+      if (growthLeft == 0) {
+        _growAndRehash();
+        idxSlot = _findEmptySlot(hash);
+      }
+      growthLeft -= 1;
+    }
+
+    u64 h1;
+    u8 h2;
+    splitHash(hash, h1, h2);
+    controlBytes[idxSlot] = h2;
+    numEntries += 1;
+    return &slots[idxSlot];
+  }
+
+  /**
+   * \brief Removes the key held by a slot. The contents of the slot are left
+   * intact.
+   */
+  void _erase(Slot *slot) {
+    size_t idxSlot = size_t(slot - slots);
+    DCHECK(idxSlot < _capacity());
+    const u8 *group = &controlBytes[idxSlot & ~(GROUP16_WIDTH - 1)];
+    if (unusedSlots16(group) != 0) {
+      // Probes never continue past a group that has an unused slot, so this
+      // slot can become unused as well instead of leaving a tombstone
+      controlBytes[idxSlot] = CW_ENTRY_UNUSED;
+      growthLeft += 1;
+    } else {
+      controlBytes[idxSlot] = CW_ENTRY_DELETED;
+    }
+    numEntries -= 1;
+  }
+
+  /**
+   * \brief Returns the index of the first empty slot on the probe sequence of
+   * the hash. Grows the table if it has no slots.
+   */
+  size_t _findEmptySlot(u64 hash) {
+    if (_empty()) {
+      _resize(1);
+    }
+
+    const size_t MASK = numGroups - 1;
+    u64 h1;
+    u8 h2;
+    splitHash(hash, h1, h2);
+
+    size_t group = h1 & MASK;
+    for (size_t i = 1;; i++) {
+      u32 emptyMask = emptySlots16(&controlBytes[group * GROUP16_WIDTH]);
+      if (emptyMask != 0) {
+        return group * GROUP16_WIDTH + countTrailingZeros(emptyMask);
+      }
+
+      // The load factor keeps at least one slot unused
+      DCHECK(i < numGroups);
+      group = (group + i) & MASK;
+    }
+  }
+
+  /**
+   * \brief Makes room for one more key. If most of the used slots are
+   * tombstones, they are reclaimed without growing the table; otherwise the
+   * number of groups is doubled.
+   */
+  void _growAndRehash() {
+    if (numEntries <= _maxEntriesForCapacity(_capacity()) / 2) {
+      _rehashInPlace();
+    } else {
+      _resize(numGroups * 2);
+    }
+  }
+
+  /**
+   * \brief Moves every key into new arrays of the specified number of groups.
+   * Tombstones are dropped in the process.
+   */
+  void _resize(size_t numGroupsNew) {
+    DCHECK((numGroupsNew & (numGroupsNew - 1)) == 0);
+    u8 *oldControlBytes = controlBytes;
+    Slot *oldSlots = slots;
+    const size_t oldCapacity = _capacity();
+
+    numGroups = numGroupsNew;
+    const size_t capacity = _capacity();
+    controlBytes = allocNZ<u8, GROUP16_WIDTH>(arena, capacity);
+    memset(controlBytes, CW_ENTRY_UNUSED, capacity);
+    slots = alloc<Slot>(arena, capacity);
+
+    const SlotHash slotHash = {};
+    for (size_t i = 0; i < oldCapacity; i++) {
+      if ((oldControlBytes[i] & CW_ENTRY_MASK) != 0) {
+        continue;
+      }
+
+      size_t idxSlot = _findEmptySlot(slotHash(oldSlots[i]));
+      controlBytes[idxSlot] = oldControlBytes[i];
+      slots[idxSlot] = oldSlots[i];
+    }
+
+    growthLeft = _maxEntriesForCapacity(capacity) - numEntries;
+  }
+
+  /**
+   * \brief Moves every key to the first group with an empty slot on its probe
+   * sequence without allocating, turning every tombstone into an unused slot.
+   */
+  void _rehashInPlace() {
+    const size_t capacity = _capacity();
+    const SlotHash slotHash = {};
+
+    // Keys still waiting to be placed are marked deleted
+    for (size_t i = 0; i < capacity; i++) {
+      controlBytes[i] = (controlBytes[i] & CW_ENTRY_MASK) != 0
+                            ? u8(CW_ENTRY_UNUSED)
+                            : u8(CW_ENTRY_DELETED);
+    }
+
+    for (size_t i = 0; i < capacity; i++) {
+      // Keys swapped into this slot need to be placed, too
+      while (controlBytes[i] == CW_ENTRY_DELETED) {
+        u64 hash = slotHash(slots[i]);
+        u64 h1;
+        u8 h2;
+        splitHash(hash, h1, h2);
+
+        size_t target = _findEmptySlot(hash);
+        if (target / GROUP16_WIDTH == i / GROUP16_WIDTH) {
+          // Already in the right group
+          controlBytes[i] = h2;
+          break;
+        }
+
+        if (controlBytes[target] == CW_ENTRY_UNUSED) {
+          slots[target] = slots[i];
+          // Whatever the slot points to now belongs to the target
+          slots[i] = {};
+          controlBytes[target] = h2;
+          controlBytes[i] = CW_ENTRY_UNUSED;
+          break;
+        }
+
+        // The target held a key that is yet to be placed
+        Slot tmp = slots[target];
+        slots[target] = slots[i];
+        slots[i] = tmp;
+        controlBytes[target] = h2;
+      }
+    }
+
+    growthLeft = _maxEntriesForCapacity(capacity) - numEntries;
+  }
+};
+
+template <typename K, typename V>
+struct FlatSwissTableSlot {
+  MutSlice<K> key;
+  u64 hash;
+  V value;
+};
+
+template <typename K, typename V>
+struct FlatSwissTableSlotHash {
+  u64 operator()(const FlatSwissTableSlot<K, V> &slot) const {
+    return slot.hash;
+  }
+};
+}  // namespace impl
+
+/**
+ * \brief A Swiss table for keys of Slice<K> and values of V with a flat
+ * layout.
+ *
+ * Unlike `SwissTable`, the control bytes and the slots live in two contiguous,
+ * power-of-two sized arrays and every group has 16 slots, so a probe step is a
+ * single 16-byte compare. Values are stored inline in the slots.
+ *
+ * Pointers to values are invalidated when the table grows or rehashes.
+ *
+ * \tparam K Key base type. Actual key type is `Slice<K>`
+ * \tparam V Value type
+ */
+template <typename K, typename V>
+struct FlatSwissTable
+    : impl::FlatTable<impl::FlatSwissTableSlot<K, V>,
+                      impl::FlatSwissTableSlotHash<K, V>> {
+  using Slot = impl::FlatSwissTableSlot<K, V>;
+  using Base = impl::FlatTable<Slot, impl::FlatSwissTableSlotHash<K, V>>;
+
+  FlatSwissTable() : FlatSwissTable(nullptr) {}
+  /**
+   * \brief Initializes a table that allocates keys, control bytes and slots
+   * into the provided arena.
+   */
+  FlatSwissTable(Arena *arena) : Base(arena) {}
+
+  /**
+   * \brief Looks up a key in the table and returns a pointer to the associated
+   * value.
+   * \param key Key
+   * \returns A valid pointer to the associated value if the key is present in
+   * the table, or nullptr.
+   */
+  V *get(Slice<K> key) {
+    Slot *slot = _findKey(key, hashRapidMicro(key));
+    return slot != nullptr ? &slot->value : nullptr;
+  }
+
+  /**
+   * \brief Looks up many keys at once, overlapping their cache misses.
+   * \param keys Keys to look up
+   * \param out Receives, for every key, a pointer to the associated value or
+   * nullptr if the key is not present; at least as long as `keys`
+   */
+  void getBatch(Slice<Slice<K>> keys, MutSlice<V *> out) {
+    DCHECK(out.length >= keys.length);
+    this->_findBatch(
+        keys.length,
+        [keys](size_t i) { return hashRapidMicro(keys[i]); },
+        [keys](size_t i, const Slot &slot) { return slot.key == keys[i]; },
+        [out](size_t i, Slot *slot) {
+          out[i] = slot != nullptr ? &slot->value : nullptr;
+        });
+  }
+
+  /**
+   * \brief Sets the key to the specified value.
+   * \param key Key to insert or update
+   * \param value New value
+   * \returns A valid pointer to the value associated with the key
+   */
+  V *put(Slice<K> key, const V &value) {
+    u64 hash = hashRapidMicro(key);
+    Slot *slot = _findKey(key, hash);
+    if (slot != nullptr) {
+      slot->value = value;
+      return &slot->value;
+    }
+
+    slot = this->_prepareInsert(hash);
+    if (key.length <= slot->key.length) {
+      // The slot held a key at least as long as this one; reuse its space
+      MutSlice<K> k = slot->key;
+      k.length = key.length;
+      k.copy(key);
+      slot->key = k;
+    } else {
+      slot->key = duplicate(this->arena, key);
+    }
+    slot->hash = hash;
+    slot->value = value;
+    return &slot->value;
+  }
+
+  /**
+   * \brief Removes a key from the table
+   * \param key Key to remove
+   * \returns A value indicating whether the key was present in the table
+   */
+  bool remove(Slice<K> key) {
+    Slot *slot = _findKey(key, hashRapidMicro(key));
+    if (slot == nullptr) {
+      return false;
+    }
+
+    this->_erase(slot);
+    return true;
+  }
+
+  Slot *_findKey(Slice<K> key, u64 hash) {
+    return this->_find(hash, [key, hash](const Slot &slot) {
+      return slot.hash == hash && slot.key == key;
+    });
+  }
+};
@@ -0,0 +1,358 @@
+/*
+ * Copyright (c) 2026 Daniel Meszaros
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "std/Arena.h"
+#include "std/Check.h"
+#include "std/Slice.hpp"
+#include "std/SliceUtils.hpp"
+#include "std/Sort.hpp"
+#include "std/Types.h"
+#include "std/WorkerPool.hpp"
+
+#include <stdint.h>
+
+// Data-parallel algorithms over slices, built on top of `WorkerPool`.
+//
+// The slice is cut into chunks that are dispatched as one job each; the
+// calling thread helps running them in `WorkerPool::release`. Bookkeeping is
+// allocated from the scratch arena of the calling thread, so it needs scratch
+// allocators even when it's a worker (see
+// `WorkerPoolCreateInfo::workerScratchSize`).
+//
+// Passing a null pool runs the algorithm serially on the calling thread.
+
+namespace impl {
+
+/** Smallest chunk picked when the caller doesn't specify a grain size. */
+constexpr size_t ParallelMinGrainSize = 512;
+
+/**
+ * Number of elements in a chunk when splitting `numItems` elements between
+ * the threads of `pool`.
+ */
+inline size_t parallelChunkSize(WorkerPool *pool,
+                                size_t numItems,
+                                size_t grainSize) {
+  if (grainSize == 0) {
+    size_t numThreads = pool != nullptr ? pool->numWorkerThreads() + 1 : 1;
+    // A few chunks per thread, so that threads finishing early can pick up
+    // the work of the slow ones
+    grainSize = numItems / (numThreads * 4);
+    if (grainSize < ParallelMinGrainSize) {
+      grainSize = ParallelMinGrainSize;
+    }
+  }
+
+  // Chunks are indexed by 32-bit thread indices
+  size_t minChunkSize = numItems / UINT32_MAX + 1;
+  return grainSize > minChunkSize ? grainSize : minChunkSize;
+}
+
+inline size_t parallelNumChunks(size_t numItems, size_t chunkSize) {
+  return (numItems + chunkSize - 1) / chunkSize;
+}
+
+/**
+ * Calls `fn(idxTask)` for every task in `[0, numTasks)` on the worker pool
+ * and waits for all of them to finish.
+ */
+template <typename Fn>
+void parallelTasks(WorkerPool *pool, size_t numTasks, const Fn &fn) {
+  DCHECK(numTasks <= UINT32_MAX);
+  if (pool == nullptr || numTasks <= 1) {
+    for (size_t i = 0; i < numTasks; i++) {
+      fn(i);
+    }
+    return;
+  }
+
+  struct Params {
+    const Fn *fn;
+  };
+  Params params = {&fn};
+  KernelEntryPoint kernel = [](const Dispatch *D) {
+    const Params &P = D->parametersAs<Params>();
+    (*P.fn)(D->threadIndex.x);
+  };
+
+  Arena::Scope temp = getScratch(nullptr, 0);
+  WorkContract *wc = pool->createWorkContract(temp, kernel, 0, 1);
+  pool->dispatch(wc, &params, u32(numTasks));
+  pool->release(wc);
+}
+
+/**
+ * Calls `fn(idxChunk, idxBegin, idxEnd)` for every chunk of `numItems`
+ * elements on the worker pool.
+ */
+template <typename Fn>
+void parallelChunks(WorkerPool *pool,
+                    size_t numItems,
+                    size_t chunkSize,
+                    const Fn &fn) {
+  size_t numChunks = parallelNumChunks(numItems, chunkSize);
+  parallelTasks(pool, numChunks, [&](size_t idxChunk) {
+    size_t idxBegin = idxChunk * chunkSize;
+    size_t idxEnd = idxBegin + chunkSize < numItems ? idxBegin + chunkSize
+                                                    : numItems;
+    fn(idxChunk, idxBegin, idxEnd);
+  });
+}
+
+/**
+ * Number of elements that come from `left` among the first `k` elements of
+ * the merge of `left` and `right`. Ties are resolved in favor of `left`, like
+ * in `mergeLeftFirst`.
+ */
+template <typename T, typename Cmp>
+size_t mergeSplit(Slice<T> left, Slice<T> right, size_t k, const Cmp &cmp) {
+  size_t lo = k > right.length ? k - right.length : 0;
+  size_t hi = k < left.length ? k : left.length;
+
+  // Find the first `i` at which `right[k - i - 1]` goes before `left[i]`
+  while (lo < hi) {
+    size_t i = lo + (hi - lo) / 2;
+    if (cmp(right[k - i - 1], left[i])) {
+      hi = i;
+    } else {
+      lo = i + 1;
+    }
+  }
+
+  return lo;
+}
+
+/**
+ * Merges two sorted slices into `dst`; equal elements are taken from `left`
+ * first.
+ */
+template <typename T, typename Cmp>
+void mergeLeftFirst(MutSlice<T> dst,
+                    Slice<T> left,
+                    Slice<T> right,
+                    const Cmp &cmp) {
+  DCHECK(dst.length == left.length + right.length);
+  size_t idxLeft = 0;
+  size_t idxRight = 0;
+
+  for (size_t idxDst = 0; idxDst < dst.length; idxDst++) {
+    if (idxLeft < left.length &&
+        (idxRight == right.length || !cmp(right[idxRight], left[idxLeft]))) {
+      dst[idxDst] = left[idxLeft++];
+    } else {
+      dst[idxDst] = right[idxRight++];
+    }
+  }
+}
+
+}  // namespace impl
+
+/**
+ * \brief Calls `fn(elem, idx)` for every element of the slice in parallel.
+ *
+ * \param grainSize Number of elements handled by a single job. Pass 0 to
+ * split the slice into a few chunks per thread.
+ */
+template <typename T, typename Fn>
+void parallelFor(WorkerPool *pool,
+                 MutSlice<T> s,
+                 const Fn &fn,
+                 size_t grainSize = 0) {
+  size_t chunkSize = impl::parallelChunkSize(pool, s.length, grainSize);
+  impl::parallelChunks(pool, s.length, chunkSize,
+                       [&](size_t, size_t idxBegin, size_t idxEnd) {
+                         for (size_t i = idxBegin; i < idxEnd; i++) {
+                           fn(s[i], i);
+                         }
+                       });
+}
+
+/**
+ * \brief Combines every element of the slice with `op` in parallel.
+ *
+ * `op` must be associative and `identity` must be its identity element; the
+ * partial results of the chunks are combined in order, so `op` doesn't need
+ * to be commutative.
+ *
+ * \param grainSize Number of elements handled by a single job. Pass 0 to
+ * split the slice into a few chunks per thread.
+ */
+template <typename T, typename Op>
+T parallelReduce(WorkerPool *pool,
+                 Slice<T> s,
+                 T identity,
+                 const Op &op,
+                 size_t grainSize = 0) {
+  size_t chunkSize = impl::parallelChunkSize(pool, s.length, grainSize);
+  size_t numChunks = impl::parallelNumChunks(s.length, chunkSize);
+
+  Arena::Scope temp = getScratch(nullptr, 0);
+  MutSlice<T> partials;
+  alloc(temp, numChunks, partials);
+
+  impl::parallelChunks(pool, s.length, chunkSize,
+                       [&](size_t idxChunk, size_t idxBegin, size_t idxEnd) {
+                         T acc = identity;
+                         for (size_t i = idxBegin; i < idxEnd; i++) {
+                           acc = op(acc, s[i]);
+                         }
+                         partials[idxChunk] = acc;
+                       });
+
+  T ret = identity;
+  for (size_t i = 0; i < numChunks; i++) {
+    ret = op(ret, partials[i]);
+  }
+  return ret;
+}
+
+/**
+ * \brief Computes the inclusive prefix sums of `src` under `op` into `dst` in
+ * parallel.
+ *
+ * `dst[i]` will be `op(...op(op(identity, src[0]), src[1])..., src[i])`. `op`
+ * must be associative and `identity` must be its identity element. `dst` may
+ * be the same slice as `src`.
+ *
+ * \param grainSize Number of elements handled by a single job. Pass 0 to
+ * split the slice into a few chunks per thread.
+ */
+template <typename T, typename Op>
+void parallelScan(WorkerPool *pool,
+                  MutSlice<T> dst,
+                  Slice<T> src,
+                  T identity,
+                  const Op &op,
+                  size_t grainSize = 0) {
+  DCHECK(dst.length == src.length);
+  size_t chunkSize = impl::parallelChunkSize(pool, src.length, grainSize);
+  size_t numChunks = impl::parallelNumChunks(src.length, chunkSize);
+
+  auto scanChunk = [&](T acc, size_t idxBegin, size_t idxEnd) {
+    for (size_t i = idxBegin; i < idxEnd; i++) {
+      acc = op(acc, src[i]);
+      dst[i] = acc;
+    }
+  };
+
+  if (pool == nullptr || numChunks <= 1) {
+    scanChunk(identity, 0, src.length);
+    return;
+  }
+
+  // Reduce every chunk, scan the chunk totals, then scan the chunks again
+  // starting from their offsets
+  Arena::Scope temp = getScratch(nullptr, 0);
+  MutSlice<T> offsets;
+  alloc(temp, numChunks, offsets);
+
+  impl::parallelChunks(pool, src.length, chunkSize,
+                       [&](size_t idxChunk, size_t idxBegin, size_t idxEnd) {
+                         T acc = identity;
+                         for (size_t i = idxBegin; i < idxEnd; i++) {
+                           acc = op(acc, src[i]);
+                         }
+                         offsets[idxChunk] = acc;
+                       });
+
+  T acc = identity;
+  for (size_t i = 0; i < numChunks; i++) {
+    T total = offsets[i];
+    offsets[i] = acc;
+    acc = op(acc, total);
+  }
+
+  impl::parallelChunks(pool, src.length, chunkSize,
+                       [&](size_t idxChunk, size_t idxBegin, size_t idxEnd) {
+                         scanChunk(offsets[idxChunk], idxBegin, idxEnd);
+                       });
+}
+
+/**
+ * \brief Sorts the slice in parallel. The sort is stable.
+ *
+ * The chunks are sorted with `mergeSort` on the workers, then merged pairwise
+ * in rounds. Every pairwise merge is cut into pieces of equal size along the
+ * merge path, so the late rounds keep all threads busy too.
+ *
+ * Allocates a buffer as large as the slice from the scratch arena of the
+ * calling thread.
+ *
+ * \param grainSize Number of elements in the chunks sorted by a single job.
+ * Pass 0 to split the slice into a few chunks per thread.
+ */
+template <typename T, typename Cmp>
+void parallelMergeSort(WorkerPool *pool,
+                       MutSlice<T> s,
+                       const Cmp &cmp,
+                       size_t grainSize = 0) {
+  if (s.length <= 1) {
+    return;
+  }
+
+  const size_t n = s.length;
+  size_t chunkSize = impl::parallelChunkSize(pool, n, grainSize);
+  size_t numChunks = impl::parallelNumChunks(n, chunkSize);
+
+  Arena::Scope temp = getScratch(nullptr, 0);
+  MutSlice<T> buf;
+  alloc(temp, n, buf);
+
+  impl::parallelChunks(pool, n, chunkSize,
+                       [&](size_t, size_t idxBegin, size_t idxEnd) {
+                         ::mergeSort(buf.subarray(idxBegin, idxEnd),
+                                     s.subarray(idxBegin, idxEnd), cmp);
+                       });
+
+  MutSlice<T> from = buf;
+  MutSlice<T> to = s;
+  for (size_t width = chunkSize; width < n; width *= 2) {
+    size_t numPairs = impl::parallelNumChunks(n, 2 * width);
+    size_t numPieces = numChunks > numPairs ? numChunks / numPairs : 1;
+
+    impl::parallelTasks(pool, numPairs * numPieces, [&](size_t idxTask) {
+      size_t idxPair = idxTask / numPieces;
+      size_t idxPiece = idxTask % numPieces;
+
+      size_t idxBegin = idxPair * 2 * width;
+      size_t idxMid = idxBegin + width < n ? idxBegin + width : n;
+      size_t idxEnd = idxBegin + 2 * width < n ? idxBegin + 2 * width : n;
+      Slice<T> left = from.subarray(idxBegin, idxMid);
+      Slice<T> right = from.subarray(idxMid, idxEnd);
+
+      size_t len = idxEnd - idxBegin;
+      size_t k0 = len * idxPiece / numPieces;
+      size_t k1 = len * (idxPiece + 1) / numPieces;
+      size_t i0 = impl::mergeSplit(left, right, k0, cmp);
+      size_t i1 = impl::mergeSplit(left, right, k1, cmp);
+
+      impl::mergeLeftFirst(to.subarray(idxBegin + k0, idxBegin + k1),
+                           left.subarray(i0, i1),
+                           right.subarray(k0 - i0, k1 - i1), cmp);
+    });
+
+    MutSlice<T> t = from;
+    from = to;
+    to = t;
+  }
+
+  if (from.data != s.data) {
+    impl::parallelChunks(pool, n, chunkSize,
+                         [&](size_t, size_t idxBegin, size_t idxEnd) {
+                           s.subarray(idxBegin, idxEnd)
+                               .copy(from.subarray(idxBegin, idxEnd));
+                         });
+  }
+}
+
+template <typename T>
+void parallelMergeSort(WorkerPool *pool, MutSlice<T> s) {
+  parallelMergeSort(pool, s, impl::Less<T>{});
+}
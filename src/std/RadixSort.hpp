@@ -8,10 +8,54 @@
 
 #pragma once
 
+#include "std/Arena.h"
 #include "std/Check.h"
+#include "std/Slice.hpp"
 #include "std/Types.h"
 
 #include <string.h>
+#include <type_traits>
+
+namespace impl {
+
+// Map a key to an unsigned integer of the same width whose order matches the
+// order of the keys
+
+inline u32 radixKeyBits(u32 key) {
+  return key;
+}
+
+inline u64 radixKeyBits(u64 key) {
+  return key;
+}
+
+inline u32 radixKeyBits(i32 key) {
+  return u32(key) ^ 0x80000000u;
+}
+
+inline u64 radixKeyBits(i64 key) {
+  return u64(key) ^ 0x8000000000000000ull;
+}
+
+/**
+ * Negative floats are ordered by the inverse of their magnitude, so all their
+ * bits are flipped; positive floats only need the sign bit set. -0.0 goes
+ * before +0.0 and NaNs go to either end, depending on their sign.
+ */
+inline u32 radixKeyBits(f32 key) {
+  u32 bits;
+  memcpy(&bits, &key, sizeof(bits));
+  return (bits & 0x80000000u) != 0 ? ~bits : bits | 0x80000000u;
+}
+
+inline u64 radixKeyBits(f64 key) {
+  u64 bits;
+  memcpy(&bits, &key, sizeof(bits));
+  return (bits & 0x8000000000000000ull) != 0 ? ~bits
+                                             : bits | 0x8000000000000000ull;
+}
+
+}  // namespace impl
 
 template <u32 Shift, typename K>
 inline void countingSort(u32 N,
@@ -30,7 +74,7 @@ inline void countingSort(u32 N,
   for (u32 i = 0; i < N; i++) {
     u32 index = indices[i];
     DCHECK(index < N);
-    u8 key = (keys[index] >> Shift) & 0xFF;
+    u8 key = (impl::radixKeyBits(keys[index]) >> Shift) & 0xFF;
     counts[key] += 1;
   }
 
@@ -53,7 +97,7 @@ inline void countingSort(u32 N,
   for (u32 i = 0; i < N; i++) {
     u32 index = indices[i];
     DCHECK(index < N);
-    u8 key = (keys[index] >> Shift) & 0xFF;
+    u8 key = (impl::radixKeyBits(keys[index]) >> Shift) & 0xFF;
     u32 count = counts[key]++;
     DCHECK(count < N);
     indicesOut[count] = indices[i];
@@ -68,7 +112,10 @@ inline void radixSort(u32 N, u32 *indices, u32 *temp, const u32 *keys) {
 }
 
 inline void radixSort(u32 N, u32 *indices, u32 *temp, const i32 *keys) {
-  radixSort(N, indices, temp, reinterpret_cast<const u32 *>(keys));
+  countingSort<0>(N, indices, temp, keys);
+  countingSort<8>(N, temp, indices, keys);
+  countingSort<16>(N, indices, temp, keys);
+  countingSort<24>(N, temp, indices, keys);
 }
 
 inline void radixSort(u32 N, u32 *indices, u32 *temp, const u64 *keys) {
@@ -81,3 +128,158 @@ inline void radixSort(u32 N, u32 *indices, u32 *temp, const u64 *keys) {
   countingSort<48>(N, indices, temp, keys);
   countingSort<56>(N, temp, indices, keys);
 }
+
+inline void radixSort(u32 N, u32 *indices, u32 *temp, const i64 *keys) {
+  countingSort<0>(N, indices, temp, keys);
+  countingSort<8>(N, temp, indices, keys);
+  countingSort<16>(N, indices, temp, keys);
+  countingSort<24>(N, temp, indices, keys);
+  countingSort<32>(N, indices, temp, keys);
+  countingSort<40>(N, temp, indices, keys);
+  countingSort<48>(N, indices, temp, keys);
+  countingSort<56>(N, temp, indices, keys);
+}
+
+inline void radixSort(u32 N, u32 *indices, u32 *temp, const f32 *keys) {
+  countingSort<0>(N, indices, temp, keys);
+  countingSort<8>(N, temp, indices, keys);
+  countingSort<16>(N, indices, temp, keys);
+  countingSort<24>(N, temp, indices, keys);
+}
+
+inline void radixSort(u32 N, u32 *indices, u32 *temp, const f64 *keys) {
+  countingSort<0>(N, indices, temp, keys);
+  countingSort<8>(N, temp, indices, keys);
+  countingSort<16>(N, indices, temp, keys);
+  countingSort<24>(N, temp, indices, keys);
+  countingSort<32>(N, indices, temp, keys);
+  countingSort<40>(N, temp, indices, keys);
+  countingSort<48>(N, indices, temp, keys);
+  countingSort<56>(N, temp, indices, keys);
+}
+
+namespace impl {
+
+constexpr u32 RadixDigitBits = 11;
+constexpr u32 RadixNumBuckets = 1u << RadixDigitBits;
+
+/** Stands in for the values when only keys are sorted. */
+struct RadixNoValue {};
+
+/**
+ * LSD radix sort that moves the keys and values themselves, 11 bits at a
+ * time; a 32-bit key takes three passes instead of four.
+ *
+ * The histograms of all digits are computed in a single pass up front and
+ * the passes whose digit is the same for every key are skipped.
+ */
+template <typename K, typename V>
+void radixSortKeyValue(size_t N,
+                       K *keys,
+                       V *values,
+                       K *keysTemp,
+                       V *valuesTemp) {
+  using Bits = decltype(radixKeyBits(K{}));
+  constexpr u32 NumPasses =
+      (sizeof(Bits) * 8 + RadixDigitBits - 1) / RadixDigitBits;
+  constexpr Bits Mask = RadixNumBuckets - 1;
+  constexpr bool HasValues = !std::is_same_v<V, RadixNoValue>;
+  static_assert(std::is_trivially_copyable_v<K> &&
+                    std::is_trivially_copyable_v<V>,
+                "Keys and values must be trivially copyable");
+
+  if (N <= 1) {
+    return;
+  }
+
+  Arena::Scope scratch = getScratch(nullptr, 0);
+  size_t *counts = alloc<size_t>(scratch, NumPasses * RadixNumBuckets);
+
+  for (size_t i = 0; i < N; i++) {
+    Bits bits = radixKeyBits(keys[i]);
+    for (u32 p = 0; p < NumPasses; p++) {
+      counts[p * RadixNumBuckets + ((bits >> (p * RadixDigitBits)) & Mask)]++;
+    }
+  }
+
+  K *srcKeys = keys;
+  K *dstKeys = keysTemp;
+  V *srcValues = values;
+  V *dstValues = valuesTemp;
+
+  for (u32 p = 0; p < NumPasses; p++) {
+    const u32 shift = p * RadixDigitBits;
+    size_t *offsets = counts + p * RadixNumBuckets;
+
+    size_t total = 0;
+    bool isTrivial = false;
+    for (u32 bucket = 0; bucket < RadixNumBuckets; bucket++) {
+      size_t count = offsets[bucket];
+      isTrivial |= count == N;
+      offsets[bucket] = total;
+      total += count;
+    }
+
+    if (isTrivial) {
+      continue;
+    }
+
+    for (size_t i = 0; i < N; i++) {
+      size_t pos = offsets[(radixKeyBits(srcKeys[i]) >> shift) & Mask]++;
+      dstKeys[pos] = srcKeys[i];
+      if constexpr (HasValues) {
+        dstValues[pos] = srcValues[i];
+      }
+    }
+
+    K *tk = srcKeys;
+    srcKeys = dstKeys;
+    dstKeys = tk;
+    V *tv = srcValues;
+    srcValues = dstValues;
+    dstValues = tv;
+  }
+
+  if (srcKeys != keys) {
+    memcpy(keys, srcKeys, N * sizeof(K));
+    if constexpr (HasValues) {
+      memcpy(values, srcValues, N * sizeof(V));
+    }
+  }
+}
+
+}  // namespace impl
+
+/**
+ * \brief Sorts `keys` in ascending order and applies the same permutation to
+ * `values`. The sort is stable.
+ *
+ * Supports 32- and 64-bit integer and floating point keys. Floats are ordered
+ * by their bits: -0.0 goes before +0.0 and NaNs go to either end, depending
+ * on their sign.
+ *
+ * \param keysTemp, valuesTemp Scratch space, as long as `keys`.
+ */
+template <typename K, typename V>
+void radixSort(MutSlice<K> keys,
+               MutSlice<V> values,
+               MutSlice<K> keysTemp,
+               MutSlice<V> valuesTemp) {
+  DCHECK(values.length == keys.length);
+  DCHECK(keysTemp.length >= keys.length);
+  DCHECK(valuesTemp.length >= keys.length);
+  impl::radixSortKeyValue(keys.length, keys.data, values.data, keysTemp.data,
+                          valuesTemp.data);
+}
+
+/**
+ * \brief Sorts `keys` in ascending order; see the key-value overload.
+ *
+ * \param keysTemp Scratch space, as long as `keys`.
+ */
+template <typename K>
+void radixSort(MutSlice<K> keys, MutSlice<K> keysTemp) {
+  DCHECK(keysTemp.length >= keys.length);
+  impl::radixSortKeyValue<K, impl::RadixNoValue>(
+      keys.length, keys.data, nullptr, keysTemp.data, nullptr);
+}
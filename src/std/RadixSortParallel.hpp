@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2026 Daniel Meszaros
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "std/Arena.h"
+#include "std/Check.h"
+#include "std/Parallel.hpp"
+#include "std/RadixSort.hpp"
+#include "std/Types.h"
+#include "std/WorkerPool.hpp"
+
+#include <string.h>
+
+namespace impl {
+
+/** Smallest number of keys handled by a single thread of `radixSort`. */
+constexpr u32 RadixSortMinChunkSize = 1024;
+
+/**
+ * Parallel LSD radix sort of an index array, one byte of the key at a time.
+ *
+ * Every thread histograms its chunk of the input for all digits in a single
+ * pass. Digits that put every key into the same bucket are skipped. A pass
+ * turns the per-thread histograms of its digit into scatter offsets, with the
+ * buckets of earlier threads coming first, so the sort is stable; then every
+ * thread scatters its chunk. Passes after the first one histogram their digit
+ * again, since the order of the indices has changed.
+ */
+template <typename K>
+void radixSortParallel(WorkerPool *pool,
+                       u32 N,
+                       u32 *indices,
+                       u32 *temp,
+                       const K *keys) {
+  constexpr u32 NumDigits = sizeof(K);
+  constexpr u32 NumBuckets = 256;
+
+  DCHECK(N == 0 ||
+         (indices != nullptr && temp != nullptr && keys != nullptr));
+  if (N == 0 || indices == nullptr || temp == nullptr || keys == nullptr) {
+    return;
+  }
+
+  u32 numThreads = pool != nullptr ? pool->numWorkerThreads() + 1 : 1;
+  size_t chunkSize = (size_t(N) + numThreads - 1) / numThreads;
+  if (chunkSize < RadixSortMinChunkSize) {
+    chunkSize = RadixSortMinChunkSize;
+  }
+  size_t numChunks = parallelNumChunks(N, chunkSize);
+
+  Arena::Scope scratch = getScratch(nullptr, 0);
+  // counts[(idxChunk * NumDigits + idxDigit) * NumBuckets + bucket]
+  u32 *counts = alloc<u32>(scratch, numChunks * NumDigits * NumBuckets);
+  auto countsOf = [&](size_t idxChunk, u32 idxDigit) {
+    return counts + (idxChunk * NumDigits + idxDigit) * NumBuckets;
+  };
+
+  parallelChunks(pool, N, chunkSize,
+                 [&](size_t idxChunk, size_t idxBegin, size_t idxEnd) {
+                   u32 *chunkCounts = countsOf(idxChunk, 0);
+                   for (size_t i = idxBegin; i < idxEnd; i++) {
+                     DCHECK(indices[i] < N);
+                     auto key = radixKeyBits(keys[indices[i]]);
+                     for (u32 d = 0; d < NumDigits; d++) {
+                       u8 bucket = (key >> (d * 8)) & 0xFF;
+                       chunkCounts[d * NumBuckets + bucket]++;
+                     }
+                   }
+                 });
+
+  u32 *src = indices;
+  u32 *dst = temp;
+  bool isFirstPass = true;
+
+  for (u32 d = 0; d < NumDigits; d++) {
+    const u32 shift = d * 8;
+
+    // The digit is trivial if all keys fall into a single bucket
+    bool isTrivial = false;
+    for (u32 bucket = 0; bucket < NumBuckets && !isTrivial; bucket++) {
+      u32 total = 0;
+      for (size_t c = 0; c < numChunks; c++) {
+        total += countsOf(c, d)[bucket];
+      }
+      isTrivial = total == N;
+    }
+
+    if (isTrivial) {
+      continue;
+    }
+
+    if (!isFirstPass) {
+      parallelChunks(pool, N, chunkSize,
+                     [&](size_t idxChunk, size_t idxBegin, size_t idxEnd) {
+                       u32 *chunkCounts = countsOf(idxChunk, d);
+                       memset(chunkCounts, 0, NumBuckets * sizeof(u32));
+                       for (size_t i = idxBegin; i < idxEnd; i++) {
+                         u8 bucket = (radixKeyBits(keys[src[i]]) >> shift) &
+                                     0xFF;
+                         chunkCounts[bucket]++;
+                       }
+                     });
+    }
+
+    u32 offset = 0;
+    for (u32 bucket = 0; bucket < NumBuckets; bucket++) {
+      for (size_t c = 0; c < numChunks; c++) {
+        u32 count = countsOf(c, d)[bucket];
+        countsOf(c, d)[bucket] = offset;
+        offset += count;
+      }
+    }
+
+    parallelChunks(pool, N, chunkSize,
+                   [&](size_t idxChunk, size_t idxBegin, size_t idxEnd) {
+                     u32 *chunkOffsets = countsOf(idxChunk, d);
+                     for (size_t i = idxBegin; i < idxEnd; i++) {
+                       u32 index = src[i];
+                       u8 bucket = (radixKeyBits(keys[index]) >> shift) &
+                                   0xFF;
+                       dst[chunkOffsets[bucket]++] = index;
+                     }
+                   });
+
+    u32 *t = src;
+    src = dst;
+    dst = t;
+    isFirstPass = false;
+  }
+
+  if (src != indices) {
+    parallelChunks(pool, N, chunkSize,
+                   [&](size_t, size_t idxBegin, size_t idxEnd) {
+                     memcpy(indices + idxBegin, src + idxBegin,
+                            (idxEnd - idxBegin) * sizeof(u32));
+                   });
+  }
+}
+
+}  // namespace impl
+
+/**
+ * \brief Sorts `indices` by `keys`, like the serial `radixSort`, but spreads
+ * the work between the threads of `pool`.
+ *
+ * The sort is stable. Digits on which every key agrees are skipped.
+ */
+inline void radixSort(WorkerPool *pool,
+                      u32 N,
+                      u32 *indices,
+                      u32 *temp,
+                      const u32 *keys) {
+  impl::radixSortParallel(pool, N, indices, temp, keys);
+}
+
+inline void radixSort(WorkerPool *pool,
+                      u32 N,
+                      u32 *indices,
+                      u32 *temp,
+                      const i32 *keys) {
+  impl::radixSortParallel(pool, N, indices, temp, keys);
+}
+
+inline void radixSort(WorkerPool *pool,
+                      u32 N,
+                      u32 *indices,
+                      u32 *temp,
+                      const u64 *keys) {
+  impl::radixSortParallel(pool, N, indices, temp, keys);
+}
+
+inline void radixSort(WorkerPool *pool,
+                      u32 N,
+                      u32 *indices,
+                      u32 *temp,
+                      const i64 *keys) {
+  impl::radixSortParallel(pool, N, indices, temp, keys);
+}
+
+inline void radixSort(WorkerPool *pool,
+                      u32 N,
+                      u32 *indices,
+                      u32 *temp,
+                      const f32 *keys) {
+  impl::radixSortParallel(pool, N, indices, temp, keys);
+}
+
+inline void radixSort(WorkerPool *pool,
+                      u32 N,
+                      u32 *indices,
+                      u32 *temp,
+                      const f64 *keys) {
+  impl::radixSortParallel(pool, N, indices, temp, keys);
+}
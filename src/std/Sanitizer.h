@@ -14,10 +14,12 @@
 #if defined(__SANITIZE_ADDRESS__)
 #define SN_ASAN_ACTIVE
 #endif
-#else
+#elif defined(__has_feature)
 #if __has_feature(address_sanitizer) || defined(__SANITIZE_ADDRESS__)
 #define SN_ASAN_ACTIVE
 #endif
+#elif defined(__SANITIZE_ADDRESS__)
+#define SN_ASAN_ACTIVE
 #endif
 
 #if __cplusplus
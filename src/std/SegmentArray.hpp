@@ -67,6 +67,16 @@ struct SegmentArray {
     }
   }
 
+  /**
+   * \brief Removes the last element of the array and returns it. The segments
+   * are kept for future pushes.
+   */
+  T pop() {
+    DCHECK(length != 0);
+    length -= 1;
+    return *getSlotForItem(length);
+  }
+
   static constexpr u32 sizeOfSegment(u32 idxSegment) {
     // 2**(SSTS + idxSegment)
     return (1 << SMALL_SEGMENTS_TO_SKIP) << idxSegment;
@@ -106,6 +116,16 @@ struct SegmentArray {
     }
   }
 
+  /**
+   * \brief Allocates segments until the array can hold at least the
+   * specified number of elements
+   */
+  void reserve(size_t count) {
+    while (capacityForSegmentCount(numSegments) < count && numSegments != 26) {
+      grow();
+    }
+  }
+
   /**
    * \brief Grows the array if there is no space for one more element to be
    * pushed
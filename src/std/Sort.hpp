@@ -11,6 +11,8 @@
 #include "std/Slice.hpp"
 #include "std/SliceUtils.hpp"
 
+#include <utility>
+
 namespace impl {
 
 template <typename T>
@@ -20,99 +22,461 @@ struct Less {
   }
 };
 
+/** Runs of the stable sort are sorted with insertion sort up to this length. */
+constexpr size_t StableSortRunLength = 32;
+
+/** Ranges of the unstable sort are sorted with insertion sort below this. */
+constexpr size_t UnstableSortInsertionThreshold = 24;
+
+/** Ranges of the unstable sort use the ninther as pivot above this. */
+constexpr size_t UnstableSortNintherThreshold = 128;
+
+/** Stable insertion sort of `[begin, end)`. */
 template <typename T, typename Cmp>
-void merge(MutSlice<T> dst, Slice<T> left, Slice<T> right, const Cmp &cmp) {
-  size_t idxLeft = 0;
-  size_t idxRight = 0;
-
-  for (size_t idxDst = 0; idxDst < dst.length; idxDst++) {
-    if (idxLeft < left.length &&
-        (idxRight == right.length || cmp(left[idxLeft], right[idxRight]))) {
-      dst[idxDst] = left[idxLeft++];
-    } else {
-      dst[idxDst] = right[idxRight++];
+void insertionSort(T *begin, T *end, const Cmp &cmp) {
+  if (begin == end) {
+    return;
+  }
+
+  for (T *cur = begin + 1; cur < end; cur++) {
+    if (!cmp(*cur, cur[-1])) {
+      continue;
     }
+
+    T tmp = std::move(*cur);
+    T *hole = cur;
+    do {
+      *hole = std::move(hole[-1]);
+      hole--;
+    } while (hole != begin && cmp(tmp, hole[-1]));
+    *hole = std::move(tmp);
   }
 }
 
+/**
+ * Merges the sorted, adjacent ranges `[begin, mid)` and `[mid, end)` in
+ * place; equal elements are taken from the left range first.
+ *
+ * Elements that are already in their final place are left alone, and only
+ * the shorter of the remaining ranges is moved to `buf`, so `buf` needs room
+ * for `min(mid - begin, end - mid)` elements.
+ */
 template <typename T, typename Cmp>
-void mergeSort(MutSlice<T> dst, MutSlice<T> s, const Cmp &cmp) {
-  if (s.length == 1) {
+void mergeAdjacent(T *begin, T *mid, T *end, T *buf, const Cmp &cmp) {
+  if (begin == mid || mid == end || !cmp(*mid, mid[-1])) {
+    // Already in order
     return;
   }
 
-  MutSlice<T> left, right;
-  MutSlice<T> dstLeft, dstRight;
+  // Elements of the left range that are not greater than the first element
+  // of the right range stay where they are
+  {
+    T *lo = begin;
+    T *hi = mid;
+    while (lo < hi) {
+      T *m = lo + (hi - lo) / 2;
+      if (cmp(*mid, *m)) {
+        hi = m;
+      } else {
+        lo = m + 1;
+      }
+    }
+    begin = lo;
+  }
 
-  left.data = s.data;
-  left.length = s.length / 2;
+  // Same for the elements of the right range that are not less than the last
+  // element of the left range
+  {
+    T *lo = mid;
+    T *hi = end;
+    while (lo < hi) {
+      T *m = lo + (hi - lo) / 2;
+      if (cmp(*m, mid[-1])) {
+        lo = m + 1;
+      } else {
+        hi = m;
+      }
+    }
+    end = lo;
+  }
 
-  right.data = s.data + left.length;
-  right.length = s.length - left.length;
+  if (mid - begin <= end - mid) {
+    // Move the left range out of the way and merge forwards
+    T *bufEnd = buf;
+    for (T *cur = begin; cur < mid; cur++) {
+      *bufEnd++ = std::move(*cur);
+    }
 
-  dstLeft.data = dst.data;
-  dstLeft.length = left.length;
+    T *left = buf;
+    T *right = mid;
+    T *out = begin;
+    while (left < bufEnd && right < end) {
+      if (cmp(*right, *left)) {
+        *out++ = std::move(*right++);
+      } else {
+        *out++ = std::move(*left++);
+      }
+    }
+    while (left < bufEnd) {
+      *out++ = std::move(*left++);
+    }
+  } else {
+    // Move the right range out of the way and merge backwards
+    T *bufEnd = buf;
+    for (T *cur = mid; cur < end; cur++) {
+      *bufEnd++ = std::move(*cur);
+    }
 
-  dstRight.data = dst.data + left.length;
-  dstRight.length = right.length;
+    T *left = mid;
+    T *right = bufEnd;
+    T *out = end;
+    while (left > begin && right > buf) {
+      if (cmp(right[-1], left[-1])) {
+        *--out = std::move(*--left);
+      } else {
+        *--out = std::move(*--right);
+      }
+    }
+    while (right > buf) {
+      *--out = std::move(*--right);
+    }
+  }
+}
+
+/**
+ * Bottom-up merge sort: runs of `StableSortRunLength` elements are sorted with
+ * insertion sort, then merged pairwise. `buf` needs room for half of the
+ * elements.
+ */
+template <typename T, typename Cmp>
+void stableSort(T *begin, T *end, T *buf, const Cmp &cmp) {
+  const size_t n = size_t(end - begin);
 
-  ::impl::mergeSort<T, Cmp>(left, dstLeft, cmp);
-  ::impl::mergeSort<T, Cmp>(right, dstRight, cmp);
+  for (size_t i = 0; i < n; i += StableSortRunLength) {
+    size_t len = n - i < StableSortRunLength ? n - i : StableSortRunLength;
+    insertionSort(begin + i, begin + i + len, cmp);
+  }
 
-  merge(dst, left.asSlice(), right.asSlice(), cmp);
+  for (size_t width = StableSortRunLength; width < n; width *= 2) {
+    for (size_t i = 0; i + width < n; i += 2 * width) {
+      size_t len = n - i < 2 * width ? n - i : 2 * width;
+      mergeAdjacent(begin + i, begin + i + width, begin + i + len, buf, cmp);
+    }
+  }
+}
+
+template <typename T>
+void swapElements(T *lhs, T *rhs) {
+  T tmp = std::move(*lhs);
+  *lhs = std::move(*rhs);
+  *rhs = std::move(tmp);
+}
+
+/** Orders the three elements so that `*a <= *b <= *c`. */
+template <typename T, typename Cmp>
+void sort3(T *a, T *b, T *c, const Cmp &cmp) {
+  if (cmp(*b, *a)) {
+    swapElements(a, b);
+  }
+  if (cmp(*c, *b)) {
+    swapElements(b, c);
+    if (cmp(*b, *a)) {
+      swapElements(a, b);
+    }
+  }
+}
+
+template <typename T, typename Cmp>
+void siftDown(T *heap, size_t idx, size_t n, const Cmp &cmp) {
+  while (true) {
+    size_t idxChild = 2 * idx + 1;
+    if (idxChild >= n) {
+      return;
+    }
+    if (idxChild + 1 < n && cmp(heap[idxChild], heap[idxChild + 1])) {
+      idxChild++;
+    }
+    if (!cmp(heap[idx], heap[idxChild])) {
+      return;
+    }
+    swapElements(&heap[idx], &heap[idxChild]);
+    idx = idxChild;
+  }
+}
+
+template <typename T, typename Cmp>
+void heapSort(T *begin, T *end, const Cmp &cmp) {
+  size_t n = size_t(end - begin);
+  for (size_t i = n / 2; i-- > 0;) {
+    siftDown(begin, i, n, cmp);
+  }
+  for (size_t i = n; i-- > 1;) {
+    swapElements(&begin[0], &begin[i]);
+    siftDown(begin, 0, i, cmp);
+  }
+}
+
+/**
+ * Insertion sort that gives up after moving a handful of elements. Returns
+ * whether `[begin, end)` got sorted.
+ */
+template <typename T, typename Cmp>
+bool partialInsertionSort(T *begin, T *end, const Cmp &cmp) {
+  constexpr size_t MaxMoves = 8;
+  size_t numMoves = 0;
+
+  if (begin == end) {
+    return true;
+  }
+
+  for (T *cur = begin + 1; cur < end; cur++) {
+    if (!cmp(*cur, cur[-1])) {
+      continue;
+    }
+
+    T tmp = std::move(*cur);
+    T *hole = cur;
+    do {
+      *hole = std::move(hole[-1]);
+      hole--;
+    } while (hole != begin && cmp(tmp, hole[-1]));
+    *hole = std::move(tmp);
+
+    numMoves += size_t(cur - hole);
+    if (numMoves > MaxMoves) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Partitions `[begin, end)` around the pivot at `*begin`. Returns the final
+ * position of the pivot and whether the range was already partitioned.
+ */
+template <typename T, typename Cmp>
+T *partitionAroundPivot(T *begin,
+                        T *end,
+                        bool &wasPartitioned,
+                        const Cmp &cmp) {
+  T *lo = begin + 1;
+  T *hi = end - 1;
+  wasPartitioned = true;
+
+  while (true) {
+    while (lo <= hi && cmp(*lo, *begin)) {
+      lo++;
+    }
+    while (lo <= hi && cmp(*begin, *hi)) {
+      hi--;
+    }
+    if (lo >= hi) {
+      break;
+    }
+
+    swapElements(lo++, hi--);
+    wasPartitioned = false;
+  }
+
+  // `[begin + 1, lo)` is not greater, `[lo, end)` is not less than the pivot
+  T *pivot = lo - 1;
+  swapElements(begin, pivot);
+  return pivot;
+}
+
+/**
+ * Moves the elements equal to the pivot at `*begin` to the front of the
+ * range, assuming that none of them is less than the pivot. Returns the end
+ * of the equal elements.
+ */
+template <typename T, typename Cmp>
+T *partitionEqual(T *begin, T *end, const Cmp &cmp) {
+  T *lo = begin + 1;
+  T *hi = end - 1;
+
+  while (true) {
+    while (lo <= hi && !cmp(*begin, *lo)) {
+      lo++;
+    }
+    while (lo <= hi && cmp(*begin, *hi)) {
+      hi--;
+    }
+    if (lo >= hi) {
+      break;
+    }
+
+    swapElements(lo++, hi--);
+  }
+
+  return lo;
+}
+
+/**
+ * Introsort with a few tricks of pattern-defeating quicksort: median-of-3 or
+ * ninther pivots, insertion sort for small ranges, heap sort once the
+ * recursion gets too deep, a bail-out for already partitioned ranges and
+ * a separate partitioning scheme for runs of equal elements.
+ *
+ * \param pred The element right before the range, if it's part of the
+ * slice. It's not greater than any element of the range.
+ */
+template <typename T, typename Cmp>
+void unstableSort(T *begin,
+                  T *end,
+                  const T *pred,
+                  u32 depthLimit,
+                  const Cmp &cmp) {
+  while (size_t(end - begin) > UnstableSortInsertionThreshold) {
+    if (depthLimit == 0) {
+      heapSort(begin, end, cmp);
+      return;
+    }
+    depthLimit--;
+
+    // Move the pivot to the front of the range
+    size_t n = size_t(end - begin);
+    T *mid = begin + n / 2;
+    if (n > UnstableSortNintherThreshold) {
+      size_t step = n / 8;
+      sort3(begin + 1, begin + step, begin + 2 * step, cmp);
+      sort3(mid - step, mid, mid + step, cmp);
+      sort3(end - 1 - 2 * step, end - 1 - step, end - 1, cmp);
+      sort3(begin + step, mid, end - 1 - step, cmp);
+    } else {
+      sort3(begin, mid, end - 1, cmp);
+    }
+    swapElements(begin, mid);
+
+    // The pivot is equal to the predecessor: every element equal to it is
+    // already in place, only the greater ones need sorting
+    if (pred != nullptr && !cmp(*pred, *begin)) {
+      begin = partitionEqual(begin, end, cmp);
+      continue;
+    }
+
+    bool wasPartitioned;
+    T *pivot = partitionAroundPivot(begin, end, wasPartitioned, cmp);
+
+    if (wasPartitioned && partialInsertionSort(begin, pivot, cmp) &&
+        partialInsertionSort(pivot + 1, end, cmp)) {
+      return;
+    }
+
+    // Recurse into the smaller side to bound the stack depth
+    if (pivot - begin < end - (pivot + 1)) {
+      unstableSort(begin, pivot, pred, depthLimit, cmp);
+      pred = pivot;
+      begin = pivot + 1;
+    } else {
+      unstableSort(pivot + 1, end, pivot, depthLimit, cmp);
+      end = pivot;
+    }
+  }
+
+  insertionSort(begin, end, cmp);
 }
 
 }  // namespace impl
 
-template <typename T, typename Cmp = impl::Less<T>>
-void mergeSort(MutSlice<T> dst, MutSlice<T> s, const Cmp &cmp) {
-  DCHECK(dst.length == s.length);
-  if (s.empty()) {
+/**
+ * \brief Sorts the slice; equal elements keep their relative order.
+ *
+ * \param buffer Scratch space for at least half as many elements as the
+ * slice has.
+ */
+template <typename T, typename Cmp>
+void stableSort(MutSlice<T> s, MutSlice<T> buffer, const Cmp &cmp) {
+  DCHECK(buffer.length >= s.length / 2);
+  if (s.length <= 1) {
     return;
   }
-  dst.copy(s);
-  impl::mergeSort<T>(dst, s, cmp);
+  impl::stableSort(s.data, s.data + s.length, buffer.data, cmp);
 }
 
 template <typename T>
-void mergeSort(MutSlice<T> s) {
-  if (s.empty()) {
+void stableSort(MutSlice<T> s, MutSlice<T> buffer) {
+  stableSort(s, buffer, impl::Less<T>{});
+}
+
+/**
+ * \brief Sorts the slice; equal elements keep their relative order.
+ *
+ * Allocates scratch space for half of the slice, unless the slice is short
+ * enough to be sorted with a single insertion sort.
+ */
+template <typename T, typename Cmp = impl::Less<T>>
+void stableSort(MutSlice<T> s, const Cmp &cmp) {
+  if (s.length <= impl::StableSortRunLength) {
+    impl::insertionSort(s.data, s.data + s.length, cmp);
     return;
   }
+
   Arena::Scope temp = getScratch(nullptr, 0);
-  MutSlice<T> copy = duplicate<T>(temp, s);
-  ::impl::mergeSort<T>(s, copy, impl::Less<T>{});
+  MutSlice<T> buffer;
+  alloc(temp, s.length / 2, buffer);
+  impl::stableSort(s.data, s.data + s.length, buffer.data, cmp);
 }
 
 template <typename T>
-void mergeSort(MutSlice<T> dst, Slice<T> s) {
+void stableSort(MutSlice<T> s) {
+  stableSort(s, impl::Less<T>{});
+}
+
+/**
+ * \brief Sorts the slice without allocating; equal elements may be
+ * reordered.
+ *
+ * Runs in O(n log n) time in the worst case and in O(n) on sorted input.
+ */
+template <typename T, typename Cmp = impl::Less<T>>
+void unstableSort(MutSlice<T> s, const Cmp &cmp) {
+  u32 depthLimit = 0;
+  for (size_t n = s.length; n > 1; n >>= 1) {
+    depthLimit += 2;
+  }
+  impl::unstableSort<T>(s.data, s.data + s.length, nullptr, depthLimit, cmp);
+}
+
+template <typename T>
+void unstableSort(MutSlice<T> s) {
+  unstableSort(s, impl::Less<T>{});
+}
+
+// The `mergeSort` overloads are stable. The ones that take a mutable source
+// use it as scratch space; its contents are unspecified afterwards.
+
+template <typename T, typename Cmp = impl::Less<T>>
+void mergeSort(MutSlice<T> dst, MutSlice<T> s, const Cmp &cmp) {
   DCHECK(dst.length == s.length);
   if (s.empty()) {
     return;
   }
   dst.copy(s);
-  ::impl::mergeSort<T>(dst, s, impl::Less<T>{});
+  stableSort(dst, s, cmp);
 }
 
 template <typename T>
-void mergeSort(MutSlice<T> dst, MutSlice<T> s) {
+void mergeSort(MutSlice<T> s) {
+  stableSort(s, impl::Less<T>{});
+}
+
+template <typename T>
+void mergeSort(MutSlice<T> dst, Slice<T> s) {
   DCHECK(dst.length == s.length);
   if (s.empty()) {
     return;
   }
   dst.copy(s);
-  ::impl::mergeSort<T>(dst, s, impl::Less<T>{});
+  stableSort(dst, impl::Less<T>{});
+}
+
+template <typename T>
+void mergeSort(MutSlice<T> dst, MutSlice<T> s) {
+  mergeSort(dst, s, impl::Less<T>{});
 }
 
 template <typename T, typename Cmp = impl::Less<T>>
 void mergeSort(MutSlice<T> s, const Cmp &cmp) {
-  if (s.empty()) {
-    return;
-  }
-
-  Arena::Scope temp = getScratch(nullptr, 0);
-  MutSlice<T> copy = duplicate<T>(temp, s);
-
-  ::impl::mergeSort<T, Cmp>(s, copy, cmp);
+  stableSort(s, cmp);
 }
-
@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2026 Daniel Meszaros
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <std/FlatSwissTable.hpp>
+#include <std/Hash.h>
+#include <std/Types.h>
+
+#include <string.h>
+#include <type_traits>
+
+/**
+ * \brief Hashes integers, enums and pointers by mixing their bits.
+ *
+ * Much cheaper than hashing the bytes of the key, while still spreading
+ * sequential keys over both halves of the hash that the table uses.
+ */
+template <typename K>
+struct HashMix {
+  static_assert(sizeof(K) <= sizeof(u64), "Key is too large to be mixed");
+
+  u64 operator()(const K &key) const {
+    u64 x;
+    if constexpr (std::is_pointer_v<K>) {
+      x = u64(uintptr_t(key));
+    } else {
+      x = u64(key);
+    }
+
+    // Finalizer of MurmurHash3
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ULL;
+    x ^= x >> 33;
+    return x;
+  }
+};
+
+/**
+ * \brief Hashes the bytes of a key with rapidhash.
+ *
+ * Keys that are equal must have identical bytes, so types with padding or
+ * floating-point members are rejected.
+ */
+template <typename K>
+struct HashBytes {
+  static_assert(std::has_unique_object_representations_v<K>,
+                "Key must not have padding or floating-point members");
+
+  u64 operator()(const K &key) const { return rpdh_micro(&key, sizeof(K)); }
+};
+
+/**
+ * \brief `HashMix` for integers, enums and pointers; `HashBytes` for
+ * everything else.
+ */
+template <typename K>
+using DefaultHash =
+    std::conditional_t<std::is_integral_v<K> || std::is_enum_v<K> ||
+                           std::is_pointer_v<K>,
+                       HashMix<K>,
+                       HashBytes<K>>;
+
+namespace impl {
+/**
+ * \brief Compares two keys with `operator==` if they have one, or by their
+ * bytes otherwise.
+ */
+template <typename K>
+static inline bool keysEqual(const K &lhs, const K &rhs) {
+  if constexpr (requires { lhs == rhs; }) {
+    return lhs == rhs;
+  } else {
+    return memcmp(&lhs, &rhs, sizeof(K)) == 0;
+  }
+}
+
+template <typename K, typename V>
+struct SwissMapSlot {
+  K key;
+  V value;
+};
+
+template <typename K>
+struct SwissSetSlot {
+  K key;
+};
+
+template <typename Slot, typename Hasher>
+struct SwissSlotHash {
+  u64 operator()(const Slot &slot) const { return Hasher{}(slot.key); }
+};
+}  // namespace impl
+
+/**
+ * \brief A Swiss table that stores keys of any trivially copyable type inline
+ * in its slots, next to the values.
+ *
+ * Keys are not copied into the arena, so maps keyed by handles, IDs or
+ * `Uuid`s cost no allocation and no indirection per entry. Hashes are not
+ * stored either; they are recomputed when the table is rehashed.
+ *
+ * Pointers to values are invalidated when the table grows or rehashes.
+ *
+ * \tparam K Key type
+ * \tparam V Value type
+ * \tparam Hasher Function object that maps a key to a 64-bit hash; see
+ * `DefaultHash`
+ */
+template <typename K, typename V, typename Hasher = DefaultHash<K>>
+struct SwissMap
+    : impl::FlatTable<impl::SwissMapSlot<K, V>,
+                      impl::SwissSlotHash<impl::SwissMapSlot<K, V>, Hasher>> {
+  static_assert(std::is_trivially_copyable_v<K> &&
+                    std::is_trivially_copyable_v<V>,
+                "Keys and values must be trivially copyable");
+
+  using Slot = impl::SwissMapSlot<K, V>;
+  using Base = impl::FlatTable<Slot, impl::SwissSlotHash<Slot, Hasher>>;
+
+  SwissMap() : SwissMap(nullptr) {}
+  /**
+   * \brief Initializes a map that allocates its control bytes and slots into
+   * the provided arena.
+   */
+  SwissMap(Arena *arena) : Base(arena) {}
+
+  /**
+   * \brief Looks up a key in the map and returns a pointer to the associated
+   * value.
+   * \returns A valid pointer to the associated value if the key is present in
+   * the map, or nullptr.
+   */
+  V *get(const K &key) {
+    Slot *slot = _findKey(key, Hasher{}(key));
+    return slot != nullptr ? &slot->value : nullptr;
+  }
+
+  /**
+   * \brief Looks up many keys at once, overlapping their cache misses.
+   * \param keys Keys to look up
+   * \param out Receives, for every key, a pointer to the associated value or
+   * nullptr if the key is not present; at least as long as `keys`
+   */
+  void getBatch(Slice<K> keys, MutSlice<V *> out) {
+    DCHECK(out.length >= keys.length);
+    this->_findBatch(
+        keys.length, [keys](size_t i) { return Hasher{}(keys[i]); },
+        [keys](size_t i, const Slot &slot) {
+          return impl::keysEqual(slot.key, keys[i]);
+        },
+        [out](size_t i, Slot *slot) {
+          out[i] = slot != nullptr ? &slot->value : nullptr;
+        });
+  }
+
+  /**
+   * \brief Sets the key to the specified value.
+   * \returns A valid pointer to the value associated with the key
+   */
+  V *put(const K &key, const V &value) {
+    u64 hash = Hasher{}(key);
+    Slot *slot = _findKey(key, hash);
+    if (slot == nullptr) {
+      slot = this->_prepareInsert(hash);
+      slot->key = key;
+    }
+
+    slot->value = value;
+    return &slot->value;
+  }
+
+  /**
+   * \brief Removes a key from the map
+   * \returns A value indicating whether the key was present in the map
+   */
+  bool remove(const K &key) {
+    Slot *slot = _findKey(key, Hasher{}(key));
+    if (slot == nullptr) {
+      return false;
+    }
+
+    this->_erase(slot);
+    return true;
+  }
+
+  Slot *_findKey(const K &key, u64 hash) {
+    return this->_find(hash, [&key](const Slot &slot) {
+      return impl::keysEqual(slot.key, key);
+    });
+  }
+};
+
+/**
+ * \brief A set of keys of any trivially copyable type; a `SwissMap` without
+ * values.
+ *
+ * \tparam K Key type
+ * \tparam Hasher Function object that maps a key to a 64-bit hash; see
+ * `DefaultHash`
+ */
+template <typename K, typename Hasher = DefaultHash<K>>
+struct SwissSet
+    : impl::FlatTable<impl::SwissSetSlot<K>,
+                      impl::SwissSlotHash<impl::SwissSetSlot<K>, Hasher>> {
+  static_assert(std::is_trivially_copyable_v<K>,
+                "Keys must be trivially copyable");
+
+  using Slot = impl::SwissSetSlot<K>;
+  using Base = impl::FlatTable<Slot, impl::SwissSlotHash<Slot, Hasher>>;
+
+  SwissSet() : SwissSet(nullptr) {}
+  /**
+   * \brief Initializes a set that allocates its control bytes and slots into
+   * the provided arena.
+   */
+  SwissSet(Arena *arena) : Base(arena) {}
+
+  /** \brief Determines whether the key is in the set */
+  bool contains(const K &key) {
+    return _findKey(key, Hasher{}(key)) != nullptr;
+  }
+
+  /**
+   * \brief Adds a key to the set
+   * \returns true if the key was not in the set before
+   */
+  bool put(const K &key) {
+    u64 hash = Hasher{}(key);
+    if (_findKey(key, hash) != nullptr) {
+      return false;
+    }
+
+    this->_prepareInsert(hash)->key = key;
+    return true;
+  }
+
+  /**
+   * \brief Removes a key from the set
+   * \returns A value indicating whether the key was in the set
+   */
+  bool remove(const K &key) {
+    Slot *slot = _findKey(key, Hasher{}(key));
+    if (slot == nullptr) {
+      return false;
+    }
+
+    this->_erase(slot);
+    return true;
+  }
+
+  Slot *_findKey(const K &key, u64 hash) {
+    return this->_find(hash, [&key](const Slot &slot) {
+      return impl::keysEqual(slot.key, key);
+    });
+  }
+};
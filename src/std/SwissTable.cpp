@@ -40,14 +40,24 @@ u8 allocateSlot(u64 &controlWordInOut, u8 h2, u8 &prevEntry) {
 }
 
 void markSlotDeleted(u64 &controlWord, u8 idxSlot) {
+  setSlotEntry(controlWord, idxSlot, CW_ENTRY_DELETED);
+}
+
+void setSlotEntry(u64 &controlWord, u8 idxSlot, u8 entry) {
   DCHECK(idxSlot < 8);
   i32 leadingZeros = idxSlot * 8;
 
   const u64 mask = u64(0xFF00000000000000) >> leadingZeros;
   // Clear slot
   controlWord = controlWord & (~mask);
-  // Set to deleted
-  controlWord = controlWord | ((u64(CW_ENTRY_DELETED) << 56) >> (leadingZeros));
+  // Set the new entry
+  controlWord = controlWord | ((u64(entry) << 56) >> (leadingZeros));
+}
+
+u64 markFullSlotsDeleted(u64 controlWord) {
+  // 0xFF in every octet that holds a key, 0x00 in every empty one
+  u64 full = ((~controlWord & CW_MASK_EMPTY) >> 7) * 0xFF;
+  return (full & 0xFEFEFEFEFEFEFEFE) | (~full & CW_MASK_EMPTY);
 }
 
 bool hasEmptySlot(u64 controlWord) {
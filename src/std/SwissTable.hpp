@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <std/CompilerInfo.h>
 #include <std/Hash.h>
 #include <std/Types.h>
 #include <std/Optional.hpp>
@@ -37,6 +38,17 @@ u8 allocateSlot(u64 &controlWord, u8 h2, u8 &prevEntry);
  * \brief Marks a slot deleted in the control word
  */
 void markSlotDeleted(u64 &controlWord, u8 idxSlot);
+/**
+ * \brief Overwrites the entry of a slot in the control word
+ * \param entry Either the low 7 bits of a hash, `CW_ENTRY_UNUSED` or
+ * `CW_ENTRY_DELETED`
+ */
+void setSlotEntry(u64 &controlWord, u8 idxSlot, u8 entry);
+/**
+ * \brief Prepares a control word for an in-place rehash: full slots are marked
+ * deleted, deleted slots are marked unused.
+ */
+u64 markFullSlotsDeleted(u64 controlWord);
 /**
  * \brief Determines whether the group has an empty slot (either unused slot or
  * deleted slot).
@@ -94,15 +106,40 @@ static inline u64 nextPowerOfTwo(u64 x) {
 
 /**
  * \brief A Swiss table for keys of Slice<K> and values of V
+ *
+ * Values are kept packed: removing a key moves the last value into the hole it
+ * leaves. Pointers to values survive growing and rehashing the table but not
+ * removals; `Handle`s survive both.
+ *
  * \tparam K Key base type. Actual key type is `Slice<K>`
  * \tparam V Value type
  */
 template <typename K, typename V>
 struct SwissTable {
+  static constexpr u32 INVALID_INDEX = 0xFFFFFFFF;
+
   struct Slot {
     MutSlice<K> key;
     u64 hash = 0;
-    size_t idxValue = 0;
+    u32 idxValue = 0;
+    u32 idxHandle = 0;
+  };
+
+  /**
+   * \brief Refers to an entry of the table until the entry is removed, no
+   * matter how many times the table grows, rehashes or moves the values
+   * around.
+   */
+  struct Handle {
+    u32 index = INVALID_INDEX;
+    u32 generation = 0;
+  };
+
+  struct HandleEntry {
+    /** \brief Index of the value, or the next free handle if unused */
+    u32 idxValue;
+    /** \brief Incremented every time the handle is freed */
+    u32 generation;
   };
 
   /** \brief Arena used to allocate keys */
@@ -111,8 +148,21 @@ struct SwissTable {
   SegmentArray<u64> controlWords;
   /** \brief Slots of each group */
   SegmentArray<Array<Slot, 8>> keys;
-  /** \brief Values stored in the table */
+  /**
+   * \brief Values stored in the table. Removals move the last value into the
+   * hole, so the array is as long as the number of keys.
+   */
   SegmentArray<V> values;
+  /** \brief Position (`8 * group + slot`) of the slot that owns each value */
+  SegmentArray<u32> valueSlots;
+  /** \brief Value index and generation behind each handle */
+  SegmentArray<HandleEntry> handles;
+  /** \brief Head of the list of free handles, or `INVALID_INDEX` */
+  u32 idxFreeHandle = INVALID_INDEX;
+  /** \brief Number of keys in the table */
+  size_t numEntries = 0;
+  /** \brief Number of slots marked deleted */
+  size_t numDeleted = 0;
 
   SwissTable() : SwissTable(nullptr) {}
   /**
@@ -120,7 +170,81 @@ struct SwissTable {
    * values into the provided arena.
    */
   SwissTable(Arena *arena)
-      : arena(arena), controlWords(arena), keys(arena), values(arena) {}
+      : arena(arena),
+        controlWords(arena),
+        keys(arena),
+        values(arena),
+        valueSlots(arena),
+        handles(arena) {}
+
+  /** \brief An entry of the table, as visited by iteration */
+  struct Entry {
+    Slice<K> key;
+    V &value;
+    Handle handle;
+  };
+
+  /**
+   * \brief Visits the full slots of every group in order.
+   *
+   * The full slots of a group are found by masking its control word, so empty
+   * and deleted slots cost nothing. Entries may be removed while iterating,
+   * but not inserted.
+   */
+  struct Iterator {
+    SwissTable *table;
+    size_t idxGroup;
+    /** \brief MSB of octet `i` is set if slot `i` is full and not visited */
+    u64 fullSlots;
+
+    Iterator(SwissTable *table, size_t idxGroup)
+        : table(table), idxGroup(idxGroup), fullSlots(0) {
+      _skipEmptyGroups();
+    }
+
+    bool operator!=(const Iterator &other) const {
+      return idxGroup != other.idxGroup || fullSlots != other.fullSlots;
+    }
+
+    Iterator &operator++() {
+      fullSlots &= fullSlots - 1;
+      // Drop the slots that were removed since the group was entered
+      fullSlots &= _fullSlotsOf(table->controlWords[idxGroup]);
+      if (fullSlots == 0) {
+        idxGroup += 1;
+        _skipEmptyGroups();
+      }
+      return *this;
+    }
+
+    Entry operator*() const {
+      u8 idxSlot = u8(7 - countTrailingZeros64(fullSlots) / 8);
+      Slot &slot = table->keys[idxGroup][idxSlot];
+      return {slot.key, table->values[slot.idxValue],
+              {slot.idxHandle, table->handles[slot.idxHandle].generation}};
+    }
+
+    static u64 _fullSlotsOf(u64 controlWord) {
+      return ~controlWord & impl::CW_MASK_EMPTY;
+    }
+
+    void _skipEmptyGroups() {
+      const size_t M = table->controlWords.length;
+      for (; idxGroup < M; idxGroup++) {
+        fullSlots = _fullSlotsOf(table->controlWords[idxGroup]);
+        if (fullSlots != 0) {
+          return;
+        }
+      }
+    }
+
+    using value_type = Entry;
+  };
+
+  using iterator = Iterator;
+
+  Iterator begin() { return Iterator(this, 0); }
+  Iterator end() { return Iterator(this, controlWords.length); }
 
   /**
    * \brief Looks up a key in the table and returns a pointer to the associated
@@ -132,11 +256,93 @@ struct SwissTable {
       return nullptr;
     }
 
+    return _get(key, hashRapidMicro(key));
+  }
+
+  /**
+   * \brief Looks up many keys at once.
+   *
+   * Keys are processed in small batches: all of them are hashed first, then
+   * the control words of their home groups are prefetched, then the slots of
+   * the candidates, and only then are the lookups resolved. The cache misses
+   * of the keys in a batch overlap instead of stalling one after the other.
+   *
+   * \param keys Keys to look up
+   * \param out Receives, for every key, a pointer to the associated value or
+   * nullptr if the key is not present; at least as long as `keys`
+   */
+  void getBatch(Slice<Slice<K>> keys, MutSlice<V *> out) {
+    DCHECK(out.length >= keys.length);
+    if (_empty()) {
+      for (size_t i = 0; i < keys.length; i++) {
+        out[i] = nullptr;
+      }
+      return;
+    }
+
+    const size_t M = controlWords.length;
+    if (M * sizeof(Array<Slot, 8>) < GET_BATCH_MIN_PREFETCH_BYTES) {
+      // The table is likely to be in the cache already; prefetching would
+      // only add overhead
+      for (size_t i = 0; i < keys.length; i++) {
+        out[i] = get(keys[i]);
+      }
+      return;
+    }
+
+    u64 hashes[GET_BATCH_SIZE];
+    size_t groups[GET_BATCH_SIZE];
+    const Slot *candidates[GET_BATCH_SIZE];
+
+    for (size_t base = 0; base < keys.length; base += GET_BATCH_SIZE) {
+      const size_t n = keys.length - base < GET_BATCH_SIZE
+                           ? keys.length - base
+                           : GET_BATCH_SIZE;
+
+      for (size_t i = 0; i < n; i++) {
+        u64 h1;
+        u8 h2;
+        hashes[i] = hashRapidMicro(keys[base + i]);
+        impl::splitHash(hashes[i], h1, h2);
+        groups[i] = impl::homeGroup(h1, M);
+        SN_PREFETCH(&controlWords[groups[i]]);
+      }
+
+      for (size_t i = 0; i < n; i++) {
+        u64 h1;
+        u8 h2;
+        impl::splitHash(hashes[i], h1, h2);
+        i32 idxSlot = _firstCandidate(controlWords[groups[i]], h2);
+        candidates[i] =
+            idxSlot >= 0 ? &this->keys[groups[i]][idxSlot] : nullptr;
+        if (candidates[i] != nullptr) {
+          SN_PREFETCH(candidates[i]);
+        }
+      }
+
+      for (size_t i = 0; i < n; i++) {
+        if (candidates[i] != nullptr) {
+          SN_PREFETCH(candidates[i]->key.data);
+          SN_PREFETCH(&values[candidates[i]->idxValue]);
+        }
+      }
+
+      for (size_t i = 0; i < n; i++) {
+        out[base + i] = _get(keys[base + i], hashes[i]);
+      }
+    }
+  }
+
+  /** \brief Number of keys `getBatch` processes together */
+  static constexpr size_t GET_BATCH_SIZE = 16;
+  /** \brief `getBatch` only prefetches if the slots take this many bytes */
+  static constexpr size_t GET_BATCH_MIN_PREFETCH_BYTES = 512 * 1024;
+
+  V *_get(Slice<K> key, u64 hash) {
     const size_t M = controlWords.length;
     DCHECK(M != 0);
     const size_t MASK = M - 1;
 
-    u64 hash = hashRapidMicro(key);
     u64 h1;
     u8 h2;
     impl::splitHash(hash, h1, h2);
@@ -173,7 +379,7 @@ struct SwissTable {
    */
   V *put(Slice<K> key, const V &value) {
     if (_empty()) {
-      _growAndRehash();
+      _resize(1);
     }
 
     const size_t M = controlWords.length;
@@ -197,36 +403,81 @@ struct SwissTable {
         return v;
       }
 
-      // Is there an empty slot in this group?
+      // Is there an unused slot in this group?
       if (impl::hasUnusedSlot(controlWords[group])) {
-        // There is an empty slot; if the key were to be present in this table,
-        // it would be in this group, but it's not.
-        return _insertIntoGroup(group, key, value, hash, h2);
+        // There is an unused slot; if the key were to be present in this
+        // table, it would be in this group, but it's not.
+        break;
       }
 
-      // Check the next group for empty slots
+      // Check the next group
     }
 
-    // Probing failed; look for an empty slot
-    for (size_t i = 0; i < M; i++) {
-      size_t group = (homeGroup + i) & MASK;
-      u64 controlWord = controlWords[group];
+    size_t group = _findGroupWithEmptySlot(h1);
+    if (_firstEmptySlotEntry(controlWords[group]) == impl::CW_ENTRY_UNUSED &&
+        numEntries + numDeleted >= _maxLoad()) {
+      // Taking an unused slot would push the load factor over the limit
+      _growAndRehash();
+      group = _findGroupWithEmptySlot(h1);
+    }
 
-      if (!impl::hasEmptySlot(controlWord)) {
-        continue;
-      }
+    return _insertIntoGroup(group, key, value, hash, h2);
+  }
 
-      // Is there an empty slot in this group?
-      if (!impl::hasUnusedSlot(controlWords[group])) {
-        continue;
-      }
+  /**
+   * \brief Makes room for at least `n` keys, so that inserting that many keys
+   * doesn't rehash the table.
+   */
+  void reserve(size_t n) {
+    size_t numGroups = 1;
+    while (_maxLoad(numGroups) < n) {
+      numGroups *= 2;
+    }
 
-      return _insertIntoGroup(group, key, value, hash, h2);
+    if (numGroups > controlWords.length) {
+      _resize(numGroups);
     }
+    values.reserve(n);
+    valueSlots.reserve(n);
+    handles.reserve(n);
+  }
 
-    // Insert into a new group
-    _growAndRehash();
-    return put(key, value);
+  /**
+   * \brief Returns a handle to the entry of the key.
+   * \returns A handle to the entry if the key is present in the table, or an
+   * invalid handle.
+   */
+  Handle handleOf(Slice<K> key) {
+    if (_empty()) {
+      return {};
+    }
+
+    size_t group;
+    u8 idxSlot;
+    if (!_findSlot(key, group, idxSlot)) {
+      return {};
+    }
+
+    u32 idxHandle = keys[group][idxSlot].idxHandle;
+    return {idxHandle, handles[idxHandle].generation};
+  }
+
+  /**
+   * \brief Returns a pointer to the value of the entry the handle refers to.
+   * \returns A valid pointer to the value, or nullptr if the entry was
+   * removed or the handle is invalid.
+   */
+  V *resolve(Handle handle) {
+    if (handle.index >= handles.length) {
+      return nullptr;
+    }
+
+    const HandleEntry &entry = handles[handle.index];
+    if (entry.generation != handle.generation) {
+      return nullptr;
+    }
+
+    return &values[entry.idxValue];
   }
 
   /**
@@ -239,8 +490,79 @@ struct SwissTable {
       return false;
     }
 
+    size_t group;
+    u8 idxSlot;
+    if (!_findSlot(key, group, idxSlot)) {
+      return false;
+    }
+
+    _removeSlot(group, idxSlot);
+    return true;
+  }
+
+  /**
+   * \brief Removes the entry the handle refers to
+   * \returns A value indicating whether the entry was still in the table
+   */
+  bool remove(Handle handle) {
+    if (resolve(handle) == nullptr) {
+      return false;
+    }
+
+    u32 pos = valueSlots[handles[handle.index].idxValue];
+    _removeSlot(pos / 8, u8(pos % 8));
+    return true;
+  }
+
+  /**
+   * \brief Marks the slot deleted, gives back its handle and fills the hole
+   * its value leaves with the last value.
+   */
+  void _removeSlot(size_t idxGroup, u8 idxSlot) {
+    const Slot &slot = keys[idxGroup][idxSlot];
+
+    const u32 idxLast = values.length - 1;
+    if (slot.idxValue != idxLast) {
+      u32 pos = valueSlots[idxLast];
+      Slot &moved = keys[pos / 8][pos % 8];
+      values[slot.idxValue] = values[idxLast];
+      valueSlots[slot.idxValue] = pos;
+      moved.idxValue = slot.idxValue;
+      handles[moved.idxHandle].idxValue = slot.idxValue;
+    }
+    values.pop();
+    valueSlots.pop();
+
+    HandleEntry &handle = handles[slot.idxHandle];
+    handle.generation += 1;
+    handle.idxValue = idxFreeHandle;
+    idxFreeHandle = slot.idxHandle;
+
+    impl::markSlotDeleted(controlWords[idxGroup], idxSlot);
+    numEntries -= 1;
+    numDeleted += 1;
+  }
+
+  /** \brief Takes a handle off the free list or creates a new one */
+  u32 _allocateHandle(u32 idxValue) {
+    if (idxFreeHandle == INVALID_INDEX) {
+      handles.push({idxValue, 0});
+      return handles.length - 1;
+    }
+
+    u32 idxHandle = idxFreeHandle;
+    HandleEntry &handle = handles[idxHandle];
+    idxFreeHandle = handle.idxValue;
+    handle.idxValue = idxValue;
+    return idxHandle;
+  }
+
+  /**
+   * \brief Finds the slot that holds the key.
+   * \returns A value indicating whether the key is present in the table
+   */
+  bool _findSlot(Slice<K> key, size_t &groupOut, u8 &idxSlotOut) {
     const size_t M = controlWords.length;
-    DCHECK(M != 0);
     const size_t MASK = M - 1;
 
     u64 hash = hashRapidMicro(key);
@@ -249,114 +571,145 @@ struct SwissTable {
     impl::splitHash(hash, h1, h2);
 
     const size_t homeGroup = impl::homeGroup(h1, M);
-
     for (size_t i = 0; i < M; i++) {
       size_t group = (homeGroup + i) & MASK;
-
-      // Is the elem already in this group?
-      u8 idxSlot;
-      V *v = _findWithinGroup(group, key, hash, h2, idxSlot);
-      if (v != nullptr) {
-        impl::markSlotDeleted(controlWords[group], idxSlot);
+      if (_findWithinGroup(group, key, hash, h2, idxSlotOut) != nullptr) {
+        groupOut = group;
         return true;
       }
 
-      // Is there an unused slot in this group?
+      // An insertion would have used an unused slot of this group
       if (impl::hasUnusedSlot(controlWords[group])) {
-        // If so, an insertion would have used that slot, therefore the key is
-        // not present
         return false;
       }
-
-      // Check the next group
     }
 
     return false;
   }
 
-  size_t _growAndRehash() {
-    DCHECK(controlWords.length == keys.length);
-    size_t idx = controlWords.length;
+  /**
+   * \brief Number of keys that fit into the given number of groups while
+   * keeping the load factor at or below 7/8.
+   */
+  static size_t _maxLoad(size_t numGroups) { return numGroups * 7; }
+  size_t _maxLoad() const { return _maxLoad(controlWords.length); }
 
-    // NOTE(danielm): number of groups always grows to the next power of two
-    size_t lenDouble = impl::nextPowerOfTwo(controlWords.length);
-    DCHECK(lenDouble != controlWords.length);
+  /**
+   * \brief Makes room for one more key. If most of the occupied slots are
+   * deleted, they are reclaimed without growing the table; otherwise the
+   * number of groups is doubled.
+   */
+  void _growAndRehash() {
+    if (numEntries <= _maxLoad() / 2) {
+      _rehashInPlace();
+    } else {
+      _resize(controlWords.length * 2);
+    }
+  }
+
+  /**
+   * \brief Grows the table to the specified number of groups and moves every
+   * key to its new place.
+   *
+   * The segment arrays grow in place, so existing slots and values are never
+   * copied anywhere else.
+   */
+  void _resize(size_t numGroups) {
+    DCHECK(controlWords.length == keys.length);
+    DCHECK((numGroups & (numGroups - 1)) == 0);
+    const size_t numGroupsOld = controlWords.length;
 
-    while (controlWords.length < lenDouble) {
+    controlWords.reserve(numGroups);
+    keys.reserve(numGroups);
+    while (controlWords.length < numGroups) {
       controlWords.push(impl::CW_MASK_EMPTY);
       keys.push();
     }
 
-    if (idx == 0) {
-      // First group, no need to rehash
-      return idx;
+    if (numGroupsOld != 0) {
+      _rehashInPlace();
     }
+  }
 
+  /**
+   * \brief Moves every key to the first group with an empty slot on its probe
+   * sequence, reclaiming every deleted slot in the process.
+   *
+   * Keys are first marked deleted, then each one is either left in place,
+   * moved into an unused slot or swapped with a key that is still waiting to
+   * be placed.
+   */
+  void _rehashInPlace() {
     const size_t M = controlWords.length;
-    const size_t MASK = M - 1;
-
-    Arena::Scope temp = getScratchFor(arena);
-
-    // Make a copy of all slots and control words
-    SegmentArray<Array<Slot, 8>> keysCopy(temp);
-    SegmentArray<u64> controlWordsCopy(temp);
-    keysCopy.grow(this->keys.numSegments);
-    controlWordsCopy.grow(this->keys.numSegments);
 
-    const size_t N = this->controlWords.length;
-    for (size_t group = 0; group < N - 1; group++) {
-      controlWordsCopy[group] = this->controlWords[group];
-      for (size_t j = 0; j < 8; j++) {
-        keysCopy[group][j] = this->keys[group][j];
-      }
-    }
-
-    // Clear slots
-    for (size_t group = 0; group < N; group++) {
-      this->controlWords[group] = impl::CW_MASK_EMPTY;
+    for (size_t group = 0; group < M; group++) {
+      controlWords[group] = impl::markFullSlotsDeleted(controlWords[group]);
     }
 
-    // Reinsert keys into the grown table
-    for (size_t groupOrig = 0; groupOrig < N - 1; groupOrig++) {
-      u64 controlWord = controlWordsCopy[groupOrig];
+    for (size_t group = 0; group < M; group++) {
       for (u8 j = 0; j < 8; j++) {
-        u8 controlWordSlot = impl::extractSlotFromControlWord(controlWord, j);
-        if ((controlWordSlot & impl::CW_ENTRY_MASK) != 0) {
-          continue;
-        }
-
-        DCHECK(controlWordSlot != impl::CW_ENTRY_UNUSED);
-        DCHECK(controlWordSlot != impl::CW_ENTRY_DELETED);
-
-        const Slot &slot0 = keysCopy[groupOrig][j];
-        u64 h1;
-        u8 h2;
-        impl::splitHash(slot0.hash, h1, h2);
-
-        const size_t homeGroup = impl::homeGroup(h1, M);
-
-        size_t i;
-        for (i = 0; i < M; i++) {
-          size_t group = (homeGroup + i) & MASK;
-          if ((this->controlWords[group] & impl::CW_MASK_EMPTY) == 0) {
-            continue;
+        // Keys swapped into this slot need to be placed, too
+        while (impl::extractSlotFromControlWord(controlWords[group], j) ==
+               impl::CW_ENTRY_DELETED) {
+          Slot &slot = keys[group][j];
+          u64 h1;
+          u8 h2;
+          impl::splitHash(slot.hash, h1, h2);
+
+          size_t target = _findGroupWithEmptySlot(h1);
+          if (target == group) {
+            // Already on the right place
+            impl::setSlotEntry(controlWords[group], j, h2);
+            break;
           }
 
           u8 entry;
-          size_t idxSlot =
-              impl::allocateSlot(this->controlWords[group], h2, entry);
-          Slot &slot = this->keys[group][idxSlot];
-          slot.key = slot0.key;
-          slot.hash = slot0.hash;
-          slot.idxValue = slot0.idxValue;
-          break;
-        }
+          u8 idxSlot = impl::allocateSlot(controlWords[target], h2, entry);
+          Slot &slotTarget = keys[target][idxSlot];
+          if (entry == impl::CW_ENTRY_UNUSED) {
+            slotTarget = slot;
+            slot = {};
+            valueSlots[slotTarget.idxValue] = u32(target * 8 + idxSlot);
+            impl::setSlotEntry(controlWords[group], j, impl::CW_ENTRY_UNUSED);
+            break;
+          }
 
-        DCHECK(i != M);
+          // The target held a key that is yet to be placed
+          Slot tmp = slotTarget;
+          slotTarget = slot;
+          slot = tmp;
+          valueSlots[slotTarget.idxValue] = u32(target * 8 + idxSlot);
+          valueSlots[slot.idxValue] = u32(group * 8 + j);
+        }
       }
     }
 
-    return idx;
+    numDeleted = 0;
+  }
+
+  /**
+   * \brief Finds the first group on the probe sequence that has an empty slot
+   * (either unused or deleted).
+   */
+  size_t _findGroupWithEmptySlot(u64 h1) const {
+    const size_t M = controlWords.length;
+    const size_t MASK = M - 1;
+    size_t group = impl::homeGroup(h1, M);
+    // The load factor keeps at least one slot unused
+    while (!impl::hasEmptySlot(controlWords[group])) {
+      group = (group + 1) & MASK;
+    }
+    return group;
+  }
+
+  /**
+   * \brief Returns the entry of the slot that `impl::allocateSlot` would
+   * allocate in the control word.
+   */
+  static u8 _firstEmptySlotEntry(u64 controlWord) {
+    i32 leadingZeros = countLeadingZeros64(controlWord & impl::CW_MASK_EMPTY);
+    DCHECK(leadingZeros != 64);
+    return impl::extractSlotFromControlWord(controlWord, u8(leadingZeros / 8));
   }
 
   V *_insertIntoGroup(size_t idxGroup,
@@ -371,25 +724,29 @@ struct SwissTable {
     slot.hash = hash;
     if (entry == impl::CW_ENTRY_UNUSED) {
       slot.key = duplicate(arena, key);
-      slot.idxValue = values.length;
-      values.push(value);
     } else if (entry == impl::CW_ENTRY_DELETED) {
-      if (slot.key.length <= key.length) {
-        // key of deleted entry was smaller than the new key; reuse the space
-        // instead of allocating a new one
+      if (key.length <= slot.key.length) {
+        // key of deleted entry was at least as long as the new key; reuse the
+        // space instead of allocating a new one
         MutSlice<K> k = slot.key;
         k.length = key.length;
         k.copy(key);
+        slot.key = k;
       } else {
         slot.key = duplicate(arena, key);
       }
 
-      // Re-use the current idxValue
-      values[slot.idxValue] = value;
+      numDeleted -= 1;
     } else {
       CHECK(0);
     }
 
+    slot.idxValue = values.length;
+    values.push(value);
+    valueSlots.push(u32(idxGroup * 8 + idxSlot));
+    slot.idxHandle = _allocateHandle(slot.idxValue);
+    numEntries += 1;
+
     return &values[slot.idxValue];
   }
 
@@ -431,6 +788,26 @@ struct SwissTable {
     return nullptr;
   }
 
+  /**
+   * \brief Returns the index of the first slot in the control word whose entry
+   * is `h2`, or -1 if there is none.
+   */
+  static i32 _firstCandidate(const u64 &controlWord, u8 h2) {
+#if defined(__ARM_NEON)
+    u64 candidateMask = impl::hasKeyNEON(controlWord, h2);
+    if (candidateMask == 0) {
+      return -1;
+    }
+    return 7 - (countTrailingZeros64(candidateMask) >> 3);
+#else
+    u8 candidateMask = impl::hasKey(controlWord, h2);
+    if (candidateMask == 0) {
+      return -1;
+    }
+    return 7 - countTrailingZeros(candidateMask);
+#endif
+  }
+
   V *_findWithinGroup(size_t idxGroup, Slice<K> key, u64 hash, u8 h2) {
     u8 groupIdx;
     return _findWithinGroup(idxGroup, key, hash, h2, groupIdx);
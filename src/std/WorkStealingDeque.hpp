@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2026 Daniel Meszaros
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include "std/Arena.h"
+#include "std/Check.h"
+#include "std/Optional.hpp"
+#include "std/Types.h"
+
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * \brief A fixed-capacity Chase-Lev work-stealing deque.
+ *
+ * The owner thread pushes and pops at the bottom end; any other thread may
+ * steal from the top end. Based on "Correct and Efficient Work-Stealing for
+ * Weak Memory Models" (Le, Pop, Cohen, Zappa Nardelli; PPoPP 2013).
+ *
+ * Elements are stored as relaxed atomic words, so a thief that loses the race
+ * for an element may read a torn value, but it will always discard it.
+ */
+template <typename T>
+struct WorkStealingDeque {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "Elements of a work-stealing deque must be trivially copyable");
+
+  static constexpr size_t NumWords =
+      (sizeof(T) + sizeof(u64) - 1) / sizeof(u64);
+
+  struct Cell {
+    std::atomic<u64> words[NumWords];
+  };
+
+  alignas(64) std::atomic<i64> top;
+  alignas(64) std::atomic<i64> bottom;
+  Cell *cells;
+  i64 mask;
+
+  /**
+   * \brief Initializes the deque.
+   * \param arena Arena to allocate the storage from.
+   * \param capacity Number of elements the deque can hold; must be a power of
+   * two.
+   */
+  void init(Arena *arena, u32 capacity) {
+    CHECK(capacity != 0 && (capacity & (capacity - 1)) == 0);
+    cells = alloc<Cell>(arena, capacity);
+    mask = i64(capacity) - 1;
+    top.store(0, std::memory_order_relaxed);
+    bottom.store(0, std::memory_order_relaxed);
+  }
+
+  /**
+   * \brief Pushes an element onto the bottom of the deque. May only be called
+   * by the owner thread.
+   * \return false if the deque is full.
+   */
+  bool push(const T &elem) {
+    i64 b = bottom.load(std::memory_order_relaxed);
+    i64 t = top.load(std::memory_order_acquire);
+    if (b - t > mask) {
+      return false;
+    }
+
+    store(cells[b & mask], elem);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /**
+   * \brief Pops an element from the bottom of the deque. May only be called by
+   * the owner thread.
+   */
+  Optional<T> pop() {
+    i64 b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    i64 t = top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+      // Deque was empty
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return {};
+    }
+
+    T ret = load(cells[b & mask]);
+    if (t == b) {
+      // This was the last element; race the thieves for it
+      bool won = top.compare_exchange_strong(t, t + 1,
+                                             std::memory_order_seq_cst,
+                                             std::memory_order_relaxed);
+      bottom.store(b + 1, std::memory_order_relaxed);
+      if (!won) {
+        return {};
+      }
+    }
+
+    return ret;
+  }
+
+  /**
+   * \brief Tries to steal an element from the top of the deque. May be called
+   * from any thread.
+   *
+   * Returns nothing if the deque was empty or if another thread has won the
+   * race for the top element.
+   */
+  Optional<T> steal() {
+    i64 t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    i64 b = bottom.load(std::memory_order_acquire);
+
+    if (t >= b) {
+      return {};
+    }
+
+    T ret = load(cells[t & mask]);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                     std::memory_order_relaxed)) {
+      return {};
+    }
+
+    return ret;
+  }
+
+  /**
+   * \brief Approximate number of elements in the deque.
+   */
+  size_t sizeApprox() const {
+    i64 b = bottom.load(std::memory_order_relaxed);
+    i64 t = top.load(std::memory_order_relaxed);
+    return b > t ? size_t(b - t) : 0;
+  }
+
+ private:
+  static void store(Cell &cell, const T &elem) {
+    u64 words[NumWords] = {};
+    memcpy(words, &elem, sizeof(T));
+    for (size_t i = 0; i < NumWords; i++) {
+      cell.words[i].store(words[i], std::memory_order_relaxed);
+    }
+  }
+
+  static T load(const Cell &cell) {
+    u64 words[NumWords];
+    for (size_t i = 0; i < NumWords; i++) {
+      words[i] = cell.words[i].load(std::memory_order_relaxed);
+    }
+    T ret;
+    memcpy(&ret, words, sizeof(T));
+    return ret;
+  }
+};
+
+/**
+ * \brief A fixed-capacity multi-producer multi-consumer queue.
+ *
+ * Based on Dmitry Vyukov's bounded MPMC queue.
+ */
+template <typename T>
+struct MpmcQueue {
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T data;
+  };
+
+  alignas(64) std::atomic<size_t> posEnqueue;
+  alignas(64) std::atomic<size_t> posDequeue;
+  Cell *cells;
+  size_t mask;
+
+  /**
+   * \brief Initializes the queue.
+   * \param arena Arena to allocate the storage from.
+   * \param capacity Number of elements the queue can hold; must be a power of
+   * two.
+   */
+  void init(Arena *arena, u32 capacity) {
+    CHECK(capacity != 0 && (capacity & (capacity - 1)) == 0);
+    cells = alloc<Cell>(arena, capacity);
+    mask = size_t(capacity) - 1;
+    for (size_t i = 0; i < capacity; i++) {
+      cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    posEnqueue.store(0, std::memory_order_relaxed);
+    posDequeue.store(0, std::memory_order_relaxed);
+  }
+
+  /**
+   * \brief Appends an element to the queue.
+   * \return false if the queue is full.
+   */
+  bool enqueue(const T &elem) {
+    size_t pos = posEnqueue.load(std::memory_order_relaxed);
+    Cell *cell;
+    while (true) {
+      cell = &cells[pos & mask];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = intptr_t(seq) - intptr_t(pos);
+      if (diff == 0) {
+        if (posEnqueue.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = posEnqueue.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->data = elem;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * \brief Removes the element at the front of the queue.
+   */
+  Optional<T> dequeue() {
+    size_t pos = posDequeue.load(std::memory_order_relaxed);
+    Cell *cell;
+    while (true) {
+      cell = &cells[pos & mask];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = intptr_t(seq) - intptr_t(pos + 1);
+      if (diff == 0) {
+        if (posDequeue.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return {};
+      } else {
+        pos = posDequeue.load(std::memory_order_relaxed);
+      }
+    }
+
+    T ret = cell->data;
+    cell->sequence.store(pos + mask + 1, std::memory_order_release);
+    return ret;
+  }
+};
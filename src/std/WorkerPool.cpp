@@ -13,44 +13,252 @@
 #include "std/Slice.hpp"
 #include "std/SliceUtils.hpp"
 #include "std/Types.h"
+#include "std/WorkStealingDeque.hpp"
 #include "std/os/Thread.hpp"
 
 #include <atomic>
+#include <thread>
+
+/** A dispatch that is waiting for other work contracts to finish. */
+struct PendingDispatch {
+  impl::AtomicU32 numDependencies;
+
+  WorkerPool *workerPool;
+  WorkContract *workContract;
+  void *parameters;
+  u32 numThreadsX, numThreadsY, numThreadsZ;
+};
+
+struct Continuation {
+  Continuation *next;
+  PendingDispatch *pendingDispatch;
+};
+
+static void runContinuations(Continuation *continuations);
 
 struct WorkContract {
+  // The low bits count the pending jobs. The thread that finishes the last
+  // job adds a `FINISHING_HOLD` to the count in the same step and drops it
+  // once it no longer touches the contract, so the contract isn't seen as
+  // finished, and can't be freed, while the continuations are taken.
+  static constexpr u32 FINISHING_HOLD = 1u << 24;
+  static constexpr u32 JOBS_MASK = FINISHING_HOLD - 1;
+
   alignas(64) impl::AtomicU32 numPending;
   KernelEntryPoint entryPoint;
   const char *label;
   u32 flags = 0;
+  u32 grainSize = 0;
+
+  // Dispatches to run when the last pending job finishes; guarded by
+  // `continuationsLock`
+  std::atomic<bool> continuationsLock;
+  Continuation *continuations;
 
   void notifyJobDispatched() { numPending.fetchAdd(1); }
   bool notifyJobFinished() {
-    u32 prev = numPending.fetchSub(1);
+    u32 prev = numPending.load();
+    while (true) {
+      DCHECK((prev & JOBS_MASK) != 0);
+      bool isLast = (prev & JOBS_MASK) == 1;
+      u32 next = isLast ? prev - 1 + FINISHING_HOLD : prev - 1;
+      if (numPending.compareExchange(prev, next)) {
+        if (!isLast) {
+          return false;
+        }
+        break;
+      }
+      prev = numPending.load();
+    }
 
-    if (prev == 1) {
-      numPending.notifyAll();
-      return true;
+    lockContinuations();
+    Continuation *ready = continuations;
+    continuations = nullptr;
+    unlockContinuations();
+
+    numPending.notifyAll();
+    // The contract may be freed from here on
+    numPending.fetchSub(FINISHING_HOLD);
+    runContinuations(ready);
+    return true;
+  }
+
+  /**
+   * Registers a continuation. Returns false if the contract has no pending
+   * jobs, in which case the continuation should run right away.
+   */
+  bool addContinuation(Continuation *continuation) {
+    lockContinuations();
+    if ((numPending.load() & JOBS_MASK) == 0) {
+      unlockContinuations();
+      return false;
     }
 
-    return false;
+    continuation->next = continuations;
+    continuations = continuation;
+    unlockContinuations();
+    return true;
+  }
+
+  void lockContinuations() {
+    while (continuationsLock.exchange(true, std::memory_order_acquire)) {
+      while (continuationsLock.load(std::memory_order_relaxed)) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  void unlockContinuations() {
+    continuationsLock.store(false, std::memory_order_release);
   }
 
   void wait() {
     u32 c = numPending.load();
     while (c != 0) {
-      numPending.wait(c);
+      if ((c & JOBS_MASK) == 0) {
+        // The last job has finished; its thread is about to let go
+        std::this_thread::yield();
+      } else {
+        numPending.wait(c);
+      }
       c = numPending.load();
     }
   }
 };
 
+/**
+ * A contiguous range of the linearized thread indices of a dispatch. Index `i`
+ * corresponds to the thread index
+ * `(i % numThreadsX, (i / numThreadsX) % numThreadsY, i / (numThreadsX *
+ * numThreadsY))`.
+ */
+struct JobRange {
+  u64 begin;
+  u64 end;
+  // Ranges larger than this may be split further
+  u64 grainSize;
+  u32 numThreadsX;
+  u32 numThreadsY;
+
+  ThreadIndex threadIndexAt(u64 idx) const {
+    u64 xy = idx / numThreadsX;
+    return {
+        .x = size_t(idx % numThreadsX),
+        .y = size_t(xy % numThreadsY),
+        .z = size_t(xy / numThreadsY),
+    };
+  }
+};
+
+/**
+ * Splits the grid of a dispatch into at most `maxNumChunks` ranges of similar
+ * size and calls `fn` with each of them.
+ */
+template <typename Fn>
+static void forEachJobRange(WorkContract *wc,
+                            u32 numThreadsX,
+                            u32 numThreadsY,
+                            u32 numThreadsZ,
+                            u32 maxNumChunks,
+                            Fn &&fn) {
+  const u64 numTotal = u64(numThreadsX) * numThreadsY * numThreadsZ;
+  if (numTotal == 0) {
+    return;
+  }
+
+  // Unless set by the user, aim for a handful of grains per worker
+  u64 grainSize = wc->grainSize;
+  if (grainSize == 0) {
+    grainSize = numTotal / (u64(maxNumChunks) * 8);
+    grainSize = grainSize != 0 ? grainSize : 1;
+  }
+
+  u64 numChunks = (numTotal + grainSize - 1) / grainSize;
+  numChunks = numChunks < maxNumChunks ? numChunks : maxNumChunks;
+  numChunks = numChunks != 0 ? numChunks : 1;
+
+  for (u64 idxChunk = 0; idxChunk < numChunks; idxChunk++) {
+    fn(JobRange{
+        .begin = numTotal * idxChunk / numChunks,
+        .end = numTotal * (idxChunk + 1) / numChunks,
+        .grainSize = grainSize,
+        .numThreadsX = numThreadsX,
+        .numThreadsY = numThreadsY,
+    });
+  }
+}
+
+/**
+ * Drops one of the dependencies of a pending dispatch; the last one dispatches
+ * it.
+ */
+static void notifyDependencyFinished(PendingDispatch *pd) {
+  if (pd->numDependencies.fetchSub(1) != 1) {
+    return;
+  }
+
+  WorkContract *wc = pd->workContract;
+  pd->workerPool->dispatch(wc, pd->parameters, pd->numThreadsX,
+                           pd->numThreadsY, pd->numThreadsZ);
+  // Drop the job that has been keeping the contract pending since
+  // `dispatchAfter`
+  wc->notifyJobFinished();
+}
+
+static void runContinuations(Continuation *continuations) {
+  while (continuations != nullptr) {
+    // The dispatch may finish and free the node; read the link first
+    Continuation *next = continuations->next;
+    notifyDependencyFinished(continuations->pendingDispatch);
+    continuations = next;
+  }
+}
+
+static void dispatchAfterImpl(WorkerPool *workerPool,
+                              Arena *arena,
+                              WorkContract *workContract,
+                              Slice<WorkContract *> dependencies,
+                              void *parameters,
+                              u32 numThreadsX,
+                              u32 numThreadsY,
+                              u32 numThreadsZ) {
+  DCHECK(workContract);
+
+  PendingDispatch *pd = alloc<PendingDispatch>(arena);
+  pd->workerPool = workerPool;
+  pd->workContract = workContract;
+  pd->parameters = parameters;
+  pd->numThreadsX = numThreadsX;
+  pd->numThreadsY = numThreadsY;
+  pd->numThreadsZ = numThreadsZ;
+  // One extra so that the dispatch can't happen while we're still registering
+  // the continuations
+  pd->numDependencies.store(u32(dependencies.length) + 1);
+
+  // The contract counts as pending until it's actually dispatched, so that
+  // `release` and contracts depending on it will wait for it
+  workContract->notifyJobDispatched();
+
+  Continuation *continuations = alloc<Continuation>(arena, dependencies.length);
+  for (auto [dependency, i] : dependencies) {
+    DCHECK(dependency != workContract);
+    continuations[i].pendingDispatch = pd;
+    if (!dependency->addContinuation(&continuations[i])) {
+      // Already finished
+      notifyDependencyFinished(pd);
+    }
+  }
+
+  notifyDependencyFinished(pd);
+}
+
 struct Job {
   std::atomic<bool> occupied;
   bool isPriority;
 
   WorkContract *workContract;
   void *parameters;
-  ThreadIndex x;
+  JobRange range;
 };
 
 struct SignalTreeAndJobs {
@@ -58,134 +266,385 @@ struct SignalTreeAndJobs {
 
   SignalTree<10> signalTree;
   Job jobs[SignalTree<10>::NumLeafNodes];
+  std::atomic<u32> idxLastJobSlotUsed;
+
+  /**
+   * Finds a free job slot and marks it as occupied. Gives up after looking at
+   * every slot once.
+   */
+  Optional<u32> tryAllocateJobIndex() {
+    constexpr u32 Mask = SignalTree<10>::NodeIndexMask;
+
+    // Start from one past the previously used slot
+    u32 idxJob =
+        (idxLastJobSlotUsed.load(std::memory_order_relaxed) + 1) & Mask;
+    for (u32 i = 0; i < SignalTree<10>::NumLeafNodes; i++) {
+      Job &job = jobs[idxJob];
+      bool expected = false;
+      if (!job.occupied.load(std::memory_order_relaxed) &&
+          job.occupied.compare_exchange_strong(expected, true,
+                                               std::memory_order_acquire)) {
+        return idxJob;
+      }
+
+      idxJob = (idxJob + 1) & Mask;
+    }
+
+    return {};
+  }
+
+  /** Fills in an allocated job slot and signals it. */
+  void publishJob(u32 idxJob,
+                  WorkContract *workContract,
+                  void *parameters,
+                  const JobRange &range,
+                  bool isPriority) {
+    Job &job = jobs[idxJob];
+    job.workContract = workContract;
+    job.isPriority = isPriority;
+    job.range = range;
+    job.parameters = parameters;
+    workContract->notifyJobDispatched();
+
+    // Set the signal for this job
+    signalTree.setSignalForJob(idxJob, isPriority);
+    idxLastJobSlotUsed.store(idxJob, std::memory_order_relaxed);
+  }
 };
 
-struct WorkerThreadProcInfo {
-  SignalTreeAndJobs *stj;
-  size_t idxThread;
-  WorkerPool *workerPool;
+/** Runs the worker initializer on the calling worker thread, if set. */
+static void runWorkerInitializer(
+    const Optional<WorkerPoolWorkerInitializer> &init,
+    size_t idxThread,
+    WorkerPool *workerPool) {
+  if (!init.hasValue()) {
+    return;
+  }
 
-  Optional<WorkerPoolWorkerInitializer> init;
+  Dispatch D = {
+      .parameters = init->parameters,
+      .threadIndex = {.x = idxThread, .y = 0, .z = 0},
+      .idxPhysicalThread = idxThread,
+      .workerPool = workerPool,
+  };
+  init->func(&D);
+}
+
+/** Scratch arenas owned by a worker thread. */
+struct WorkerScratch {
+  Arena arenas[2];
 };
 
-static void workerThreadProc(void *arg) {
-  auto [stj, idxThread, workerPool, init] =
-      *reinterpret_cast<WorkerThreadProcInfo *>(arg);
+/**
+ * Creates the scratch arenas of the calling worker thread and installs them
+ * as its allocators, if the pool was asked to.
+ */
+static void beginWorkerScratch(const Optional<size_t> &sizReserve,
+                               WorkerScratch *scratch) {
+  if (!sizReserve.hasValue()) {
+    return;
+  }
 
-  if (init.hasValue()) {
-    Dispatch D = {
-        .parameters = init->parameters,
-        .threadIndex = {.x = idxThread, .y = 0, .z = 0},
-        .idxPhysicalThread = idxThread,
-        .workerPool = workerPool,
-    };
-    init->func(&D);
+  for (Arena &arena : scratch->arenas) {
+    arena = createGrowableArena(*sizReserve);
+    CHECK(arena.reserveBeg != nullptr);
   }
+  setAllocatorsForThread(&scratch->arenas[0], &scratch->arenas[1]);
+}
 
-  while (!stj->shutdown) {
-    // Try to decrement the root node. If we can do that, we'll have a guarantee
-    // that a path exists in the tree to a job
-    bool ok = false;
-    for (u32 numAttempts = 0; numAttempts < 64; numAttempts++) {
-      u32 rootCount = stj->signalTree.nodes[0].counter.load();
-      if (rootCount == 0) {
-        break;
+static void endWorkerScratch(const Optional<size_t> &sizReserve,
+                             WorkerScratch *scratch) {
+  if (!sizReserve.hasValue()) {
+    return;
+  }
+
+  setAllocatorsForThread(nullptr, nullptr);
+  for (Arena &arena : scratch->arenas) {
+    destroyGrowableArena(&arena);
+  }
+}
+
+/**
+ * Runs a range of thread indices of a work contract on the calling thread.
+ *
+ * Before every grain of work, if the remaining range is large enough, its upper
+ * half is offered to `offload`. If `offload` returns true, it has published
+ * the range as a new job of `wc` and we don't have to run it.
+ */
+template <typename OffloadFn>
+static void runJobRange(WorkContract *wc,
+                        void *parameters,
+                        const JobRange &range,
+                        size_t idxThread,
+                        WorkerPool *workerPool,
+                        OffloadFn &&offload) {
+  Dispatch dispatch = {parameters, range.threadIndexAt(range.begin), idxThread,
+                       workerPool};
+  ThreadIndex &x = dispatch.threadIndex;
+
+  const u64 grainSize = range.grainSize;
+  u64 idx = range.begin;
+  u64 end = range.end;
+  while (idx < end) {
+    if (end - idx >= 2 * grainSize) {
+      JobRange upper = range;
+      upper.begin = idx + (end - idx) / 2;
+      upper.end = end;
+      if (offload(upper)) {
+        end = upper.begin;
       }
+    }
 
-      if (!stj->signalTree.nodes[0].counter.compareExchange(rootCount,
-                                                            rootCount - 1)) {
-        continue;
+    const u64 stop = end - idx > grainSize ? idx + grainSize : end;
+    for (; idx < stop; idx++) {
+      wc->entryPoint(&dispatch);
+
+      x.x++;
+      if (x.x == range.numThreadsX) {
+        x.x = 0;
+        x.y++;
+        if (x.y == range.numThreadsY) {
+          x.y = 0;
+          x.z++;
+        }
       }
-      ok = true;
-      break;
     }
+  }
 
-    if (!ok) {
-      // Couldn't decrement the root node; give up and go to sleep
-      stj->signalTree.waitForRootToChange();
+  bool wcOwned = wc->flags & INTERNAL_WC_OWNED;
+  bool contractIsFinished = wc->notifyJobFinished();
+
+  if (contractIsFinished && wcOwned) {
+    delete[] reinterpret_cast<u8 *>(parameters);
+  }
+}
+
+static WorkContract *createWorkContractImpl(Arena *arena,
+                                            KernelEntryPoint entry,
+                                            u32 flags,
+                                            u32 grainSize) {
+  static constexpr u32 INTERNAL_MASK = INTERNAL_WC_OWNED;
+  DCHECK((flags & INTERNAL_MASK) == 0);
+  flags &= ~INTERNAL_MASK;
+
+  WorkContract *wc = alloc<WorkContract>(arena);
+  wc->numPending.store(0);
+  wc->entryPoint = entry;
+  wc->label = nullptr;
+  wc->flags = flags;
+  wc->grainSize = grainSize;
+  wc->continuationsLock.store(false);
+  wc->continuations = nullptr;
+  return wc;
+}
+
+static void releaseImpl(WorkContract *workContract) {
+  workContract->wait();
+  if (workContract->flags & INTERNAL_WC_OWNED) {
+    // If the contract is finished and the contract memory is owned by us,
+    // free it
+    delete workContract;
+  }
+}
+
+/** Set on threads that run jobs of a pool; both workers and helpers. */
+static thread_local WorkerPool *tlsWorkerPool = nullptr;
+/** The `idxPhysicalThread` of the current thread in `tlsWorkerPool`. */
+static thread_local u32 tlsIdxWorker = 0;
+
+/**
+ * Runs jobs of the pool on the calling thread until `workContract` has no
+ * pending jobs left.
+ *
+ * Worker threads keep helping until the contract is finished. Other threads
+ * run jobs as physical thread `numWorkerThreads`; only one of them can do that
+ * at a time and they will stop helping when there's nothing left to take.
+ *
+ * `Pool` must have:
+ * - `bool tryRunOneJob(u32 idxThread)`,
+ * - `void beginHelping()` and `void endHelping()`, called on a non-worker
+ *   thread around helping,
+ * - `std::atomic<bool> isHelperActive`,
+ * - `u32 numThreads`.
+ */
+template <typename Pool>
+static void helpUntilFinished(Pool *pool, WorkContract *workContract) {
+  constexpr u32 NumSpinRounds = 64;
+
+  const bool isWorker = tlsWorkerPool == pool;
+  if (!isWorker) {
+    if (pool->isHelperActive.exchange(true, std::memory_order_acquire)) {
+      // Someone else is helping already
+      return;
+    }
+
+    tlsWorkerPool = pool;
+    tlsIdxWorker = pool->numThreads;
+    pool->beginHelping();
+  }
+
+  const u32 idxThread = tlsIdxWorker;
+  u32 numIdleRounds = 0;
+  while (workContract->numPending.load() != 0) {
+    if (pool->tryRunOneJob(idxThread)) {
+      numIdleRounds = 0;
       continue;
     }
 
-    if (stj->shutdown) {
+    // The remaining jobs are running on other threads
+    numIdleRounds++;
+    if (!isWorker && numIdleRounds >= NumSpinRounds) {
       break;
     }
+    std::this_thread::yield();
+  }
 
-    u32 idxNode = 0;
-    for (u32 idxLevel = 1; idxLevel < stj->signalTree.numLevels(); idxLevel++) {
-      // Try the left side
-      u32 idxLeftChild = impl::eytzingerLeft(idxNode);
-      u32 idxRightChild = impl::eytzingerRight(idxNode);
+  if (!isWorker) {
+    pool->endHelping();
+    tlsWorkerPool = nullptr;
+    pool->isHelperActive.store(false, std::memory_order_release);
+  }
+}
 
-      if (stj->signalTree.tryDecrementPriority(idxNode, idxLeftChild,
-                                               idxRightChild, idxNode)) {
-        continue;
-      }
+struct WorkerThreadProcInfo {
+  SignalTreeAndJobs *stj;
+  size_t idxThread;
+  WorkerPool *workerPool;
 
-      if (stj->signalTree.tryDecrementNode(idxLeftChild)) {
-        idxNode = idxLeftChild;
-        continue;
-      }
+  Optional<WorkerPoolWorkerInitializer> init;
+  Optional<size_t> sizScratch;
+};
 
-      if (stj->signalTree.tryDecrementNode(idxRightChild)) {
-        idxNode = idxRightChild;
-        continue;
-      }
+/**
+ * Takes a job from the signal tree and runs it on the calling thread. Returns
+ * false if there was nothing to take.
+ */
+static bool tryRunOneJob(SignalTreeAndJobs *stj,
+                         size_t idxThread,
+                         WorkerPool *workerPool) {
+  // Try to decrement the root node. If we can do that, we'll have a guarantee
+  // that a path exists in the tree to a job
+  bool ok = false;
+  for (u32 numAttempts = 0; numAttempts < 64; numAttempts++) {
+    u32 rootCount = stj->signalTree.nodes[0].counter.load();
+    if (rootCount == 0) {
+      break;
+    }
 
-      NOTREACHED();
+    if (!stj->signalTree.nodes[0].counter.compareExchange(rootCount,
+                                                          rootCount - 1)) {
+      continue;
+    }
+    ok = true;
+    break;
+  }
+
+  if (!ok || stj->shutdown) {
+    return false;
+  }
+
+  u32 idxNode = 0;
+  for (u32 idxLevel = 1; idxLevel < stj->signalTree.numLevels(); idxLevel++) {
+    // Try the left side
+    u32 idxLeftChild = impl::eytzingerLeft(idxNode);
+    u32 idxRightChild = impl::eytzingerRight(idxNode);
+
+    if (stj->signalTree.tryDecrementPriority(idxNode, idxLeftChild,
+                                             idxRightChild, idxNode)) {
+      continue;
+    }
+
+    if (stj->signalTree.tryDecrementNode(idxLeftChild)) {
+      idxNode = idxLeftChild;
+      continue;
     }
 
-    DCHECK(stj->signalTree.isLeafNode(idxNode));
-    u32 idxJob = idxNode - SignalTree<10>::IdxFirstLeafNode;
-    Job &job = stj->jobs[idxJob];
-    DCHECK(job.occupied == true);
+    if (stj->signalTree.tryDecrementNode(idxRightChild)) {
+      idxNode = idxRightChild;
+      continue;
+    }
 
-    void *parameters = job.parameters;
-    Dispatch dispatch = {parameters, job.x, idxThread, workerPool};
+    NOTREACHED();
+  }
 
-    WorkContract *wc = job.workContract;
-    wc->entryPoint(&dispatch);
+  DCHECK(stj->signalTree.isLeafNode(idxNode));
+  u32 idxJob = idxNode - SignalTree<10>::IdxFirstLeafNode;
+  Job &job = stj->jobs[idxJob];
+  DCHECK(job.occupied == true);
 
-    bool wcOwned = wc->flags & INTERNAL_WC_OWNED;
-    bool contractIsFinished = wc->notifyJobFinished();
+  // Hand the upper half of our range over to a sleeping worker, if there is
+  // any
+  auto offload = [stj, &job](const JobRange &upper) {
+    if (stj->signalTree.numThreadsWaiting.load() == 0) {
+      return false;
+    }
 
-    if (contractIsFinished && wcOwned) {
-      delete[] reinterpret_cast<u8 *>(parameters);
+    Optional<u32> idxJob = stj->tryAllocateJobIndex();
+    if (!idxJob) {
+      return false;
     }
 
-    if (job.isPriority) {
-      stj->signalTree.clearPriorityForJob(idxJob);
+    stj->publishJob(*idxJob, job.workContract, job.parameters, upper,
+                    job.isPriority);
+    stj->signalTree.notifyOne();
+    return true;
+  };
+  runJobRange(job.workContract, job.parameters, job.range, idxThread,
+              workerPool, offload);
+
+  if (job.isPriority) {
+    stj->signalTree.clearPriorityForJob(idxJob);
+  }
+  job.occupied.store(false, std::memory_order_release);
+  return true;
+}
+
+static void workerThreadProc(void *arg) {
+  auto [stj, idxThread, workerPool, init, sizScratch] =
+      *reinterpret_cast<WorkerThreadProcInfo *>(arg);
+
+  tlsWorkerPool = workerPool;
+  tlsIdxWorker = u32(idxThread);
+  WorkerScratch scratch;
+  beginWorkerScratch(sizScratch, &scratch);
+  runWorkerInitializer(init, idxThread, workerPool);
+
+  while (!stj->shutdown) {
+    if (!tryRunOneJob(stj, idxThread, workerPool)) {
+      // The other workers may have taken the counts that `shutdown` put into
+      // the root; nothing would wake us up again
+      if (stj->shutdown) {
+        break;
+      }
+
+      // Nothing to do; go to sleep
+      stj->signalTree.waitForRootToChange();
     }
-    job.occupied.store(false, std::memory_order_release);
   }
+
+  endWorkerScratch(sizScratch, &scratch);
+  tlsWorkerPool = nullptr;
 }
 
 struct WorkerPoolImpl final : WorkerPool {
   const MutSlice<Thread> threads;
   u32 numThreads;
   SignalTreeAndJobs signalTreeAndJobs;
-  u32 idxLastJobSlotUsed;
+  std::atomic<bool> isHelperActive;
 
   WorkerPoolImpl(MutSlice<Thread> threads, u32 numThreads)
       : threads(threads),
         numThreads(numThreads),
         signalTreeAndJobs(),
-        idxLastJobSlotUsed(0) {
+        isHelperActive(false) {
     DCHECK(numThreads == threads.length);
   }
 
   WorkContract *createWorkContract(Arena *arena,
                                    KernelEntryPoint entry,
-                                   u32 flags = 0) override {
-    static constexpr u32 INTERNAL_MASK = INTERNAL_WC_OWNED;
-    DCHECK((flags & INTERNAL_MASK) == 0);
-    flags &= ~INTERNAL_MASK;
-
-    WorkContract *wc = alloc<WorkContract>(arena);
-    wc->numPending.store(0);
-    wc->entryPoint = entry;
-    wc->label = nullptr;
-    wc->flags = flags;
-    return wc;
+                                   u32 flags = 0,
+                                   u32 grainSize = 0) override {
+    return createWorkContractImpl(arena, entry, flags, grainSize);
   }
 
   void dispatch(WorkContract *workContract,
@@ -197,72 +656,65 @@ struct WorkerPoolImpl final : WorkerPool {
 
     const bool isPriority = (workContract->flags & WC_HIGH_PRIORITY) != 0;
 
-    for (u32 z = 0; z < numThreadsZ; z++) {
-      for (u32 y = 0; y < numThreadsY; y++) {
-        for (u32 x = 0; x < numThreadsX; x++) {
-          ThreadIndex i = {x, y, z};
-          dispatchJob(workContract, parameters, i, isPriority);
-        }
-      }
-    }
+    // Publish one range per worker; idle workers will split them further
+    forEachJobRange(workContract, numThreadsX, numThreadsY, numThreadsZ,
+                    numThreads, [&](const JobRange &range) {
+                      dispatchJob(workContract, parameters, range, isPriority);
+                    });
 
     signalTreeAndJobs.signalTree.notifyAll();
   }
 
+  void dispatchAfter(Arena *arena,
+                     WorkContract *workContract,
+                     Slice<WorkContract *> dependencies,
+                     void *parameters,
+                     u32 numThreadsX,
+                     u32 numThreadsY,
+                     u32 numThreadsZ) override {
+    dispatchAfterImpl(this, arena, workContract, dependencies, parameters,
+                      numThreadsX, numThreadsY, numThreadsZ);
+  }
+
   void release(WorkContract *workContract) override {
-    workContract->wait();
-    if (workContract->flags & INTERNAL_WC_OWNED) {
-      // If the contract is finished and the contract memory is owned by us,
-      // free it
-      delete workContract;
-    }
+    helpUntilFinished(this, workContract);
+    releaseImpl(workContract);
+  }
+
+  u32 numWorkerThreads() override { return numThreads; }
+
+  bool tryRunOneJob(u32 idxThread) {
+    return ::tryRunOneJob(&signalTreeAndJobs, idxThread, this);
+  }
+
+  // Count the helper as a sleeping worker so that workers hand over parts of
+  // their ranges to it
+  void beginHelping() {
+    signalTreeAndJobs.signalTree.numThreadsWaiting.fetchAdd(1);
+  }
+  void endHelping() {
+    signalTreeAndJobs.signalTree.numThreadsWaiting.fetchSub(1);
   }
 
   /** Finds a free job slot, marks it as occupied and returns its index. */
   u32 allocateJobIndex() {
-    constexpr u32 Mask = SignalTree<10>::NodeIndexMask;
-
-    // Start from one past the previously used slot
-    u32 idxJob = (idxLastJobSlotUsed + 1) & Mask;
-    const u32 idxFirstJob = idxJob;
     while (true) {
-      if (signalTreeAndJobs.jobs[idxJob].occupied) {
-        idxJob = (idxJob + 1) & Mask;
-        // Slots are probably all full; wake up every thread
-        if (idxJob == idxFirstJob) {
-          signalTreeAndJobs.signalTree.notifyAll();
-        }
-        continue;
+      if (Optional<u32> idxJob = signalTreeAndJobs.tryAllocateJobIndex()) {
+        return *idxJob;
       }
 
-      // Try mark as occupied
-      bool expected = false;
-      Job &job = signalTreeAndJobs.jobs[idxJob];
-      if (!job.occupied.compare_exchange_strong(expected, true,
-                                                std::memory_order_acquire)) {
-        continue;
-      }
-
-      return idxJob;
+      // Slots are probably all full; wake up every thread
+      signalTreeAndJobs.signalTree.notifyAll();
     }
   }
 
   void dispatchJob(WorkContract *workContract,
                    void *parameters,
-                   ThreadIndex x,
+                   const JobRange &range,
                    bool isPriority) {
     u32 idxJob = allocateJobIndex();
-
-    Job &job = signalTreeAndJobs.jobs[idxJob];
-    job.workContract = workContract;
-    job.isPriority = isPriority;
-    job.x = x;
-    job.parameters = parameters;
-    workContract->notifyJobDispatched();
-
-    // Set the signal for this job
-    signalTreeAndJobs.signalTree.setSignalForJob(idxJob, isPriority);
-    idxLastJobSlotUsed = idxJob;
+    signalTreeAndJobs.publishJob(idxJob, workContract, parameters, range,
+                                 isPriority);
   }
 
   void shutdown() override {
@@ -278,11 +730,335 @@ struct WorkerPoolImpl final : WorkerPool {
   }
 };
 
+struct StealableJob {
+  WorkContract *workContract;
+  void *parameters;
+  JobRange range;
+};
+
+struct WorkStealingWorkerPoolImpl;
+
+struct StealingWorker {
+  WorkStealingDeque<StealableJob> deque;
+  WorkStealingWorkerPoolImpl *pool;
+  u32 idxThread;
+  u64 rngState;
+  Optional<WorkerPoolWorkerInitializer> init;
+  Optional<size_t> sizScratch;
+};
+
+struct WorkStealingWorkerPoolImpl final : WorkerPool {
+  static constexpr u32 DequeCapacity = 256;
+  static constexpr u32 InjectionQueueCapacity = 512;
+  static constexpr u32 NumSpinRounds = 64;
+
+  const MutSlice<Thread> threads;
+  // One for every worker thread plus one for the thread helping in `release`
+  const MutSlice<StealingWorker> workers;
+  u32 numThreads;
+  std::atomic<bool> isHelperActive;
+
+  // Jobs dispatched from outside of the pool
+  MpmcQueue<StealableJob> injectionQueue;
+  // High priority jobs; these are taken before anything else
+  MpmcQueue<StealableJob> priorityQueue;
+
+  std::atomic<bool> isShuttingDown;
+  // Incremented every time sleeping workers need to be woken up
+  alignas(64) impl::AtomicU32 wakeEpoch;
+  alignas(64) impl::AtomicU32 numSleeping;
+
+  WorkStealingWorkerPoolImpl(Arena *arena,
+                             MutSlice<Thread> threads,
+                             MutSlice<StealingWorker> workers)
+      : threads(threads),
+        workers(workers),
+        numThreads(u32(threads.length)),
+        isHelperActive(false),
+        isShuttingDown(false) {
+    DCHECK(threads.length + 1 == workers.length);
+    injectionQueue.init(arena, InjectionQueueCapacity);
+    priorityQueue.init(arena, InjectionQueueCapacity);
+    wakeEpoch.store(0);
+    numSleeping.store(0);
+  }
+
+  WorkContract *createWorkContract(Arena *arena,
+                                   KernelEntryPoint entry,
+                                   u32 flags = 0,
+                                   u32 grainSize = 0) override {
+    return createWorkContractImpl(arena, entry, flags, grainSize);
+  }
+
+  void dispatch(WorkContract *workContract,
+                void *parameters,
+                u32 numThreadsX,
+                u32 numThreadsY,
+                u32 numThreadsZ) override {
+    DCHECK(workContract);
+
+    const bool isPriority = (workContract->flags & WC_HIGH_PRIORITY) != 0;
+    StealingWorker *self = currentWorker();
+
+    // Inside of a worker the whole grid goes onto the local deque as a single
+    // range; thieves will split it. Otherwise publish one range per worker.
+    u32 maxNumChunks = self != nullptr ? 1 : u32(workers.length);
+    u32 numJobs = 0;
+    forEachJobRange(workContract, numThreadsX, numThreadsY, numThreadsZ,
+                    maxNumChunks, [&](const JobRange &range) {
+                      StealableJob job = {workContract, parameters, range};
+                      workContract->notifyJobDispatched();
+                      pushJob(self, job, isPriority);
+                      numJobs++;
+                    });
+
+    wakeWorkers(numJobs > 1);
+  }
+
+  void dispatchAfter(Arena *arena,
+                     WorkContract *workContract,
+                     Slice<WorkContract *> dependencies,
+                     void *parameters,
+                     u32 numThreadsX,
+                     u32 numThreadsY,
+                     u32 numThreadsZ) override {
+    dispatchAfterImpl(this, arena, workContract, dependencies, parameters,
+                      numThreadsX, numThreadsY, numThreadsZ);
+  }
+
+  void release(WorkContract *workContract) override {
+    helpUntilFinished(this, workContract);
+    releaseImpl(workContract);
+  }
+
+  u32 numWorkerThreads() override { return numThreads; }
+
+  bool tryRunOneJob(u32 idxThread) { return runOneJob(&workers[idxThread]); }
+
+  void beginHelping() {}
+  void endHelping() {
+    // Don't leave anything behind in the deque of the helper; nobody would pop
+    // it
+    StealingWorker *self = &workers[numThreads];
+    while (self->deque.sizeApprox() != 0) {
+      runOneJob(self);
+    }
+  }
+
+  void shutdown() override {
+    isShuttingDown.store(true, std::memory_order_seq_cst);
+    // Wake up all threads
+    wakeEpoch.fetchAdd(1);
+    wakeEpoch.notifyAll();
+
+    for (auto [t, _] : threads) {
+      t.join();
+    }
+  }
+
+  /** Returns the worker of this pool running on the current thread. */
+  StealingWorker *currentWorker() {
+    if (tlsWorkerPool == this) {
+      return &workers[tlsIdxWorker];
+    }
+    return nullptr;
+  }
+
+  void pushJob(StealingWorker *self, const StealableJob &job, bool isPriority) {
+    MpmcQueue<StealableJob> &queue =
+        isPriority ? priorityQueue : injectionQueue;
+    if (!isPriority && self != nullptr && self->deque.push(job)) {
+      return;
+    }
+
+    while (!queue.enqueue(job)) {
+      // Every queue is full; make some room
+      if (self != nullptr) {
+        runOneJob(self);
+      } else {
+        wakeWorkers(true);
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  /** Wakes up sleeping workers, if there are any. */
+  void wakeWorkers(bool all) {
+    // Pairs with the fence in `workerThreadProc`: either we see that a worker
+    // is going to sleep, or the worker sees the job we've just published
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (numSleeping.load() == 0) {
+      return;
+    }
+
+    wakeEpoch.fetchAdd(1);
+    if (all) {
+      wakeEpoch.notifyAll();
+    } else {
+      wakeEpoch.notifyOne();
+    }
+  }
+
+  Optional<StealableJob> findJob(StealingWorker *self) {
+    if (Optional<StealableJob> job = priorityQueue.dequeue()) {
+      return job;
+    }
+
+    if (Optional<StealableJob> job = self->deque.pop()) {
+      return job;
+    }
+
+    if (Optional<StealableJob> job = injectionQueue.dequeue()) {
+      return job;
+    }
+
+    // Start stealing from a random victim
+    const u32 numWorkers = u32(workers.length);
+    u32 idxStart = u32(nextRandom(self) % numWorkers);
+    for (u32 i = 0; i < numWorkers; i++) {
+      u32 idxVictim = (idxStart + i) % numWorkers;
+      if (idxVictim == self->idxThread) {
+        continue;
+      }
+
+      StealingWorker &victim = workers[idxVictim];
+      if (Optional<StealableJob> job = victim.deque.steal()) {
+        if (victim.deque.sizeApprox() != 0) {
+          // There is more work to steal; get someone else to help
+          wakeWorkers(false);
+        }
+        return job;
+      }
+    }
+
+    return {};
+  }
+
+  bool runOneJob(StealingWorker *self) {
+    Optional<StealableJob> job = findJob(self);
+    if (!job) {
+      return false;
+    }
+
+    // Keep the upper half of our range stealable while the local deque is
+    // empty
+    auto offload = [this, self, &job](const JobRange &upper) {
+      if (self->deque.sizeApprox() != 0) {
+        return false;
+      }
+
+      job->workContract->notifyJobDispatched();
+      if (!self->deque.push({job->workContract, job->parameters, upper})) {
+        // Can't reach zero, we're still holding our own range
+        job->workContract->notifyJobFinished();
+        return false;
+      }
+
+      wakeWorkers(false);
+      return true;
+    };
+    runJobRange(job->workContract, job->parameters, job->range,
+                self->idxThread, this, offload);
+    return true;
+  }
+
+  static u64 nextRandom(StealingWorker *self) {
+    // xorshift64
+    u64 x = self->rngState;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    self->rngState = x;
+    return x;
+  }
+
+  static void workerThreadProc(void *arg) {
+    StealingWorker *self = reinterpret_cast<StealingWorker *>(arg);
+    WorkStealingWorkerPoolImpl *pool = self->pool;
+    tlsWorkerPool = pool;
+    tlsIdxWorker = self->idxThread;
+
+    WorkerScratch scratch;
+    beginWorkerScratch(self->sizScratch, &scratch);
+    runWorkerInitializer(self->init, self->idxThread, pool);
+
+    u32 numIdleRounds = 0;
+    while (!pool->isShuttingDown.load(std::memory_order_acquire)) {
+      if (pool->runOneJob(self)) {
+        numIdleRounds = 0;
+        continue;
+      }
+
+      if (numIdleRounds < NumSpinRounds) {
+        numIdleRounds++;
+        std::this_thread::yield();
+        continue;
+      }
+
+      // Announce that we're going to sleep, then look for work one last time
+      u32 epoch = pool->wakeEpoch.load();
+      pool->numSleeping.fetchAdd(1);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      if (!pool->runOneJob(self) &&
+          !pool->isShuttingDown.load(std::memory_order_acquire)) {
+        pool->wakeEpoch.wait(epoch);
+      }
+
+      pool->numSleeping.fetchSub(1);
+      numIdleRounds = 0;
+    }
+
+    endWorkerScratch(self->sizScratch, &scratch);
+    tlsWorkerPool = nullptr;
+  }
+};
+
+static WorkerPool *createWorkStealingWorkerPool(
+    Arena *arena,
+    u32 numThreads,
+    const WorkerPoolCreateInfo &createInfo) {
+  MutSlice<Thread> threads;
+  alloc(arena, numThreads, threads);
+  MutSlice<StealingWorker> workers;
+  alloc(arena, numThreads + 1, workers);
+
+  WorkStealingWorkerPoolImpl *wp = alloc<WorkStealingWorkerPoolImpl>(arena);
+  new (wp) WorkStealingWorkerPoolImpl(arena, threads, workers);
+
+  for (auto [worker, i] : workers) {
+    worker.deque.init(arena, WorkStealingWorkerPoolImpl::DequeCapacity);
+    worker.pool = wp;
+    worker.idxThread = u32(i);
+    worker.rngState = 0x9E3779B97F4A7C15ull * (i + 1);
+    worker.init = createInfo.workerInitializer;
+    worker.sizScratch = createInfo.workerScratchSize;
+  }
+
+  for (auto [_, i] : threads) {
+    Result<Thread, ThreadError> res = Thread::create({
+        .nextInChain = nullptr,
+        .entryPoint = WorkStealingWorkerPoolImpl::workerThreadProc,
+        .param = &workers[i],
+    });
+    CHECK(res.isOk());
+    threads[i] = res.unwrap();
+  }
+
+  return wp;
+}
+
 WorkerPool *createWorkerPool(Arena *arena,
                              const WorkerPoolCreateInfo &createInfo) {
   u32 numThreads =
       createInfo.numThreads.valueOrElse(Thread::hardwareConcurrency);
 
+  WorkerPoolScheduler scheduler =
+      createInfo.scheduler.valueOr(WorkerPoolScheduler::SignalTree);
+  if (scheduler == WorkerPoolScheduler::WorkStealing) {
+    return createWorkStealingWorkerPool(arena, numThreads, createInfo);
+  }
+
   MutSlice<Thread> threads;
   alloc(arena, numThreads, threads);
   MutSlice<WorkerThreadProcInfo> threadProcInfo;
@@ -297,6 +1073,7 @@ WorkerPool *createWorkerPool(Arena *arena,
     threadProcInfo[i].idxThread = i;
     threadProcInfo[i].workerPool = wp;
     threadProcInfo[i].init = createInfo.workerInitializer;
+    threadProcInfo[i].sizScratch = createInfo.workerScratchSize;
   }
 
   for (auto [_, i] : threads) {
@@ -316,6 +1093,8 @@ WorkerPool *createWorkerPool(Arena *arena, u32 numThreads) {
   WorkerPoolCreateInfo createInfo = {
       .numThreads = numThreads,
       .workerInitializer = {},
+      .scheduler = {},
+      .workerScratchSize = {},
   };
   return createWorkerPool(arena, createInfo);
 }
@@ -324,6 +1103,8 @@ WorkerPool *createWorkerPool(Arena *arena) {
   WorkerPoolCreateInfo createInfo = {
       .numThreads = {},
       .workerInitializer = {},
+      .scheduler = {},
+      .workerScratchSize = {},
   };
   return createWorkerPool(arena, createInfo);
 }
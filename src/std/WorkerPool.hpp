@@ -10,6 +10,7 @@
 
 #include "std/Arena.h"
 #include "std/Optional.hpp"
+#include "std/Slice.hpp"
 #include "std/Types.h"
 
 struct WorkerPool;
@@ -23,6 +24,7 @@ struct Dispatch {
   void *parameters;
   ThreadIndex threadIndex;
 
+  // Index of the thread running the job; in `[0, numWorkerThreads()]`
   size_t idxPhysicalThread;
   WorkerPool *workerPool;
 
@@ -49,15 +51,68 @@ enum WorkContractFlags : u32 {
 struct WorkerPool {
   virtual void shutdown() = 0;
 
+  /**
+   * \brief Creates a work contract.
+   *
+   * \param grainSize Dispatches are scheduled as ranges of thread indices;
+   * ranges are split further as long as they contain more than this many
+   * indices. Pass 0 to let the pool pick one based on the size of the
+   * dispatch.
+   */
   virtual WorkContract *createWorkContract(Arena *arena,
                                            KernelEntryPoint entry,
-                                           u32 flags = 0) = 0;
+                                           u32 flags = 0,
+                                           u32 grainSize = 0) = 0;
+
+  /**
+   * \brief Runs the kernel of the work contract once for every thread index
+   * in the `numThreadsX * numThreadsY * numThreadsZ` grid.
+   *
+   * The grid is scheduled as a handful of index ranges that are split lazily
+   * among the workers, so the cost of scheduling doesn't depend on the size of
+   * the grid.
+   */
   virtual void dispatch(WorkContract *workContract,
                         void *parameters,
                         u32 numThreadsX = 1,
                         u32 numThreadsY = 1,
                         u32 numThreadsZ = 1) = 0;
+
+  /**
+   * \brief Like `dispatch`, but the jobs are only scheduled once every
+   * contract in `dependencies` has finished.
+   *
+   * The dispatch happens on the thread that finishes the last job of the
+   * dependencies. Until then `workContract` counts as pending; `release` will
+   * wait for it and it can be the dependency of other deferred dispatches.
+   * Dependencies that have no pending jobs count as finished.
+   *
+   * \param arena Bookkeeping is allocated from this arena; it must stay alive
+   * until `workContract` is released.
+   */
+  virtual void dispatchAfter(Arena *arena,
+                             WorkContract *workContract,
+                             Slice<WorkContract *> dependencies,
+                             void *parameters,
+                             u32 numThreadsX = 1,
+                             u32 numThreadsY = 1,
+                             u32 numThreadsZ = 1) = 0;
+
+  /**
+   * \brief Waits until every job of the work contract has finished.
+   *
+   * While waiting, the calling thread runs pending jobs of the pool, so
+   * releasing a contract from inside a kernel can't deadlock the pool. A
+   * thread that is not a worker of this pool runs them as physical thread
+   * `numWorkerThreads()`.
+   */
   virtual void release(WorkContract *workContract) = 0;
+
+  /**
+   * \brief Number of worker threads in the pool. `Dispatch::idxPhysicalThread`
+   * is at most this value.
+   */
+  virtual u32 numWorkerThreads() = 0;
 };
 
 struct WorkerPoolWorkerInitializer {
@@ -65,9 +120,35 @@ struct WorkerPoolWorkerInitializer {
   void *parameters;
 };
 
+enum class WorkerPoolScheduler : u8 {
+  /**
+   * Jobs are published in a single, shared signal tree. Every worker competes
+   * for the root node of the tree.
+   */
+  SignalTree,
+  /**
+   * Every worker owns a work-stealing deque. Jobs dispatched from inside a
+   * kernel are pushed onto the deque of the calling worker; jobs dispatched
+   * from other threads go into a shared injection queue. Idle workers steal
+   * from randomly selected victims.
+   *
+   * Scales better than `SignalTree` when jobs are fine-grained.
+   */
+  WorkStealing,
+};
+
 struct WorkerPoolCreateInfo {
   Optional<u32> numThreads;
   Optional<WorkerPoolWorkerInitializer> workerInitializer;
+  /** Defaults to `WorkerPoolScheduler::SignalTree`. */
+  Optional<WorkerPoolScheduler> scheduler;
+  /**
+   * If set, every worker thread creates a pair of growable arenas, each
+   * reserving this many bytes of address space, and installs them as its
+   * scratch allocators, so kernels can call `getScratch`. The worker
+   * initializer runs afterwards and may replace them.
+   */
+  Optional<size_t> workerScratchSize;
 };
 
 WorkerPool *createWorkerPool(Arena *arena);
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2026 Daniel Meszaros
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#pragma once
+
+#include <std/Arena.h>
+#include <std/Slice.hpp>
+#include <std/WorkerPool.hpp>
+#include <std/os/Thread.hpp>
+
+/** Fills the slice with pseudo-random values. */
+template <typename T>
+void benchFillRandom(MutSlice<T> s, u64 seed) {
+  u64 x = seed;
+  for (auto [elem, i] : s) {
+    // xorshift64
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    elem = T(x);
+  }
+}
+
+/**
+ * Calls `fn(pool, numThreads)` with pools of 1, 2, 4, ... worker threads, up
+ * to the number of hardware threads.
+ */
+template <typename Fn>
+void benchForEachPoolSize(const Fn &fn) {
+  u32 maxThreads = Thread::hardwareConcurrency();
+  for (u32 numThreads = 1;; numThreads *= 2) {
+    if (numThreads > maxThreads) {
+      numThreads = maxThreads;
+    }
+
+    Arena::Scope temp = getScratch(nullptr, 0);
+    WorkerPoolCreateInfo createInfo = {
+        .numThreads = numThreads,
+        .workerInitializer = {},
+        .scheduler = WorkerPoolScheduler::WorkStealing,
+        .workerScratchSize = size_t(64) << 20,
+    };
+    WorkerPool *wp = createWorkerPool(temp, createInfo);
+    fn(wp, numThreads);
+    wp->shutdown();
+
+    if (numThreads == maxThreads) {
+      break;
+    }
+  }
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2026 Daniel Meszaros
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <std/Benchmark.hpp>
+#include <std/bench/Common.hpp>
+#include <std/ConcurrentSwissMap.hpp>
+#include <std/Parallel.hpp>
+#include <std/SwissMap.hpp>
+#include <std/WorkerPool.hpp>
+
+#include <stdio.h>
+
+/**
+ * Measures deduplicating `n` keys, a quarter of them distinct, on a pool of
+ * `numThreads` threads: once by inserting into a shared `ConcurrentSwissMap`
+ * and once by building a `SwissSet` per thread and merging the distinct keys
+ * into a `SwissMap` on the calling thread. Then measures looking up every key
+ * in the results in parallel.
+ */
+static void benchDedupe(WorkerPool *wp, u32 numThreads, Slice<u64> keys) {
+  const size_t n = keys.length;
+  const size_t chunkSize = (n + numThreads - 1) / numThreads;
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  char name[64];
+  snprintf(name, sizeof(name), "ConcurrentSwissMap/insert/%zu/threads=%u", n,
+           numThreads);
+  snBenchMeasure(name, n, [&]() {
+    Arena::Scope tableArena = getScratch(nullptr, 0);
+    ConcurrentSwissMap<u64, u64> map(tableArena, n / 4);
+    impl::parallelChunks(wp, n, chunkSize, [&](size_t, size_t beg, size_t end) {
+      for (size_t i = beg; i < end; i++) {
+        map.insert(keys[i], i);
+      }
+    });
+    snBenchDoNotOptimize(map);
+  });
+
+  // Distinct keys found by each thread
+  MutSlice<u64> distinct;
+  MutSlice<size_t> numDistinct;
+  alloc(temp, n, distinct);
+  alloc(temp, numThreads, numDistinct);
+
+  snprintf(name, sizeof(name), "perThreadMerge/insert/%zu/threads=%u", n,
+           numThreads);
+  snBenchMeasure(name, n, [&]() {
+    auto dedupeChunk = [&](size_t idxChunk, size_t beg, size_t end) {
+      Arena::Scope localArena = getScratch(nullptr, 0);
+      SwissSet<u64> local(localArena);
+      size_t count = 0;
+      for (size_t i = beg; i < end; i++) {
+        if (local.put(keys[i])) {
+          distinct[beg + count++] = keys[i];
+        }
+      }
+      numDistinct[idxChunk] = count;
+    };
+    impl::parallelChunks(wp, n, chunkSize, dedupeChunk);
+
+    Arena::Scope tableArena = getScratch(nullptr, 0);
+    SwissMap<u64, u64> map(tableArena);
+    map.reserve(n / 4);
+    for (size_t idxChunk = 0; idxChunk < numThreads; idxChunk++) {
+      size_t beg = idxChunk * chunkSize;
+      for (size_t i = beg; i < beg + numDistinct[idxChunk]; i++) {
+        if (map.get(distinct[i]) == nullptr) {
+          map.put(distinct[i], i);
+        }
+      }
+    }
+    snBenchDoNotOptimize(map);
+  });
+
+  ConcurrentSwissMap<u64, u64> concurrentMap(temp, n / 4);
+  SwissMap<u64, u64> map(temp);
+  map.reserve(n / 4);
+  for (size_t i = 0; i < n; i++) {
+    concurrentMap.insert(keys[i], i);
+    if (map.get(keys[i]) == nullptr) {
+      map.put(keys[i], i);
+    }
+  }
+
+  snprintf(name, sizeof(name), "ConcurrentSwissMap/get/%zu/threads=%u", n,
+           numThreads);
+  snBenchMeasure(name, n, [&]() {
+    impl::parallelChunks(wp, n, chunkSize, [&](size_t, size_t beg, size_t end) {
+      u64 sum = 0;
+      for (size_t i = beg; i < end; i++) {
+        sum += *concurrentMap.get(keys[i]);
+      }
+      snBenchDoNotOptimize(sum);
+    });
+  });
+
+  // Lookups don't modify the map, so the merged map can be shared as well
+  snprintf(name, sizeof(name), "perThreadMerge/get/%zu/threads=%u", n,
+           numThreads);
+  snBenchMeasure(name, n, [&]() {
+    impl::parallelChunks(wp, n, chunkSize, [&](size_t, size_t beg, size_t end) {
+      u64 sum = 0;
+      for (size_t i = beg; i < end; i++) {
+        sum += *map.get(keys[i]);
+      }
+      snBenchDoNotOptimize(sum);
+    });
+  });
+}
+
+SN_BENCH(ConcurrentSwissMap, dedupe) {
+  for (size_t n : {size_t(1) << 16, size_t(1) << 22}) {
+    Arena::Scope temp = getScratch(nullptr, 0);
+    MutSlice<u64> keys;
+    alloc(temp, n, keys);
+    benchFillRandom(keys, n);
+    for (size_t i = 0; i < n; i++) {
+      keys[i] %= n / 4;
+    }
+
+    benchForEachPoolSize([&](WorkerPool *wp, u32 numThreads) {
+      benchDedupe(wp, numThreads, keys);
+    });
+  }
+}
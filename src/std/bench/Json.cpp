@@ -0,0 +1,579 @@
+/*
+ * Copyright (c) 2026 Daniel Meszaros
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <std/Benchmark.hpp>
+#include <std/bench/Common.hpp>
+#include <std/SliceUtils.hpp>
+#include <std/Vector.hpp>
+#include <std/WorkerPool.hpp>
+#include <std/json/Cursor.hpp>
+#include <std/json/Index.hpp>
+#include <std/json/Ndjson.hpp>
+#include <std/json/Number.hpp>
+#include <std/json/Parser.hpp>
+#include <std/json/Tape.hpp>
+#include <std/json/Utils.hpp>
+#include <std/json/Writer.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static void appendString(Arena *arena, Vector<char> *dst, const char *s) {
+  size_t length = strlen(s);
+  memcpy(append(arena, dst, length), s, length);
+}
+
+/**
+ * A GeoJSON feature collection of polygons; nearly every byte belongs to a
+ * coordinate with 7 to 9 fractional digits.
+ */
+static Slice<char> makeGeoJson(Arena *arena, size_t numPoints) {
+  Vector<char> out = {};
+  MutSlice<u32> random;
+  alloc(arena, numPoints * 2, random);
+  benchFillRandom(random, 5);
+
+  char buf[64];
+  appendString(arena, &out,
+               "{\"type\": \"FeatureCollection\", \"features\": [");
+  const size_t POINTS_PER_POLYGON = 64;
+  for (size_t i = 0; i < numPoints; i++) {
+    if (i % POINTS_PER_POLYGON == 0) {
+      if (i != 0) {
+        appendString(arena, &out, "]]}},");
+      }
+      appendString(arena, &out,
+                   "{\"type\": \"Feature\", \"geometry\": {\"type\": "
+                   "\"Polygon\", \"coordinates\": [[");
+    } else {
+      appendString(arena, &out, ",");
+    }
+
+    f64 lon = -180.0 + f64(random[2 * i]) / f64(UINT32_MAX) * 360.0;
+    f64 lat = -90.0 + f64(random[2 * i + 1]) / f64(UINT32_MAX) * 180.0;
+    snprintf(buf, sizeof(buf), "[%.9f,%.7f]", lon, lat);
+    appendString(arena, &out, buf);
+  }
+  appendString(arena, &out, "]]}}]}");
+
+  return {out.data, out.length};
+}
+
+/** \brief An array of random integers, some of them beyond 2^53 */
+static Slice<char> makeIntegerArray(Arena *arena, size_t count) {
+  Vector<char> out = {};
+  MutSlice<u64> random;
+  alloc(arena, count, random);
+  benchFillRandom(random, 6);
+
+  char buf[32];
+  appendString(arena, &out, "[");
+  for (size_t i = 0; i < count; i++) {
+    // Mix small ids and 64-bit ones
+    u64 value = i % 4 == 0 ? random[i] : random[i] % 100000;
+    snprintf(buf, sizeof(buf), i == 0 ? "%llu" : ",%llu",
+             (unsigned long long)value);
+    appendString(arena, &out, buf);
+  }
+  appendString(arena, &out, "]");
+
+  return {out.data, out.length};
+}
+
+/** \brief An array of objects with short, escape-free string fields */
+static Slice<char> makeStringRecords(Arena *arena, size_t count) {
+  Vector<char> out = {};
+  MutSlice<u32> random;
+  alloc(arena, count, random);
+  benchFillRandom(random, 8);
+
+  char buf[192];
+  appendString(arena, &out, "[");
+  for (size_t i = 0; i < count; i++) {
+    snprintf(buf, sizeof(buf),
+             "%s{\"id\": \"user-%08x\", \"name\": \"Some Name %u\", "
+             "\"email\": \"someone.%x@example.com\", \"status\": \"active\"}",
+             i == 0 ? "" : ",", random[i], random[i] % 1000, random[i]);
+    appendString(arena, &out, buf);
+  }
+  appendString(arena, &out, "]");
+
+  return {out.data, out.length};
+}
+
+/** \brief An array of strings full of escape sequences */
+static Slice<char> makeEscapedStrings(Arena *arena, size_t count) {
+  Vector<char> out = {};
+
+  char buf[128];
+  appendString(arena, &out, "[");
+  for (size_t i = 0; i < count; i++) {
+    snprintf(buf, sizeof(buf),
+             "%s\"line %zu\\n\\tsaid \\\"caf\\u00e9\\\" \\\\ "
+             "\\ud83d\\ude00\"",
+             i == 0 ? "" : ",", i);
+    appendString(arena, &out, buf);
+  }
+  appendString(arena, &out, "]");
+
+  return {out.data, out.length};
+}
+
+/** \brief An array of `count` objects and arrays nested `depth` deep */
+static Slice<char> makeNested(Arena *arena, size_t count, size_t depth) {
+  Vector<char> out = {};
+
+  appendString(arena, &out, "[");
+  for (size_t i = 0; i < count; i++) {
+    appendString(arena, &out, i == 0 ? "" : ",");
+    for (size_t j = 0; j < depth; j++) {
+      appendString(arena, &out, j % 2 == 0 ? "{\"a\":[" : "{\"b\":1,\"c\":");
+    }
+    appendString(arena, &out, "null");
+    for (size_t j = depth; j > 0; j--) {
+      appendString(arena, &out, (j - 1) % 2 == 0 ? "]}" : "}");
+    }
+  }
+  appendString(arena, &out, "]");
+
+  return {out.data, out.length};
+}
+
+/** \brief An array of `count` objects with `numKeys` keys each */
+static Slice<char> makeWideObjects(Arena *arena, size_t count, u32 numKeys) {
+  Vector<char> out = {};
+
+  char buf[64];
+  appendString(arena, &out, "[");
+  for (size_t i = 0; i < count; i++) {
+    appendString(arena, &out, i == 0 ? "{" : ",{");
+    for (u32 j = 0; j < numKeys; j++) {
+      snprintf(buf, sizeof(buf), "%s\"field_%u\":%u", j ? "," : "", j, j);
+      appendString(arena, &out, buf);
+    }
+    appendString(arena, &out, "}");
+  }
+  appendString(arena, &out, "]");
+
+  return {out.data, out.length};
+}
+
+static void benchParse(const char *name, Slice<char> json, u32 flags) {
+  snBenchMeasure(name, json.length, [&]() {
+    Arena::Scope arena = getScratch(nullptr, 0);
+    JsonValue value;
+    Slice<char> src = json;
+    CHECK(tryParseValue(arena, src, value, flags));
+    snBenchDoNotOptimize(value);
+  });
+}
+
+SN_BENCH(Json, numbers) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  // Throughput is reported in MB/s
+  Slice<char> geoJson = makeGeoJson(temp, 1 << 20);
+  benchParse("parse/geoJson", geoJson, 0);
+
+  Slice<char> integers = makeIntegerArray(temp, 1 << 20);
+  benchParse("parse/integers", integers, 0);
+  benchParse("parse/integers/JSON_PARSE_INTEGERS", integers,
+             JSON_PARSE_INTEGERS);
+
+  // Number conversion alone, against the C library
+  const size_t N = 1 << 16;
+  char(*literals)[32] = alloc<char[32]>(temp, N);
+  MutSlice<u64> random;
+  alloc(temp, N, random);
+  benchFillRandom(random, 7);
+  for (size_t i = 0; i < N; i++) {
+    snprintf(literals[i], 32, "%.17g", f64(random[i] >> 11) * 0x1p-40);
+  }
+
+  snBenchMeasure("convert/tryParseJsonNumber", N, [&]() {
+    f64 sum = 0;
+    for (size_t i = 0; i < N; i++) {
+      JsonValue value;
+      size_t length;
+      tryParseJsonNumber(fromCStr(literals[i]), 0, value, length);
+      sum += value.number;
+    }
+    snBenchDoNotOptimize(sum);
+  });
+
+  snBenchMeasure("convert/strtod", N, [&]() {
+    f64 sum = 0;
+    for (size_t i = 0; i < N; i++) {
+      sum += strtod(literals[i], nullptr);
+    }
+    snBenchDoNotOptimize(sum);
+  });
+}
+
+SN_BENCH(Json, strings) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  Slice<char> records = makeStringRecords(temp, 1 << 17);
+  benchParse("parse/records", records, 0);
+  benchParse("parse/records/JSON_PARSE_COPY_STRINGS", records,
+             JSON_PARSE_COPY_STRINGS);
+}
+
+SN_BENCH(Json, ndjson) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  // One record per line
+  Slice<char> records = makeStringRecords(temp, 1 << 17);
+  MutSlice<char> ndjson;
+  alloc(temp, records.length, ndjson);
+  ndjson.copy(records);
+  for (size_t i = 1; i + 1 < ndjson.length; i++) {
+    if (ndjson[i] == ',' && ndjson[i - 1] == '}') {
+      ndjson[i] = '\n';
+    }
+  }
+  ndjson[0] = ' ';
+  ndjson[ndjson.length - 1] = '\n';
+
+  // An output arena for every physical thread of the largest pool
+  const u32 maxThreads = Thread::hardwareConcurrency() + 1;
+  Arena *threadArenas = alloc<Arena>(temp, maxThreads);
+  Arena **pThreadArenas = alloc<Arena *>(temp, maxThreads);
+  for (u32 i = 0; i < maxThreads; i++) {
+    threadArenas[i] = createGrowableArena(size_t(1) << 30);
+    pThreadArenas[i] = &threadArenas[i];
+  }
+  auto reset = [&]() {
+    for (u32 i = 0; i < maxThreads; i++) {
+      destroyGrowableArena(&threadArenas[i]);
+      threadArenas[i] = createGrowableArena(size_t(1) << 30);
+    }
+  };
+
+  char name[64];
+  auto parse = [&](WorkerPool *wp) {
+    Arena::Scope arena = getScratch(nullptr, 0);
+    Slice<JsonValue> out;
+    CHECK(tryParseNdjson(wp, arena, {pThreadArenas, maxThreads}, ndjson, out));
+    snBenchDoNotOptimize(out);
+  };
+
+  snBenchMeasure("tryParseNdjson/serial", ndjson.length, reset,
+                 [&]() { parse(nullptr); });
+  benchForEachPoolSize([&](WorkerPool *wp, u32 numThreads) {
+    snprintf(name, sizeof(name), "tryParseNdjson/threads=%u", numThreads);
+    snBenchMeasure(name, ndjson.length, reset, [&]() { parse(wp); });
+  });
+
+  for (u32 i = 0; i < maxThreads; i++) {
+    destroyGrowableArena(&threadArenas[i]);
+  }
+}
+
+namespace {
+/** \brief Discards the output, to measure the writer alone */
+struct NullSink : JsonSink {
+  bool write(Slice<char> chunk) override {
+    snBenchDoNotOptimize(chunk);
+    return true;
+  }
+};
+}  // namespace
+
+static void benchWrite(const char *name, Slice<char> json) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  JsonValue value;
+  Slice<char> src = json;
+  CHECK(tryParseValue(temp, src, value));
+
+  // Throughput is reported in MB/s of input; the output has the same
+  // formatting
+  char buf[64];
+  snprintf(buf, sizeof(buf), "writeJson/%s", name);
+  snBenchMeasure(buf, json.length, [&]() {
+    Arena::Scope arena = getScratch(nullptr, 0);
+    Slice<char> out = writeJson(arena, value);
+    snBenchDoNotOptimize(out);
+  });
+
+  snprintf(buf, sizeof(buf), "sink/%s", name);
+  snBenchMeasure(buf, json.length, [&]() {
+    Arena::Scope arena = getScratch(nullptr, 0);
+    NullSink sink;
+    JsonWriter writer(arena, &sink);
+    writer.value(value);
+    CHECK(writer.flush());
+  });
+}
+
+SN_BENCH(Json, write) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  benchWrite("geoJson", makeGeoJson(temp, 1 << 20));
+  benchWrite("records", makeStringRecords(temp, 1 << 17));
+
+  // Number formatting alone, against the C library
+  const size_t N = 1 << 16;
+  MutSlice<u64> random;
+  alloc(temp, N, random);
+  benchFillRandom(random, 7);
+  f64 *numbers = alloc<f64>(temp, N);
+  for (size_t i = 0; i < N; i++) {
+    numbers[i] = f64(random[i] >> 11) * 0x1p-40;
+  }
+
+  char buf[JSON_NUMBER_MAX_LENGTH];
+  snBenchMeasure("format/formatJsonNumber", N, [&]() {
+    size_t total = 0;
+    for (size_t i = 0; i < N; i++) {
+      total += formatJsonNumber(buf, numbers[i]);
+    }
+    snBenchDoNotOptimize(total);
+  });
+
+  snBenchMeasure("format/snprintf", N, [&]() {
+    size_t total = 0;
+    for (size_t i = 0; i < N; i++) {
+      total += size_t(snprintf(buf, sizeof(buf), "%.17g", numbers[i]));
+    }
+    snBenchDoNotOptimize(total);
+  });
+}
+
+SN_BENCH(Json, wideObjects) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  for (u32 numKeys : {16, 64, 256, 1024, 4096}) {
+    // Keys of the shape of field names: "field_0"...
+    Slice<char> *keys = alloc<Slice<char>>(temp, numKeys);
+    Vector<char> json = {};
+    appendVal(temp.arena, &json, '{');
+    for (u32 i = 0; i < numKeys; i++) {
+      char *key = alloc<char>(temp, 32);
+      keys[i] = {key, size_t(snprintf(key, 32, "field_%u", i))};
+
+      char buf[64];
+      int n = snprintf(buf, sizeof(buf), "%s\"%s\":%u", i ? "," : "", key, i);
+      memcpy(append(temp.arena, &json, size_t(n)), buf, size_t(n));
+    }
+    appendVal(temp.arena, &json, '}');
+    const Slice<char> src = {json.data, json.length};
+
+    // Every key is looked up once, in a shuffled order
+    MutSlice<u64> random;
+    alloc(temp, numKeys, random);
+    benchFillRandom(random, 3);
+    for (u32 i = numKeys - 1; i > 0; i--) {
+      const u32 j = u32(random[i] % (i + 1));
+      Slice<char> t = keys[i];
+      keys[i] = keys[j];
+      keys[j] = t;
+    }
+
+    char name[64];
+    for (u32 flags : {0u, u32(JSON_PARSE_INDEX_OBJECTS)}) {
+      JsonValue obj;
+      Slice<char> s = src;
+      CHECK(tryParseValue(temp, s, obj, flags));
+
+      snprintf(name, sizeof(name), "getKeyValue/%s/keys=%u",
+               flags ? "indexed" : "linear", numKeys);
+      snBenchMeasure(name, numKeys, [&]() {
+        f64 sum = 0;
+        for (u32 i = 0; i < numKeys; i++) {
+          sum += getKeyValue(&obj, keys[i])->number;
+        }
+        snBenchDoNotOptimize(sum);
+      });
+    }
+
+    // What building the index adds to parsing
+    snprintf(name, sizeof(name), "parse/JSON_PARSE_INDEX_OBJECTS/keys=%u",
+             numKeys);
+    benchParse(name, src, JSON_PARSE_INDEX_OBJECTS);
+  }
+}
+
+/**
+ * \brief Reads `key` of every element of the array in `arrayKey` of the root
+ * object, with a cursor or from the parsed tree.
+ */
+static void benchSparseAccess(const char *name,
+                              Slice<char> json,
+                              Slice<char> arrayKey,
+                              Slice<Slice<char>> path) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "tryParseValue/%s", name);
+  snBenchMeasure(buf, json.length, [&]() {
+    Arena::Scope arena = getScratch(nullptr, 0);
+    JsonValue root;
+    Slice<char> src = json;
+    CHECK(tryParseValue(arena, src, root));
+
+    size_t total = 0;
+    JsonValue *array = arrayKey.empty() ? &root : getKeyValue(&root, arrayKey);
+    for (auto [element, _] : array->array()) {
+      JsonValue *value = &element;
+      for (auto [key, _] : path) {
+        value = getKeyValue(value, key);
+      }
+      total += value->length;
+    }
+    snBenchDoNotOptimize(total);
+  });
+
+  snprintf(buf, sizeof(buf), "JsonCursor/%s", name);
+  snBenchMeasure(buf, json.length, [&]() {
+    Arena::Scope arena = getScratch(nullptr, 0);
+    JsonCursor cursor(json);
+
+    size_t total = 0;
+    u32 level;
+    if (!arrayKey.empty()) {
+      CHECK(cursor.tryEnterObject(level));
+      CHECK(cursor.findKey(level, arrayKey));
+    }
+    CHECK(cursor.tryEnterArray(level));
+    while (cursor.nextElement(level)) {
+      for (auto [key, _] : path) {
+        u32 object;
+        CHECK(cursor.tryEnterObject(object) && cursor.findKey(object, key));
+      }
+      Slice<char> value;
+      CHECK(cursor.tryReadString(arena, value));
+      total += value.length;
+    }
+    CHECK(!cursor.failed);
+    snBenchDoNotOptimize(total);
+  });
+}
+
+SN_BENCH(Json, onDemand) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  // The type of every polygon; the coordinates are skipped
+  const Slice<char> geometryType[] = {sliceFromConstChar("geometry"),
+                                      sliceFromConstChar("type")};
+  benchSparseAccess("geoJson", makeGeoJson(temp, 1 << 20),
+                    sliceFromConstChar("features"), sliceFrom(geometryType));
+
+  // One field out of four in every record
+  const Slice<char> status[] = {sliceFromConstChar("status")};
+  benchSparseAccess("records", makeStringRecords(temp, 1 << 17), {},
+                    sliceFrom(status));
+}
+
+/** \brief Sums the numbers in the tree, depth first */
+static f64 sumNumbers(const JsonValue &value) {
+  switch (value.type) {
+    case JsonType::Number:
+      return value.number;
+    case JsonType::Array: {
+      f64 sum = 0;
+      for (size_t i = 0; i < value.length; i++) {
+        sum += sumNumbers(value.arr[i]);
+      }
+      return sum;
+    }
+    case JsonType::Object: {
+      f64 sum = 0;
+      for (size_t i = 0; i < value.length; i++) {
+        sum += sumNumbers(value.kv[i].value);
+      }
+      return sum;
+    }
+    default:
+      return 0;
+  }
+}
+
+static void benchTape(const char *name, Slice<char> json) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "tryParseValue/%s", name);
+  benchParse(buf, json, 0);
+
+  snprintf(buf, sizeof(buf), "tryParseJsonTape/%s", name);
+  snBenchMeasure(buf, json.length, [&]() {
+    Arena::Scope arena = getScratch(nullptr, 0);
+    JsonTape tape;
+    CHECK(tryParseJsonTape(arena, json, tape));
+    snBenchDoNotOptimize(tape);
+  });
+
+  // Visiting every node; the tape is in document order
+  Arena::Scope temp = getScratch(nullptr, 0);
+  JsonValue value;
+  Slice<char> src = json;
+  CHECK(tryParseValue(temp, src, value));
+  JsonTape tape;
+  CHECK(tryParseJsonTape(temp, json, tape));
+
+  snprintf(buf, sizeof(buf), "walk/tree/%s", name);
+  snBenchMeasure(buf, json.length,
+                 [&]() { snBenchDoNotOptimize(sumNumbers(value)); });
+
+  snprintf(buf, sizeof(buf), "walk/tape/%s", name);
+  snBenchMeasure(buf, json.length, [&]() {
+    f64 sum = 0;
+    for (size_t i = 0; i < tape.words.length; i++) {
+      JsonTapeValue node = {&tape, i};
+      if (node.tag() == JSON_TAPE_NUMBER) {
+        sum += node.number();
+        i++;
+      } else if (node.tag() == JSON_TAPE_INTEGER ||
+                 node.tag() == JSON_TAPE_UNSIGNED_INTEGER) {
+        i++;
+      }
+    }
+    snBenchDoNotOptimize(sum);
+  });
+}
+
+SN_BENCH(Json, tape) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  benchTape("geoJson", makeGeoJson(temp, 1 << 20));
+  benchTape("records", makeStringRecords(temp, 1 << 17));
+}
+
+/**
+ * \brief Measures `tryParseValue` on a corpus, and reports how much it
+ * allocates from the output arena.
+ */
+static void benchCorpus(const char *name, Slice<char> json) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "parse/%s", name);
+  benchParse(buf, json, 0);
+
+  Arena::Scope arena = getScratch(nullptr, 0);
+  // Allocations grow down from the end of the arena
+  const u8 *before = arena.arena->end;
+  JsonValue value;
+  Slice<char> src = json;
+  CHECK(tryParseValue(arena, src, value));
+
+  const f64 numBytes = f64(before - arena.arena->end);
+  snprintf(buf, sizeof(buf), "arena/%s", name);
+  snBenchReportValue(buf, numBytes / f64(json.length),
+                     "arena bytes per input byte");
+}
+
+SN_BENCH(Json, corpora) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  // Throughput is reported in MB/s. Strings point into the input, so the
+  // arena holds the tree and the decoded escaped strings only.
+  benchCorpus("numbers/geoJson", makeGeoJson(temp, 1 << 18));
+  benchCorpus("numbers/integers", makeIntegerArray(temp, 1 << 18));
+  benchCorpus("strings/records", makeStringRecords(temp, 1 << 15));
+  benchCorpus("strings/escaped", makeEscapedStrings(temp, 1 << 16));
+  benchCorpus("nested/depth=16", makeNested(temp, 1 << 13, 16));
+  benchCorpus("nested/depth=512", makeNested(temp, 1 << 8, 512));
+  benchCorpus("wide/keys=32", makeWideObjects(temp, 1 << 12, 32));
+  benchCorpus("wide/keys=4096", makeWideObjects(temp, 1 << 5, 4096));
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2026 Daniel Meszaros
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <std/Benchmark.hpp>
+#include <std/bench/Common.hpp>
+#include <std/Parallel.hpp>
+#include <std/Sort.hpp>
+#include <std/WorkerPool.hpp>
+
+#include <stdio.h>
+
+static void benchSort(size_t n) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  MutSlice<u32> input, s;
+  alloc(temp, n, input);
+  alloc(temp, n, s);
+  benchFillRandom(input, 1);
+
+  char name[64];
+  auto reset = [&]() { s.copy(input); };
+
+  snprintf(name, sizeof(name), "mergeSort/%zu", n);
+  snBenchMeasure(name, n, reset, [&]() { mergeSort(s); });
+
+  benchForEachPoolSize([&](WorkerPool *wp, u32 numThreads) {
+    snprintf(name, sizeof(name), "parallelMergeSort/%zu/threads=%u", n,
+             numThreads);
+    snBenchMeasure(name, n, reset, [&]() { parallelMergeSort(wp, s); });
+  });
+}
+
+SN_BENCH(Parallel, mergeSort) {
+  benchSort(1 << 20);
+  benchSort(1 << 22);
+}
+
+SN_BENCH(Parallel, reduceAndScan) {
+  const size_t n = 1 << 24;
+  Arena::Scope temp = getScratch(nullptr, 0);
+  MutSlice<u32> s, dst;
+  alloc(temp, n, s);
+  alloc(temp, n, dst);
+  benchFillRandom(s, 2);
+
+  auto add = [](u32 lhs, u32 rhs) { return lhs + rhs; };
+
+  snBenchMeasure("reduce/serial", n, [&]() {
+    u32 acc = 0;
+    for (size_t i = 0; i < n; i++) {
+      acc += s[i];
+    }
+    snBenchDoNotOptimize(acc);
+  });
+  snBenchMeasure("scan/serial", n, [&]() {
+    u32 acc = 0;
+    for (size_t i = 0; i < n; i++) {
+      acc += s[i];
+      dst[i] = acc;
+    }
+  });
+
+  char name[64];
+  benchForEachPoolSize([&](WorkerPool *wp, u32 numThreads) {
+    snprintf(name, sizeof(name), "parallelReduce/threads=%u", numThreads);
+    snBenchMeasure(name, n, [&]() {
+      snBenchDoNotOptimize(parallelReduce<u32>(wp, s, 0, add));
+    });
+
+    snprintf(name, sizeof(name), "parallelScan/threads=%u", numThreads);
+    snBenchMeasure(name, n,
+                   [&]() { parallelScan<u32>(wp, dst, s, 0, add); });
+  });
+}
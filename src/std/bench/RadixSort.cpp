@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2026 Daniel Meszaros
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <std/Benchmark.hpp>
+#include <std/bench/Common.hpp>
+#include <std/RadixSort.hpp>
+#include <std/RadixSortParallel.hpp>
+#include <std/WorkerPool.hpp>
+
+#include <stdio.h>
+
+template <typename K>
+static void benchRadixSort(const char *keyName, u32 N) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  MutSlice<K> keys;
+  alloc(temp, N, keys);
+  benchFillRandom(keys, 3);
+  u32 *indices = alloc<u32>(temp, N);
+  u32 *scratch = alloc<u32>(temp, N);
+
+  auto reset = [&]() {
+    for (u32 i = 0; i < N; i++) {
+      indices[i] = i;
+    }
+  };
+
+  char name[64];
+  snprintf(name, sizeof(name), "radixSort/%s/%u", keyName, N);
+  snBenchMeasure(name, N, reset,
+                 [&]() { radixSort(N, indices, scratch, keys.data); });
+
+  benchForEachPoolSize([&](WorkerPool *wp, u32 numThreads) {
+    snprintf(name, sizeof(name), "radixSort/%s/%u/threads=%u", keyName, N,
+             numThreads);
+    snBenchMeasure(name, N, reset, [&]() {
+      radixSort(wp, N, indices, scratch, keys.data);
+    });
+  });
+}
+
+SN_BENCH(RadixSort, scaling) {
+  benchRadixSort<u32>("u32", 1 << 22);
+  benchRadixSort<u64>("u64", 1 << 22);
+}
+
+/**
+ * Sorting key-value pairs directly vs. sorting indices and gathering the
+ * values afterwards.
+ */
+template <typename K>
+static void benchRadixSortKeyValue(const char *keyName, u32 N) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  MutSlice<K> input, keys, keysTemp;
+  MutSlice<u32> values, valuesTemp;
+  alloc(temp, N, input);
+  alloc(temp, N, keys);
+  alloc(temp, N, keysTemp);
+  alloc(temp, N, values);
+  alloc(temp, N, valuesTemp);
+  benchFillRandom(input, 4);
+
+  auto reset = [&]() {
+    keys.copy(input);
+    for (u32 i = 0; i < N; i++) {
+      values[i] = i;
+    }
+  };
+
+  char name[64];
+  snprintf(name, sizeof(name), "indicesAndGather/%s/%u", keyName, N);
+  snBenchMeasure(name, N, reset, [&]() {
+    radixSort(N, values.data, valuesTemp.data, input.data);
+    for (u32 i = 0; i < N; i++) {
+      keys[i] = input[values[i]];
+    }
+  });
+
+  snprintf(name, sizeof(name), "keyValue/%s/%u", keyName, N);
+  snBenchMeasure(name, N, reset,
+                 [&]() { radixSort(keys, values, keysTemp, valuesTemp); });
+
+  snprintf(name, sizeof(name), "keysOnly/%s/%u", keyName, N);
+  snBenchMeasure(name, N, reset, [&]() { radixSort(keys, keysTemp); });
+}
+
+SN_BENCH(RadixSort, keyValue) {
+  benchRadixSortKeyValue<u32>("u32", 1 << 22);
+  benchRadixSortKeyValue<u64>("u64", 1 << 22);
+  benchRadixSortKeyValue<f32>("f32", 1 << 22);
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2026 Daniel Meszaros
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <std/Benchmark.hpp>
+#include <std/bench/Common.hpp>
+#include <std/Sort.hpp>
+
+#include <stdio.h>
+
+namespace {
+
+// The recursive top-down merge sort that `mergeSort` used to be, kept as a
+// baseline
+
+template <typename T, typename Cmp>
+void legacyMerge(MutSlice<T> dst,
+                 Slice<T> left,
+                 Slice<T> right,
+                 const Cmp &cmp) {
+  size_t idxLeft = 0;
+  size_t idxRight = 0;
+
+  for (size_t idxDst = 0; idxDst < dst.length; idxDst++) {
+    if (idxLeft < left.length &&
+        (idxRight == right.length || cmp(left[idxLeft], right[idxRight]))) {
+      dst[idxDst] = left[idxLeft++];
+    } else {
+      dst[idxDst] = right[idxRight++];
+    }
+  }
+}
+
+template <typename T, typename Cmp>
+void legacyMergeSortImpl(MutSlice<T> dst, MutSlice<T> s, const Cmp &cmp) {
+  if (s.length == 1) {
+    return;
+  }
+
+  MutSlice<T> left = s.subarray(0, s.length / 2);
+  MutSlice<T> right = s.subarray(s.length / 2);
+  MutSlice<T> dstLeft = dst.subarray(0, left.length);
+  MutSlice<T> dstRight = dst.subarray(left.length);
+
+  legacyMergeSortImpl<T, Cmp>(left, dstLeft, cmp);
+  legacyMergeSortImpl<T, Cmp>(right, dstRight, cmp);
+
+  legacyMerge(dst, left.asSlice(), right.asSlice(), cmp);
+}
+
+template <typename T>
+void legacyMergeSort(MutSlice<T> s) {
+  if (s.empty()) {
+    return;
+  }
+  Arena::Scope temp = getScratch(nullptr, 0);
+  MutSlice<T> copy = duplicate<T>(temp, s);
+  legacyMergeSortImpl<T>(s, copy, impl::Less<T>{});
+}
+
+struct Element32 {
+  u64 key;
+  u64 payload[3];
+
+  bool operator<(const Element32 &other) const { return key < other.key; }
+};
+
+enum class Distribution {
+  Random,
+  Sorted,
+  NearlySorted,
+  Reversed,
+  FewUnique,
+};
+
+const char *distributionName(Distribution distribution) {
+  switch (distribution) {
+    case Distribution::Random:
+      return "random";
+    case Distribution::Sorted:
+      return "sorted";
+    case Distribution::NearlySorted:
+      return "nearlySorted";
+    case Distribution::Reversed:
+      return "reversed";
+    case Distribution::FewUnique:
+      return "fewUnique";
+  }
+  return "";
+}
+
+void setKey(u32 &elem, u64 key) {
+  elem = u32(key);
+}
+
+void setKey(u64 &elem, u64 key) {
+  elem = key;
+}
+
+void setKey(Element32 &elem, u64 key) {
+  elem = {key, {key, key, key}};
+}
+
+template <typename T>
+void fillDistribution(MutSlice<T> s, Distribution distribution) {
+  MutSlice<u64> keys;
+  Arena::Scope temp = getScratch(nullptr, 0);
+  alloc(temp, s.length, keys);
+  benchFillRandom(keys, 5);
+
+  for (auto [elem, i] : s) {
+    u64 key = keys[i];
+    switch (distribution) {
+      case Distribution::Random:
+        break;
+      case Distribution::Sorted:
+        key = i;
+        break;
+      case Distribution::NearlySorted:
+        // Every 64th element is out of place
+        key = (key % 64) == 0 ? key % s.length : i;
+        break;
+      case Distribution::Reversed:
+        key = s.length - i;
+        break;
+      case Distribution::FewUnique:
+        key %= 16;
+        break;
+    }
+    setKey(elem, key);
+  }
+}
+
+template <typename T>
+void benchSorts(const char *typeName) {
+  for (size_t n : {size_t(16), size_t(256), size_t(4096), size_t(1) << 16,
+                   size_t(1) << 20}) {
+    for (Distribution distribution :
+         {Distribution::Random, Distribution::Sorted,
+          Distribution::NearlySorted, Distribution::Reversed,
+          Distribution::FewUnique}) {
+      Arena::Scope temp = getScratch(nullptr, 0);
+      MutSlice<T> input, s;
+      alloc(temp, n, input);
+      alloc(temp, n, s);
+      fillDistribution(input, distribution);
+
+      auto reset = [&]() { s.copy(input); };
+      const char *distName = distributionName(distribution);
+      char name[80];
+
+      snprintf(name, sizeof(name), "legacyMergeSort/%s/%s/%zu", typeName,
+               distName, n);
+      snBenchMeasure(name, n, reset, [&]() { legacyMergeSort(s); });
+
+      snprintf(name, sizeof(name), "stableSort/%s/%s/%zu", typeName, distName,
+               n);
+      snBenchMeasure(name, n, reset, [&]() { stableSort(s); });
+
+      snprintf(name, sizeof(name), "unstableSort/%s/%s/%zu", typeName,
+               distName, n);
+      snBenchMeasure(name, n, reset, [&]() { unstableSort(s); });
+    }
+  }
+}
+
+}  // namespace
+
+SN_BENCH(Sort, u32) {
+  benchSorts<u32>("u32");
+}
+
+SN_BENCH(Sort, u64) {
+  benchSorts<u64>("u64");
+}
+
+SN_BENCH(Sort, element32) {
+  benchSorts<Element32>("element32");
+}
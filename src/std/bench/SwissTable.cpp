@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2026 Daniel Meszaros
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <std/Benchmark.hpp>
+#include <std/bench/Common.hpp>
+#include <std/FlatSwissTable.hpp>
+#include <std/SwissMap.hpp>
+#include <std/SwissTable.hpp>
+
+#include <stdio.h>
+
+/**
+ * Measures inserting `n` keys into an empty table, then looking up `n` keys
+ * that are in the table and `n` keys that are not.
+ */
+template <typename Table>
+static void benchTable(const char *tableName, size_t n) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  MutSlice<u64> keys, otherKeys;
+  alloc(temp, n, keys);
+  alloc(temp, n, otherKeys);
+  // Odd and even keys never collide
+  benchFillRandom(keys, n);
+  benchFillRandom(otherKeys, n + 1);
+  for (size_t i = 0; i < n; i++) {
+    keys[i] |= 1;
+    otherKeys[i] &= ~u64(1);
+  }
+
+  char name[64];
+  snprintf(name, sizeof(name), "%s/insert/%zu", tableName, n);
+  snBenchMeasure(name, n, [&]() {
+    Arena::Scope tableArena = getScratch(nullptr, 0);
+    Table table(tableArena);
+    for (size_t i = 0; i < n; i++) {
+      table.put(keys[i], i);
+    }
+    snBenchDoNotOptimize(table);
+  });
+
+  Table table(temp);
+  for (size_t i = 0; i < n; i++) {
+    table.put(keys[i], i);
+  }
+
+  snprintf(name, sizeof(name), "%s/getHit/%zu", tableName, n);
+  snBenchMeasure(name, n, [&]() {
+    u64 sum = 0;
+    for (size_t i = 0; i < n; i++) {
+      sum += *table.get(keys[i]);
+    }
+    snBenchDoNotOptimize(sum);
+  });
+
+  snprintf(name, sizeof(name), "%s/getMiss/%zu", tableName, n);
+  snBenchMeasure(name, n, [&]() {
+    size_t numFound = 0;
+    for (size_t i = 0; i < n; i++) {
+      numFound += table.get(otherKeys[i]) != nullptr ? 1 : 0;
+    }
+    snBenchDoNotOptimize(numFound);
+  });
+}
+
+SN_BENCH(SwissTable, u64Keys) {
+  for (size_t n : {size_t(1) << 10, size_t(1) << 16, size_t(1) << 20}) {
+    benchTable<SwissTable<u64, u64>>("SwissTable", n);
+    benchTable<FlatSwissTable<u64, u64>>("FlatSwissTable", n);
+    benchTable<SwissMap<u64, u64>>("SwissMap", n);
+  }
+}
+
+/**
+ * Measures a bulk load into a table that was reserved up front, and a stream
+ * of insertions and removals that keeps the number of keys constant.
+ */
+template <typename Table>
+static void benchReserveAndChurn(const char *tableName, size_t n) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  MutSlice<u64> keys;
+  alloc(temp, 4 * n, keys);
+  benchFillRandom(keys, n);
+
+  char name[64];
+  snprintf(name, sizeof(name), "%s/insertReserved/%zu", tableName, n);
+  snBenchMeasure(name, n, [&]() {
+    Arena::Scope tableArena = getScratch(nullptr, 0);
+    Table table(tableArena);
+    table.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+      table.put(keys[i], i);
+    }
+    snBenchDoNotOptimize(table);
+  });
+
+  snprintf(name, sizeof(name), "%s/churn/%zu", tableName, n);
+  snBenchMeasure(name, 3 * n, [&]() {
+    Arena::Scope tableArena = getScratch(nullptr, 0);
+    Table table(tableArena);
+    for (size_t i = 0; i < n; i++) {
+      table.put(keys[i], i);
+    }
+    for (size_t i = n; i < 4 * n; i++) {
+      table.put(keys[i], i);
+      table.remove(keys[i - n]);
+    }
+    snBenchDoNotOptimize(table);
+  });
+}
+
+SN_BENCH(SwissTable, reserveAndChurn) {
+  for (size_t n : {size_t(1) << 10, size_t(1) << 16}) {
+    benchReserveAndChurn<SwissTable<u64, u64>>("SwissTable", n);
+    benchReserveAndChurn<FlatSwissTable<u64, u64>>("FlatSwissTable", n);
+    benchReserveAndChurn<SwissMap<u64, u64>>("SwissMap", n);
+  }
+}
+
+/**
+ * Measures `n` lookups, half of them hits, one by one with `get` and all at
+ * once with `getBatch`.
+ *
+ * \param keysOf Converts a slice of u64 keys into what `getBatch` expects
+ */
+template <typename Table, typename KeysOf>
+static void benchGetBatch(const char *tableName,
+                          size_t n,
+                          const KeysOf &keysOf) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  MutSlice<u64> keys;
+  MutSlice<u64 *> out;
+  alloc(temp, n, keys);
+  alloc(temp, n, out);
+  benchFillRandom(keys, n);
+
+  Table table(temp);
+  table.reserve(n / 2);
+  for (size_t i = 0; i < n; i += 2) {
+    table.put(keys[i], i);
+  }
+  auto batchKeys = keysOf(temp, keys);
+
+  char name[64];
+  snprintf(name, sizeof(name), "%s/get/%zu", tableName, n);
+  snBenchMeasure(name, n, [&]() {
+    for (size_t i = 0; i < n; i++) {
+      out[i] = table.get(keys[i]);
+    }
+    snBenchDoNotOptimize(out.data);
+  });
+
+  snprintf(name, sizeof(name), "%s/getBatch/%zu", tableName, n);
+  snBenchMeasure(name, n, [&]() {
+    table.getBatch(batchKeys, out);
+    snBenchDoNotOptimize(out.data);
+  });
+}
+
+SN_BENCH(SwissTable, getBatch) {
+  auto sliceKeys = [](Arena *arena, Slice<u64> keys) {
+    MutSlice<Slice<u64>> ret;
+    alloc(arena, keys.length, ret);
+    for (size_t i = 0; i < keys.length; i++) {
+      ret[i] = keys[i];
+    }
+    return Slice<Slice<u64>>(ret);
+  };
+  auto plainKeys = [](Arena *, Slice<u64> keys) { return keys; };
+
+  // The second size is well beyond the size of the L2 cache
+  for (size_t n : {size_t(1) << 12, size_t(1) << 21}) {
+    benchGetBatch<SwissTable<u64, u64>>("SwissTable", n, sliceKeys);
+    benchGetBatch<FlatSwissTable<u64, u64>>("FlatSwissTable", n, sliceKeys);
+    benchGetBatch<SwissMap<u64, u64>>("SwissMap", n, plainKeys);
+  }
+}
@@ -0,0 +1,276 @@
+#include "std/json/Cursor.hpp"
+#include "std/Arena.h"
+#include "std/Slice.hpp"
+#include "std/Types.h"
+#include "std/json/Parser.hpp"
+#include "std/json/Scanner.hpp"
+#include "std/json/Value.hpp"
+
+static bool isOpening(char c) {
+  return c == '[' || c == '{';
+}
+
+static bool isClosing(char c) {
+  return c == ']' || c == '}';
+}
+
+JsonCursor::JsonCursor(Slice<char> json, u32 flags)
+    : json(json), flags(flags), scanner(json) {
+  _advance();
+}
+
+JsonType JsonCursor::type() const {
+  if (pos == json.length) {
+    return JsonType::Null;
+  }
+
+  switch (json[pos]) {
+    case '[':
+      return JsonType::Array;
+    case '{':
+      return JsonType::Object;
+    case '"':
+      return JsonType::String;
+    case 'n':
+      return JsonType::Null;
+    case 't':
+      return JsonType::True;
+    case 'f':
+      return JsonType::False;
+    default:
+      return JsonType::Number;
+  }
+}
+
+bool JsonCursor::tryRead(Arena *arena, JsonValue &out) {
+  if (!_beginValue()) {
+    return false;
+  }
+
+  const size_t start = pos;
+  size_t end;
+  if (isOpening(json[pos])) {
+    if (!_skip(end)) {
+      return false;
+    }
+
+    Slice<char> src = json.subarray(start, end);
+    return tryParseValue(arena, src, out, flags) || _fail();
+  }
+
+  if (!impl::tryParseJsonScalar(arena, json, start, flags, out, end)) {
+    return _fail();
+  }
+
+  _advance();
+  return true;
+}
+
+bool JsonCursor::tryReadNumber(f64 &out) {
+  if (type() != JsonType::Number) {
+    return _fail();
+  }
+
+  // Numbers don't allocate
+  JsonValue value;
+  if (!tryRead(nullptr, value)) {
+    return false;
+  }
+
+  switch (value.type) {
+    case JsonType::Integer:
+      out = f64(value.integer);
+      return true;
+    case JsonType::UnsignedInteger:
+      out = f64(value.uinteger);
+      return true;
+    default:
+      out = value.number;
+      return true;
+  }
+}
+
+bool JsonCursor::tryReadString(Arena *arena, Slice<char> &out) {
+  if (type() != JsonType::String) {
+    return _fail();
+  }
+
+  JsonValue value;
+  if (!tryRead(arena, value)) {
+    return false;
+  }
+
+  out = value.string();
+  return true;
+}
+
+bool JsonCursor::trySkip() {
+  size_t end;
+  return _beginValue() && _skip(end);
+}
+
+bool JsonCursor::tryEnterArray(u32 &level) {
+  if (type() != JsonType::Array || !_beginValue()) {
+    return _fail();
+  }
+
+  _advance();
+  level = ++depth;
+  atFirst = true;
+  return true;
+}
+
+bool JsonCursor::tryEnterObject(u32 &level) {
+  if (type() != JsonType::Object || !_beginValue()) {
+    return _fail();
+  }
+
+  _advance();
+  level = ++depth;
+  atFirst = true;
+  return true;
+}
+
+bool JsonCursor::nextElement(u32 level) {
+  if (!_toNext(level, ']')) {
+    return false;
+  }
+
+  valuePending = true;
+  return true;
+}
+
+bool JsonCursor::nextKey(u32 level, Arena *arena, Slice<char> &key) {
+  if (!_toNext(level, '}')) {
+    return false;
+  }
+
+  if (pos == json.length || json[pos] != '"') {
+    return _fail();
+  }
+
+  JsonValue value;
+  size_t end;
+  if (!impl::tryParseJsonScalar(arena, json, pos, flags, value, end)) {
+    return _fail();
+  }
+  key = value.string();
+
+  _advance();
+  if (pos == json.length || json[pos] != ':') {
+    return _fail();
+  }
+
+  _advance();
+  valuePending = true;
+  return true;
+}
+
+bool JsonCursor::findKey(u32 level, Slice<char> key) {
+  while (true) {
+    // Escaped keys are decoded only for the comparison
+    Arena::Scope temp = getScratch(nullptr, 0);
+    Slice<char> candidate;
+    if (!nextKey(level, temp, candidate)) {
+      return false;
+    }
+
+    if (candidate == key) {
+      return true;
+    }
+  }
+}
+
+void JsonCursor::_advance() {
+  if (!scanner.next(pos)) {
+    pos = json.length;
+  }
+}
+
+bool JsonCursor::_fail() {
+  failed = true;
+  return false;
+}
+
+bool JsonCursor::_beginValue() {
+  if (failed || !valuePending || pos == json.length) {
+    return _fail();
+  }
+
+  const char c = json[pos];
+  if (isClosing(c) || c == ',' || c == ':') {
+    return _fail();
+  }
+
+  valuePending = false;
+  return true;
+}
+
+bool JsonCursor::_skip(size_t &end) {
+  u32 open = 0;
+  do {
+    if (pos == json.length) {
+      return _fail();
+    }
+
+    const char c = json[pos];
+    if (isOpening(c)) {
+      open++;
+    } else if (isClosing(c)) {
+      open--;
+    }
+    end = pos + 1;
+    _advance();
+  } while (open != 0);
+
+  return true;
+}
+
+bool JsonCursor::_toNext(u32 level, char closing) {
+  if (failed || depth < level) {
+    // The container has ended already
+    return false;
+  }
+
+  if (depth > level) {
+    // Leave the containers that were entered but not iterated to the end
+    while (depth > level) {
+      if (pos == json.length) {
+        return _fail();
+      }
+
+      const char c = json[pos];
+      if (isOpening(c)) {
+        depth++;
+      } else if (isClosing(c)) {
+        depth--;
+      }
+      _advance();
+    }
+    valuePending = false;
+  } else if (valuePending && !trySkip()) {
+    return false;
+  }
+
+  if (pos == json.length) {
+    return _fail();
+  }
+
+  const char c = json[pos];
+  if (c == closing) {
+    _advance();
+    depth--;
+    atFirst = false;
+    return false;
+  }
+
+  if (!atFirst) {
+    if (c != ',') {
+      return _fail();
+    }
+    _advance();
+  }
+
+  atFirst = false;
+  return true;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "std/Arena.h"
+#include "std/Slice.hpp"
+#include "std/Types.h"
+#include "std/json/Scanner.hpp"
+#include "std/json/Value.hpp"
+
+/**
+ * \brief Reads a JSON document on demand, without building the tree.
+ *
+ * The cursor walks the tokens found by the `JsonScanner` forward only. Values
+ * that aren't read are skipped by counting brackets, and only the strings and
+ * numbers that are read get decoded, so sparse access to a large document
+ * neither allocates nor decodes much.
+ *
+ * The cursor is positioned on a value at first (the root), after
+ * `nextElement` and `nextKey` returned true, and after `findKey` found the
+ * key. That value can be read, skipped or entered once. Containers are
+ * iterated like this:
+ *
+ *     u32 level;
+ *     if (cursor.tryEnterObject(level)) {
+ *       Slice<char> key;
+ *       while (cursor.nextKey(level, arena, key)) {
+ *         // read, skip, enter or ignore the value
+ *       }
+ *     }
+ *     if (cursor.failed) ...
+ *
+ * Values that are left unread, and containers that are left before their end,
+ * are skipped by the next call on the outer level.
+ *
+ * Only the parts that are read are validated: skipped values are only checked
+ * for balanced brackets.
+ *
+ * Like with `tryParseValue`, escape-free strings point into `json` unless
+ * `JSON_PARSE_COPY_STRINGS` is passed.
+ */
+struct JsonCursor {
+  Slice<char> json;
+  /** \brief `JsonParseFlags` */
+  u32 flags;
+  JsonScanner scanner;
+  /** \brief Position of the current token; `json.length` at the end */
+  size_t pos = 0;
+  /** \brief Number of containers the current token is in */
+  u32 depth = 0;
+  /** \brief Whether the cursor is on a value that hasn't been consumed */
+  bool valuePending = true;
+  /** \brief Whether the innermost container has just been entered */
+  bool atFirst = false;
+  /** \brief Set on the first error; every call fails afterwards */
+  bool failed = false;
+
+  explicit JsonCursor(Slice<char> json, u32 flags = 0);
+
+  /**
+   * \brief Returns the type of the current value from its first character.
+   * Numbers are reported as `JsonType::Number` regardless of the flags, and so
+   * is garbage, which fails to read. At the end of the input, this is
+   * `JsonType::Null`.
+   */
+  JsonType type() const;
+
+  /**
+   * \brief Reads the current value. Arrays and objects are parsed into a tree
+   * with `tryParseValue`.
+   * \param arena Receives the decoded strings and the tree
+   */
+  bool tryRead(Arena *arena, JsonValue &out);
+  /** \brief Reads the current value, which must be a number */
+  bool tryReadNumber(f64 &out);
+  /**
+   * \brief Reads the current value, which must be a string.
+   * \param arena Receives the string if it has to be decoded or copied
+   */
+  bool tryReadString(Arena *arena, Slice<char> &out);
+  /** \brief Skips the current value */
+  bool trySkip();
+
+  /**
+   * \brief Enters the current value, which must be an array.
+   * \param level Receives the level to pass to `nextElement`
+   */
+  bool tryEnterArray(u32 &level);
+  /**
+   * \brief Enters the current value, which must be an object.
+   * \param level Receives the level to pass to `nextKey` and `findKey`
+   */
+  bool tryEnterObject(u32 &level);
+
+  /**
+   * \brief Moves to the next element of the array at `level`.
+   * \returns false at the end of the array or on error; check `failed`
+   */
+  bool nextElement(u32 level);
+  /**
+   * \brief Moves to the value of the next key of the object at `level`.
+   * \param arena Receives the key if it has to be decoded or copied
+   * \returns false at the end of the object or on error; check `failed`
+   */
+  bool nextKey(u32 level, Arena *arena, Slice<char> &key);
+  /**
+   * \brief Moves to the value of the next key equal to `key` in the object at
+   * `level`. Only the keys after the current position are searched.
+   * \returns false if there is no such key or on error; check `failed`
+   */
+  bool findKey(u32 level, Slice<char> key);
+
+  void _advance();
+  bool _fail();
+  /** \brief Consumes the pending value if the cursor can read it */
+  bool _beginValue();
+  /**
+   * \brief Moves past the current value.
+   * \param end Receives the offset of the byte after the closing bracket, if
+   * the value is an array or an object
+   */
+  bool _skip(size_t &end);
+  /**
+   * \brief Gets to the separator or the end of the container at `level`,
+   * skipping whatever is left of the current element.
+   */
+  bool _toNext(u32 level, char closing);
+};
@@ -0,0 +1,115 @@
+#include "std/json/Index.hpp"
+#include "std/Arena.h"
+#include "std/Check.h"
+#include "std/Hash.h"
+#include "std/Slice.hpp"
+#include "std/Types.h"
+#include "std/Vector.hpp"
+#include "std/json/Value.hpp"
+
+#include <string.h>
+
+// The index is an open-addressing hash table with linear probing. A slot
+// holds the top 8 bits of the hash of the key in its top 8 bits, and the index
+// of the key-value plus one in the rest; 0 marks an empty slot. Since slots
+// are inserted in order, probing finds duplicate keys in order too.
+
+static constexpr u32 SLOT_INDEX_BITS = 24;
+static constexpr u32 SLOT_INDEX_MASK = (1u << SLOT_INDEX_BITS) - 1;
+
+/** \brief Power of two number of slots, at most half of them used */
+static size_t indexCapacity(size_t numKeys) {
+  size_t capacity = 16;
+  while (capacity < 2 * numKeys) {
+    capacity *= 2;
+  }
+  return capacity;
+}
+
+static u32 *indexSlots(const JsonValue *obj) {
+  return reinterpret_cast<u32 *>(obj->kv + obj->length);
+}
+
+static u32 hashTag(u64 hash) {
+  return u32(hash >> 56) << SLOT_INDEX_BITS;
+}
+
+JsonKeyValue *impl::allocIndexedObject(Arena *arena, size_t numKeys) {
+  static_assert(sizeof(JsonKeyValue) % alignof(u32) == 0);
+  const size_t size = numKeys * sizeof(JsonKeyValue) +
+                      indexCapacity(numKeys) * sizeof(u32);
+  u8 *ptr = allocNZ(arena, size, alignof(JsonKeyValue), 1);
+  return reinterpret_cast<JsonKeyValue *>(ptr);
+}
+
+void impl::buildJsonIndex(JsonValue &obj) {
+  DCHECK(obj.type == JsonType::Object);
+  DCHECK(obj.length <= JSON_INDEX_MAX_KEYS);
+
+  const size_t mask = indexCapacity(obj.length) - 1;
+  u32 *slots = indexSlots(&obj);
+  memset(slots, 0, (mask + 1) * sizeof(u32));
+
+  for (size_t i = 0; i < obj.length; i++) {
+    const u64 hash = hashRapidMicro(obj.kv[i].key);
+    size_t pos = hash & mask;
+    while (slots[pos] != 0) {
+      pos = (pos + 1) & mask;
+    }
+    slots[pos] = hashTag(hash) | u32(i + 1);
+  }
+
+  obj.indexed = true;
+}
+
+JsonValue *impl::findIndexedKey(const JsonValue *obj, Slice<char> key) {
+  const size_t mask = indexCapacity(obj->length) - 1;
+  const u32 *slots = indexSlots(obj);
+
+  const u64 hash = hashRapidMicro(key);
+  const u32 tag = hashTag(hash);
+  for (size_t pos = hash & mask; slots[pos] != 0; pos = (pos + 1) & mask) {
+    const u32 slot = slots[pos];
+    if ((slot & ~SLOT_INDEX_MASK) != tag) {
+      continue;
+    }
+
+    JsonKeyValue &kv = obj->kv[(slot & SLOT_INDEX_MASK) - 1];
+    if (kv.key.length == key.length &&
+        memcmp(kv.key.data, key.data, key.length) == 0) {
+      return &kv.value;
+    }
+  }
+
+  return nullptr;
+}
+
+void indexJsonObjects(Arena *arena, JsonValue &root, size_t minKeys) {
+  Arena::Scope temp = getScratch(&arena, 1);
+  Vector<JsonValue *> stack = {};
+  appendVal(temp, &stack, &root);
+
+  while (stack.length != 0) {
+    JsonValue *value = stack[stack.length - 1];
+    stack.length -= 1;
+
+    if (value->type == JsonType::Array) {
+      for (size_t i = 0; i < value->length; i++) {
+        appendVal(temp, &stack, &value->arr[i]);
+      }
+    } else if (value->type == JsonType::Object) {
+      if (!value->indexed && value->length >= minKeys &&
+          value->length <= impl::JSON_INDEX_MAX_KEYS) {
+        JsonKeyValue *kv = impl::allocIndexedObject(arena, value->length);
+        memcpy(kv, value->kv, value->length * sizeof(JsonKeyValue));
+        value->kv = kv;
+        impl::buildJsonIndex(*value);
+      }
+
+      // Only after the move, so that the copies get indexed
+      for (size_t i = 0; i < value->length; i++) {
+        appendVal(temp, &stack, &value->kv[i].value);
+      }
+    }
+  }
+}
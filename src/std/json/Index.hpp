@@ -0,0 +1,50 @@
+#pragma once
+
+#include "std/Arena.h"
+#include "std/Slice.hpp"
+#include "std/Types.h"
+#include "std/json/Value.hpp"
+
+/** \brief Objects with fewer keys than this are searched linearly */
+static constexpr size_t JSON_INDEX_MIN_KEYS = 16;
+
+/**
+ * \brief Attaches a hash index to every object in the tree that has at least
+ * `minKeys` keys, so that `getKeyValue` finds keys in them in constant time.
+ *
+ * The key-values of those objects are copied into `arena`, followed by the
+ * index. The values of an indexed object may be modified, but its keys and its
+ * `kv` and `length` fields must stay the same.
+ *
+ * Passing `JSON_PARSE_INDEX_OBJECTS` to `tryParseValue` has the same effect
+ * without the copies.
+ */
+void indexJsonObjects(Arena *arena,
+                      JsonValue &root,
+                      size_t minKeys = JSON_INDEX_MIN_KEYS);
+
+namespace impl {
+/**
+ * \brief Objects with more keys than this are never indexed, as the slots of
+ * the index store the index of the key-value in 24 bits
+ */
+static constexpr size_t JSON_INDEX_MAX_KEYS = (1 << 24) - 2;
+
+/**
+ * \brief Allocates space for the key-values of an object and for the index
+ * that follows them.
+ */
+JsonKeyValue *allocIndexedObject(Arena *arena, size_t numKeys);
+
+/**
+ * \brief Builds the index of an object whose key-values have been allocated by
+ * `allocIndexedObject`, and marks it as indexed.
+ */
+void buildJsonIndex(JsonValue &obj);
+
+/**
+ * \brief Looks up `key` in the index of `obj`.
+ * \returns The value of the first key-value with the given key or null
+ */
+JsonValue *findIndexedKey(const JsonValue *obj, Slice<char> key);
+}  // namespace impl
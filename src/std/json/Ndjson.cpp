@@ -0,0 +1,146 @@
+#include "std/json/Ndjson.hpp"
+#include "std/Arena.h"
+#include "std/Check.h"
+#include "std/Parallel.hpp"
+#include "std/Slice.hpp"
+#include "std/Types.h"
+#include "std/WorkerPool.hpp"
+#include "std/json/Parser.hpp"
+#include "std/json/Scanner.hpp"
+#include "std/json/Value.hpp"
+
+#include <string.h>
+
+namespace {
+/** \brief Smallest chunk picked when the caller doesn't specify a grain size */
+constexpr size_t MIN_GRAIN_SIZE = 64 * 1024;
+
+struct Chunk {
+  /** \brief Whole lines of the input */
+  Slice<char> input;
+  /** \brief Allocated from the arena of the thread that parsed the chunk */
+  JsonValue *records;
+  size_t numRecords;
+  bool ok;
+};
+
+struct Params {
+  Slice<Arena *> threadArenas;
+  MutSlice<Chunk> chunks;
+  u32 flags;
+};
+}  // namespace
+
+static bool isBlank(Slice<char> line) {
+  for (size_t i = 0; i < line.length; i++) {
+    char c = line[i];
+    if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void parseChunk(Arena *arena, Chunk &chunk, u32 flags) {
+  // Every line holds at most one record
+  const size_t maxRecords = jsonCountNewlines(chunk.input) + 1;
+  chunk.records = allocNZ<JsonValue>(arena, maxRecords);
+  chunk.numRecords = 0;
+  chunk.ok = true;
+
+  Slice<char> rest = chunk.input;
+  while (!rest.empty()) {
+    const size_t length = jsonFindNewline(rest);
+    Slice<char> line = {rest.data, length};
+    rest.shrinkFromLeftByCount(length < rest.length ? length + 1 : length);
+    if (isBlank(line)) {
+      continue;
+    }
+
+    if (!tryParseValue(arena, line, chunk.records[chunk.numRecords], flags)) {
+      chunk.ok = false;
+      return;
+    }
+    chunk.numRecords++;
+  }
+}
+
+bool tryParseNdjson(WorkerPool *pool,
+                    Arena *arena,
+                    Slice<Arena *> threadArenas,
+                    Slice<char> ndjson,
+                    Slice<JsonValue> &out,
+                    u32 flags,
+                    size_t grainSize) {
+  const size_t numThreads = pool != nullptr ? pool->numWorkerThreads() + 1 : 1;
+  CHECK(threadArenas.length >= numThreads);
+
+  if (grainSize == 0) {
+    // A few chunks per thread, so that threads finishing early can pick up
+    // the work of the slow ones
+    grainSize = ndjson.length / (numThreads * 4);
+    if (grainSize < MIN_GRAIN_SIZE) {
+      grainSize = MIN_GRAIN_SIZE;
+    }
+  }
+
+  // Every chunk but the last one is at least `grainSize` long; they end after
+  // the first newline that follows
+  Arena::Scope temp = getScratch(&arena, 1);
+  MutSlice<Chunk> chunks;
+  alloc(temp, ndjson.length / grainSize + 1, chunks);
+  size_t numChunks = 0;
+  for (size_t begin = 0; begin < ndjson.length;) {
+    size_t end = begin + grainSize;
+    if (end < ndjson.length) {
+      end += jsonFindNewline(ndjson.subarray(end));
+      end = end < ndjson.length ? end + 1 : end;
+    } else {
+      end = ndjson.length;
+    }
+
+    chunks[numChunks++].input = ndjson.subarray(begin, end);
+    begin = end;
+  }
+  CHECK(numChunks <= UINT32_MAX);
+
+  if (pool == nullptr || numChunks <= 1) {
+    for (size_t i = 0; i < numChunks; i++) {
+      parseChunk(threadArenas[numThreads - 1], chunks[i], flags);
+    }
+  } else {
+    Params params = {threadArenas, chunks, flags};
+    KernelEntryPoint kernel = [](const Dispatch *D) {
+      const Params &P = D->parametersAs<Params>();
+      parseChunk(P.threadArenas[D->idxPhysicalThread],
+                 P.chunks[D->threadIndex.x], P.flags);
+    };
+
+    WorkContract *wc = pool->createWorkContract(temp, kernel, 0, 1);
+    pool->dispatch(wc, &params, u32(numChunks));
+    pool->release(wc);
+  }
+
+  // Gather the records in input order
+  MutSlice<size_t> offsets;
+  alloc(temp, numChunks, offsets);
+  size_t numRecords = 0;
+  for (size_t i = 0; i < numChunks; i++) {
+    if (!chunks[i].ok) {
+      return false;
+    }
+    offsets[i] = numRecords;
+    numRecords += chunks[i].numRecords;
+  }
+
+  JsonValue *records = allocNZ<JsonValue>(arena, numRecords);
+  impl::parallelTasks(pool, numChunks, [&](size_t i) {
+    if (chunks[i].numRecords != 0) {
+      memcpy(records + offsets[i], chunks[i].records,
+             chunks[i].numRecords * sizeof(JsonValue));
+    }
+  });
+
+  out = {records, numRecords};
+  return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "std/Arena.h"
+#include "std/Slice.hpp"
+#include "std/Types.h"
+#include "std/WorkerPool.hpp"
+#include "std/json/Value.hpp"
+
+/**
+ * \brief Parses newline-delimited JSON on a worker pool.
+ *
+ * The input is cut into chunks at line boundaries and every chunk is parsed by
+ * a single job. The records parsed by the physical thread `i` of the pool are
+ * allocated from `threadArenas[i]`, so the workers never share an arena.
+ * Workers need scratch allocators of their own (see
+ * `WorkerPoolCreateInfo::workerScratchSize` and `setAllocatorsForThread`).
+ *
+ * Like with `tryParseValue`, escape-free strings point into `ndjson` unless
+ * `JSON_PARSE_COPY_STRINGS` is passed.
+ *
+ * Passing a null pool parses the input on the calling thread into
+ * `threadArenas[0]`.
+ *
+ * \param arena Receives the array of the records
+ * \param threadArenas One arena for every physical thread of the pool, i.e.
+ * `numWorkerThreads() + 1`; the last one is used by the calling thread
+ * \param out Receives the records in input order; blank lines are skipped
+ * \param flags `JsonParseFlags`
+ * \param grainSize Number of bytes parsed by a single job, approximately. Pass
+ * 0 to split the input into a few chunks per thread.
+ * \returns false if any of the lines is not valid JSON
+ */
+bool tryParseNdjson(WorkerPool *pool,
+                    Arena *arena,
+                    Slice<Arena *> threadArenas,
+                    Slice<char> ndjson,
+                    Slice<JsonValue> &out,
+                    u32 flags = 0,
+                    size_t grainSize = 0);
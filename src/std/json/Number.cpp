@@ -0,0 +1,744 @@
+#include "std/json/Number.hpp"
+#include "std/json/Parser.hpp"
+
+#include <string.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static bool isDigit(char c) {
+  return '0' <= c && c <= '9';
+}
+
+static f64 f64FromBits(u64 bits) {
+  f64 ret;
+  memcpy(&ret, &bits, sizeof(ret));
+  return ret;
+}
+
+/** \brief Computes the full 128-bit product of `a` and `b` */
+static void multiply64(u64 a, u64 b, u64 &hi, u64 &lo) {
+#if defined(__SIZEOF_INT128__)
+  __uint128_t r = __uint128_t(a) * b;
+  hi = u64(r >> 64);
+  lo = u64(r);
+#elif defined(_MSC_VER) && defined(_M_X64)
+  lo = _umul128(a, b, &hi);
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+  hi = __umulh(a, b);
+  lo = a * b;
+#else
+  u64 ha = a >> 32, hb = b >> 32, la = u32(a), lb = u32(b);
+  u64 rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  u64 t = rl + (rm0 << 32);
+  u64 c = t < rl;
+  lo = t + (rm1 << 32);
+  c += lo < t;
+  hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+namespace impl {
+bool eiselLemire(u64 mantissa, i64 exp10, bool negative, f64 &out) {
+  const u64 SIGN = negative ? u64(1) << 63 : 0;
+  if (mantissa == 0) {
+    out = f64FromBits(SIGN);
+    return true;
+  }
+
+  if (exp10 < POWER_OF_TEN_MIN || POWER_OF_TEN_MAX < exp10) {
+    return false;
+  }
+
+  const u64 *pow10 = POWERS_OF_TEN[exp10 - POWER_OF_TEN_MIN];
+
+  // Normalize the mantissa; 217706 / 2^16 approximates log2(10)
+  i32 clz = countLeadingZeros64(mantissa);
+  mantissa <<= clz;
+  u64 exp2 = u64(((217706 * exp10) >> 16) + 64 + 1023) - u64(clz);
+
+  u64 xHi, xLo;
+  multiply64(mantissa, pow10[0], xHi, xLo);
+
+  // The truncated power of ten may have lost bits that matter; take the lower
+  // 64 bits of it into account, too
+  if ((xHi & 0x1FF) == 0x1FF && xLo + mantissa < mantissa) {
+    u64 yHi, yLo;
+    multiply64(mantissa, pow10[1], yHi, yLo);
+    u64 mergedHi = xHi;
+    u64 mergedLo = xLo + yHi;
+    if (mergedLo < xLo) {
+      mergedHi++;
+    }
+    if ((mergedHi & 0x1FF) == 0x1FF && mergedLo + 1 == 0 &&
+        yLo + mantissa < mantissa) {
+      return false;
+    }
+    xHi = mergedHi;
+    xLo = mergedLo;
+  }
+
+  // Shift to 54 bits
+  u64 msb = xHi >> 63;
+  u64 retMantissa = xHi >> (msb + 9);
+  exp2 -= 1 ^ msb;
+
+  // Exactly halfway between two doubles; can't tell which way to round
+  if (xLo == 0 && (xHi & 0x1FF) == 0 && (retMantissa & 3) == 1) {
+    return false;
+  }
+
+  // Round to 53 bits
+  retMantissa += retMantissa & 1;
+  retMantissa >>= 1;
+  if ((retMantissa >> 53) > 0) {
+    retMantissa >>= 1;
+    exp2 += 1;
+  }
+
+  // Subnormals and infinities are left to the slow path
+  if (exp2 - 1 >= 0x7FF - 1) {
+    return false;
+  }
+
+  out = f64FromBits(SIGN | (exp2 << 52) | (retMantissa & 0x000FFFFFFFFFFFFF));
+  return true;
+}
+}  // namespace impl
+
+namespace {
+/**
+ * \brief A decimal number with up to `MAX_DIGITS` significant digits that can
+ * be multiplied and divided by powers of two exactly.
+ *
+ * Used to convert the numbers the fast paths can't handle. The algorithm is
+ * the one of Go's strconv: the number is scaled into [0.5, 1) by powers of two,
+ * then the bits of the mantissa are shifted out.
+ */
+struct Decimal {
+  static constexpr i32 MAX_DIGITS = 800;
+  /** \brief Largest shift that can't overflow a u64 */
+  static constexpr u32 MAX_SHIFT = 60;
+
+  /** \brief Digits, most significant first; room for a left shift */
+  u8 digits[MAX_DIGITS + 32];
+  i32 numDigits = 0;
+  /** \brief The value is `0.digits * 10^decimalPoint` */
+  i32 decimalPoint = 0;
+  /** \brief Some nonzero digits were dropped after `MAX_DIGITS` */
+  bool truncated = false;
+
+  Decimal(Slice<char> intDigits, Slice<char> fracDigits, i64 exp10) {
+    for (auto [c, _] : intDigits) {
+      if (numDigits == 0 && c == '0') {
+        continue;
+      }
+      decimalPoint++;
+      _pushDigit(c);
+    }
+    for (auto [c, _] : fracDigits) {
+      if (numDigits == 0 && c == '0') {
+        decimalPoint--;
+        continue;
+      }
+      _pushDigit(c);
+    }
+    _trim();
+
+    // Far outside of the range of f64 either way
+    if (exp10 > 100000) {
+      exp10 = 100000;
+    } else if (exp10 < -100000) {
+      exp10 = -100000;
+    }
+    decimalPoint += i32(exp10);
+  }
+
+  void _pushDigit(char c) {
+    if (numDigits < MAX_DIGITS) {
+      digits[numDigits++] = u8(c - '0');
+    } else if (c != '0') {
+      truncated = true;
+    }
+  }
+
+  void _trim() {
+    while (numDigits > 0 && digits[numDigits - 1] == 0) {
+      numDigits--;
+    }
+    if (numDigits == 0) {
+      decimalPoint = 0;
+    }
+  }
+
+  /** \brief Multiplies the number by `2^k` */
+  void shift(i32 k) {
+    if (numDigits == 0) {
+      return;
+    }
+
+    for (; k > i32(MAX_SHIFT); k -= MAX_SHIFT) {
+      _shiftLeft(MAX_SHIFT);
+    }
+    for (; k < -i32(MAX_SHIFT); k += MAX_SHIFT) {
+      _shiftRight(MAX_SHIFT);
+    }
+
+    if (k > 0) {
+      _shiftLeft(u32(k));
+    } else if (k < 0) {
+      _shiftRight(u32(-k));
+    }
+  }
+
+  void _shiftLeft(u32 k) {
+    // At least as many as the number of digits the number grows by;
+    // 1233 / 2^12 approximates log10(2)
+    const i32 delta = i32((k * 1233) >> 12) + 2;
+
+    // Digits are written right to left, ahead of the ones being read
+    i32 w = numDigits + delta;
+    u64 n = 0;
+    for (i32 r = numDigits - 1; r >= 0; r--) {
+      n += u64(digits[r]) << k;
+      u64 quo = n / 10;
+      digits[--w] = u8(n - 10 * quo);
+      n = quo;
+    }
+    while (n > 0) {
+      u64 quo = n / 10;
+      digits[--w] = u8(n - 10 * quo);
+      n = quo;
+    }
+
+    // The first `w` digits are stale
+    numDigits = numDigits + delta - w;
+    decimalPoint += delta - w;
+    memmove(digits, digits + w, size_t(numDigits));
+
+    if (numDigits > MAX_DIGITS) {
+      for (i32 i = MAX_DIGITS; i < numDigits; i++) {
+        truncated |= digits[i] != 0;
+      }
+      numDigits = MAX_DIGITS;
+    }
+    _trim();
+  }
+
+  void _shiftRight(u32 k) {
+    i32 r = 0;
+    i32 w = 0;
+    u64 n = 0;
+
+    // Read enough digits for the first digit of the result
+    for (; (n >> k) == 0; r++) {
+      if (r >= numDigits) {
+        if (n == 0) {
+          numDigits = 0;
+          return;
+        }
+        while ((n >> k) == 0) {
+          n *= 10;
+          r++;
+        }
+        break;
+      }
+      n = n * 10 + digits[r];
+    }
+    decimalPoint -= r - 1;
+
+    const u64 mask = (u64(1) << k) - 1;
+    for (; r < numDigits; r++) {
+      u8 c = digits[r];
+      digits[w++] = u8(n >> k);
+      n = (n & mask) * 10 + c;
+    }
+    while (n > 0) {
+      u8 digit = u8(n >> k);
+      n = (n & mask) * 10;
+      if (w < MAX_DIGITS) {
+        digits[w++] = digit;
+      } else if (digit > 0) {
+        truncated = true;
+      }
+    }
+
+    numDigits = w;
+    _trim();
+  }
+
+  /** \brief Rounds the number to an integer, ties to even */
+  u64 roundedInteger() const {
+    if (decimalPoint > 20) {
+      return ~u64(0);
+    }
+
+    u64 n = 0;
+    i32 i = 0;
+    for (; i < decimalPoint && i < numDigits; i++) {
+      n = n * 10 + digits[i];
+    }
+    for (; i < decimalPoint; i++) {
+      n *= 10;
+    }
+
+    if (_shouldRoundUp(decimalPoint)) {
+      n++;
+    }
+    return n;
+  }
+
+  bool _shouldRoundUp(i32 idxDigit) const {
+    if (idxDigit < 0 || idxDigit >= numDigits) {
+      return false;
+    }
+
+    if (digits[idxDigit] == 5 && idxDigit + 1 == numDigits) {
+      // Exactly halfway, unless digits were dropped
+      if (truncated) {
+        return true;
+      }
+      return idxDigit > 0 && digits[idxDigit - 1] % 2 == 1;
+    }
+
+    return digits[idxDigit] >= 5;
+  }
+
+  /** \brief Converts the number to the nearest f64; destroys the number */
+  f64 toF64(bool negative) {
+    const u64 SIGN = negative ? u64(1) << 63 : 0;
+    const u64 INF = u64(0x7FF) << 52;
+    const i32 BIAS = -1023;
+
+    if (numDigits == 0 || decimalPoint < -330) {
+      return f64FromBits(SIGN);
+    }
+    if (decimalPoint > 310) {
+      return f64FromBits(SIGN | INF);
+    }
+
+    // Number of bits needed to represent 10^i
+    static const u8 POWERS_OF_TWO[] = {1, 3, 6, 9, 13, 16, 19, 23, 26};
+    const i32 NUM_POWERS = i32(sizeof(POWERS_OF_TWO));
+
+    // Scale into [0.5, 1)
+    i32 exp2 = 0;
+    while (decimalPoint > 0) {
+      i32 n = decimalPoint >= NUM_POWERS ? 27 : POWERS_OF_TWO[decimalPoint];
+      shift(-n);
+      exp2 += n;
+    }
+    while (decimalPoint < 0 || (decimalPoint == 0 && digits[0] < 5)) {
+      i32 n = -decimalPoint >= NUM_POWERS ? 27 : POWERS_OF_TWO[-decimalPoint];
+      shift(n);
+      exp2 -= n;
+    }
+
+    // From [0.5, 1) to [1, 2)
+    exp2--;
+
+    // Subnormal; denormalize the mantissa
+    if (exp2 < BIAS + 1) {
+      i32 n = BIAS + 1 - exp2;
+      shift(-n);
+      exp2 += n;
+    }
+
+    if (exp2 - BIAS >= 0x7FF) {
+      return f64FromBits(SIGN | INF);
+    }
+
+    // 1 implicit bit and 52 explicit ones
+    shift(53);
+    u64 mantissa = roundedInteger();
+
+    // Rounding may have carried into a new bit
+    if (mantissa == u64(2) << 52) {
+      mantissa >>= 1;
+      exp2++;
+      if (exp2 - BIAS >= 0x7FF) {
+        return f64FromBits(SIGN | INF);
+      }
+    }
+
+    if ((mantissa & (u64(1) << 52)) == 0) {
+      exp2 = BIAS;
+    }
+
+    u64 bits = mantissa & ((u64(1) << 52) - 1);
+    bits |= u64((exp2 - BIAS) & 0x7FF) << 52;
+    return f64FromBits(SIGN | bits);
+  }
+};
+}  // namespace
+
+/** \brief Exactly representable powers of ten */
+static const f64 EXACT_POWERS_OF_TEN[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static f64 parseF64(bool negative,
+                    Slice<char> intDigits,
+                    Slice<char> fracDigits,
+                    i64 exp10Explicit) {
+  // The first 19 significant digits always fit into a u64
+  const i32 MAX_MANTISSA_DIGITS = 19;
+  u64 mantissa = 0;
+  i32 numSignificant = 0;
+  i64 exp10 = exp10Explicit;
+  bool truncated = false;
+
+  for (auto [c, _] : intDigits) {
+    if (numSignificant < MAX_MANTISSA_DIGITS) {
+      mantissa = mantissa * 10 + u64(c - '0');
+      numSignificant += mantissa != 0;
+    } else {
+      exp10++;
+      truncated |= c != '0';
+    }
+  }
+  for (auto [c, _] : fracDigits) {
+    if (numSignificant < MAX_MANTISSA_DIGITS) {
+      mantissa = mantissa * 10 + u64(c - '0');
+      numSignificant += mantissa != 0;
+      exp10--;
+    } else {
+      truncated |= c != '0';
+    }
+  }
+
+  // Clinger's fast path: both operands are exact, so is the result
+  if (!truncated && mantissa <= (u64(1) << 53) && -22 <= exp10 &&
+      exp10 <= 22) {
+    f64 value = f64(mantissa);
+    if (exp10 < 0) {
+      value /= EXACT_POWERS_OF_TEN[-exp10];
+    } else {
+      value *= EXACT_POWERS_OF_TEN[exp10];
+    }
+    return negative ? -value : value;
+  }
+
+  f64 value;
+  if (impl::eiselLemire(mantissa, exp10, negative, value)) {
+    if (!truncated) {
+      return value;
+    }
+
+    // The exact value lies between the two; if they round to the same
+    // number, so does the exact value
+    f64 upper;
+    if (impl::eiselLemire(mantissa + 1, exp10, negative, upper) &&
+        value == upper) {
+      return value;
+    }
+  }
+
+  Decimal decimal(intDigits, fracDigits, exp10Explicit);
+  return decimal.toF64(negative);
+}
+
+/**
+ * \brief Converts the digits to an integer if it fits into an i64 or u64.
+ */
+static bool tryParseInteger(bool negative,
+                            Slice<char> digits,
+                            JsonValue &out) {
+  u64 value = 0;
+  for (auto [c, _] : digits) {
+    u64 digit = u64(c - '0');
+    if (value > (~u64(0) - digit) / 10) {
+      return false;
+    }
+    value = value * 10 + digit;
+  }
+
+  const u64 I64_MAX = ~u64(0) >> 1;
+  if (negative) {
+    if (value == 0 || value > I64_MAX + 1) {
+      // -0 can only be represented as a float
+      return false;
+    }
+    out.type = JsonType::Integer;
+    out.integer = i64(~value + 1);
+  } else if (value <= I64_MAX) {
+    out.type = JsonType::Integer;
+    out.integer = i64(value);
+  } else {
+    out.type = JsonType::UnsignedInteger;
+    out.uinteger = value;
+  }
+  return true;
+}
+
+bool tryParseJsonNumber(Slice<char> json,
+                        u32 flags,
+                        JsonValue &out,
+                        size_t &length) {
+  size_t i = 0;
+
+  bool negative = false;
+  if (i < json.length && json[i] == '-') {
+    negative = true;
+    i++;
+  }
+
+  // Integer part; no leading zeros
+  const size_t idxInt = i;
+  if (i >= json.length || !isDigit(json[i])) {
+    return false;
+  }
+  if (json[i] == '0') {
+    i++;
+  } else {
+    while (i < json.length && isDigit(json[i])) {
+      i++;
+    }
+  }
+  Slice<char> intDigits = json.subarray(idxInt, i);
+
+  // Fraction
+  Slice<char> fracDigits;
+  if (i < json.length && json[i] == '.') {
+    i++;
+    const size_t idxFrac = i;
+    while (i < json.length && isDigit(json[i])) {
+      i++;
+    }
+    if (i == idxFrac) {
+      return false;
+    }
+    fracDigits = json.subarray(idxFrac, i);
+  }
+
+  // Exponent
+  bool hasExponent = false;
+  i64 exp10 = 0;
+  if (i < json.length && (json[i] == 'e' || json[i] == 'E')) {
+    hasExponent = true;
+    i++;
+
+    bool negativeExponent = false;
+    if (i < json.length && (json[i] == '+' || json[i] == '-')) {
+      negativeExponent = json[i] == '-';
+      i++;
+    }
+
+    if (i >= json.length || !isDigit(json[i])) {
+      return false;
+    }
+    while (i < json.length && isDigit(json[i])) {
+      // Saturate; anything this large is infinity or zero anyway
+      if (exp10 < 1000000) {
+        exp10 = exp10 * 10 + (json[i] - '0');
+      }
+      i++;
+    }
+
+    if (negativeExponent) {
+      exp10 = -exp10;
+    }
+  }
+
+  length = i;
+
+  if ((flags & JSON_PARSE_INTEGERS) && fracDigits.empty() && !hasExponent &&
+      tryParseInteger(negative, intDigits, out)) {
+    return true;
+  }
+
+  out.type = JsonType::Number;
+  out.number = parseF64(negative, intDigits, fracDigits, exp10);
+  return true;
+}
+
+/**
+ * \brief Computes the 64 most significant bits of `g * cp` and sets the lowest
+ * bit if any of the discarded bits were set.
+ */
+static u64 roundToOdd(u64 gHi, u64 gLo, u64 cp) {
+  u64 xHi, xLo;
+  multiply64(gLo, cp, xHi, xLo);
+  u64 yHi, yLo;
+  multiply64(gHi, cp, yHi, yLo);
+  yLo += xHi;
+  yHi += yLo < xHi;
+  return yHi | (yLo > 1);
+}
+
+namespace impl {
+void shortestDecimal(u64 ieeeMantissa,
+                     u32 ieeeExponent,
+                     u64 &digits,
+                     i32 &exp10) {
+  // The value is `c * 2^q`
+  u64 c;
+  i32 q;
+  if (ieeeExponent != 0) {
+    c = (u64(1) << 52) | ieeeMantissa;
+    q = i32(ieeeExponent) - 1075;
+
+    // Small integers
+    if (-52 <= q && q <= 0 && (c & ((u64(1) << -q) - 1)) == 0) {
+      digits = c >> -q;
+      exp10 = 0;
+      return;
+    }
+  } else {
+    c = ieeeMantissa;
+    q = 1 - 1075;
+  }
+
+  // Schubfach; the rounding interval is `[cbl, cbr] * 2^(q - 2)`, its ends are
+  // included if `c` is even
+  const bool isEven = (c & 1) == 0;
+  const bool lowerBoundaryIsCloser = ieeeMantissa == 0 && ieeeExponent > 1;
+  const u64 cbl = 4 * c - 2 + lowerBoundaryIsCloser;
+  const u64 cb = 4 * c;
+  const u64 cbr = 4 * c + 2;
+
+  // floor(log10(2^q)), or floor(log10(3/4 * 2^q)) when the interval is
+  // asymmetric
+  const i32 k = (q * 1262611 - (lowerBoundaryIsCloser ? 524031 : 0)) >> 22;
+  // 10^-k * 2^(q + h) is in [2^127, 2^128); h is in [1, 4]
+  const i32 h = q + ((-k * 1741647) >> 19) + 1;
+
+  // The power of ten, rounded up
+  const u64 *pow10 = POWERS_OF_TEN[-k - POWER_OF_TEN_MIN];
+  const u64 gLo = pow10[1] + 1;
+  const u64 gHi = pow10[0] + (gLo == 0);
+
+  const u64 vbl = roundToOdd(gHi, gLo, cbl << h);
+  const u64 vb = roundToOdd(gHi, gLo, cb << h);
+  const u64 vbr = roundToOdd(gHi, gLo, cbr << h);
+  const u64 lower = vbl + !isEven;
+  const u64 upper = vbr - !isEven;
+
+  const u64 s = vb / 4;
+  if (s >= 10) {
+    // Try one digit less
+    const u64 sp = s / 10;
+    const bool upInside = lower <= 40 * sp;
+    const bool wpInside = 40 * sp + 40 <= upper;
+    if (upInside != wpInside) {
+      digits = sp + wpInside;
+      exp10 = k + 1;
+      return;
+    }
+  }
+
+  const bool uInside = lower <= 4 * s;
+  const bool wInside = 4 * s + 4 <= upper;
+  if (uInside != wInside) {
+    digits = s + wInside;
+    exp10 = k;
+    return;
+  }
+
+  // Both neighbours are inside; pick the closer one, ties to even
+  const u64 mid = 4 * s + 2;
+  const bool roundUp = vb > mid || (vb == mid && (s & 1) != 0);
+  digits = s + roundUp;
+  exp10 = k;
+}
+}  // namespace impl
+
+/** \brief Writes the decimal digits of `value`; returns their count */
+static size_t writeDigits(char *dst, u64 value) {
+  char buf[20];
+  size_t length = 0;
+  do {
+    buf[sizeof(buf) - 1 - length++] = char('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+
+  memcpy(dst, buf + sizeof(buf) - length, length);
+  return length;
+}
+
+size_t formatJsonNumber(char *dst, f64 value) {
+  u64 bits;
+  memcpy(&bits, &value, sizeof(bits));
+  const u64 ieeeMantissa = bits & ((u64(1) << 52) - 1);
+  const u32 ieeeExponent = u32(bits >> 52) & 0x7FF;
+
+  if (ieeeExponent == 0x7FF) {
+    memcpy(dst, "null", 4);
+    return 4;
+  }
+
+  size_t length = 0;
+  if (bits >> 63) {
+    dst[length++] = '-';
+  }
+
+  if (ieeeExponent == 0 && ieeeMantissa == 0) {
+    dst[length++] = '0';
+    return length;
+  }
+
+  u64 digits;
+  i32 exp10;
+  impl::shortestDecimal(ieeeMantissa, ieeeExponent, digits, exp10);
+  while (digits % 10 == 0) {
+    digits /= 10;
+    exp10++;
+  }
+
+  char buf[20];
+  const i32 n = i32(writeDigits(buf, digits));
+  // Position of the decimal point relative to the first digit
+  const i32 point = n + exp10;
+
+  if (n <= point && point <= 21) {
+    // Integer
+    memcpy(dst + length, buf, n);
+    memset(dst + length + n, '0', point - n);
+    return length + point;
+  }
+
+  if (0 < point && point <= 21) {
+    memcpy(dst + length, buf, point);
+    dst[length + point] = '.';
+    memcpy(dst + length + point + 1, buf + point, n - point);
+    return length + n + 1;
+  }
+
+  if (-6 < point && point <= 0) {
+    dst[length++] = '0';
+    dst[length++] = '.';
+    memset(dst + length, '0', -point);
+    length += -point;
+    memcpy(dst + length, buf, n);
+    return length + n;
+  }
+
+  dst[length++] = buf[0];
+  if (n > 1) {
+    dst[length++] = '.';
+    memcpy(dst + length, buf + 1, n - 1);
+    length += n - 1;
+  }
+  dst[length++] = 'e';
+  const i32 exponent = point - 1;
+  dst[length++] = exponent < 0 ? '-' : '+';
+  length +=
+      writeDigits(dst + length, u64(exponent < 0 ? -exponent : exponent));
+  return length;
+}
+
+size_t formatJsonInteger(char *dst, i64 value) {
+  if (value < 0) {
+    dst[0] = '-';
+    // Negate in unsigned arithmetic, INT64_MIN has no positive counterpart
+    return 1 + writeDigits(dst + 1, u64(0) - u64(value));
+  }
+
+  return writeDigits(dst, u64(value));
+}
+
+size_t formatJsonUnsignedInteger(char *dst, u64 value) {
+  return writeDigits(dst, value);
+}
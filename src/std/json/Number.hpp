@@ -0,0 +1,70 @@
+#pragma once
+
+#include "std/Slice.hpp"
+#include "std/Types.h"
+#include "std/json/Value.hpp"
+
+/**
+ * \brief Parses the JSON number at the front of `json`.
+ *
+ * Numbers are converted to the nearest f64, using the Clinger fast path or the
+ * Eisel-Lemire algorithm when possible and an exact big decimal otherwise.
+ *
+ * \param flags `JsonParseFlags`
+ * \param length Receives the number of bytes the number spans
+ * \returns A value indicating whether `json` starts with a valid number
+ */
+bool tryParseJsonNumber(Slice<char> json,
+                        u32 flags,
+                        JsonValue &out,
+                        size_t &length);
+
+/** \brief Upper bound on the number of bytes written by the `formatJson*`
+ * functions */
+static constexpr size_t JSON_NUMBER_MAX_LENGTH = 32;
+
+/**
+ * \brief Writes the shortest decimal representation of `value` that parses
+ * back to the same f64.
+ *
+ * The notation is the one of JavaScript's `Number.prototype.toString`: plain
+ * for decimal exponents in `[-7, 21)`, scientific otherwise. NaN and the
+ * infinities, which JSON can't represent, are written as `null`.
+ *
+ * \param dst Receives at most `JSON_NUMBER_MAX_LENGTH` bytes
+ * \returns The number of bytes written
+ */
+size_t formatJsonNumber(char *dst, f64 value);
+
+/**
+ * \brief Writes the decimal representation of an integer.
+ * \param dst Receives at most `JSON_NUMBER_MAX_LENGTH` bytes
+ * \returns The number of bytes written
+ */
+size_t formatJsonInteger(char *dst, i64 value);
+/** \copydoc formatJsonInteger */
+size_t formatJsonUnsignedInteger(char *dst, u64 value);
+
+namespace impl {
+static constexpr i32 POWER_OF_TEN_MIN = -348;
+static constexpr i32 POWER_OF_TEN_MAX = 347;
+/** \brief 128-bit mantissas of the powers of ten; see PowersOfTen.cpp */
+extern const u64 POWERS_OF_TEN[POWER_OF_TEN_MAX - POWER_OF_TEN_MIN + 1][2];
+
+/**
+ * \brief Converts `mantissa * 10^exp10` to the nearest f64 with the
+ * Eisel-Lemire algorithm.
+ * \returns false if the result can't be determined this way
+ */
+bool eiselLemire(u64 mantissa, i64 exp10, bool negative, f64 &out);
+
+/**
+ * \brief Finds the shortest `digits * 10^exp10` that rounds to the finite,
+ * non-zero f64 with the given fields, with the Schubfach algorithm. `digits`
+ * may have trailing zeros.
+ */
+void shortestDecimal(u64 ieeeMantissa,
+                     u32 ieeeExponent,
+                     u64 &digits,
+                     i32 &exp10);
+}  // namespace impl
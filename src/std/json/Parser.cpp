@@ -5,10 +5,11 @@
 #include "std/Types.h"
 #include "std/Vector.hpp"
 #include "std/VectorUtils.hpp"
+#include "std/json/Index.hpp"
+#include "std/json/Number.hpp"
+#include "std/json/Scanner.hpp"
 #include "std/json/Value.hpp"
 
-#include <cmath> // pow
-
 static constexpr Slice<char> NUL = sliceFromConstChar("null");
 static constexpr Slice<char> FALSE = sliceFromConstChar("false");
 static constexpr Slice<char> TRUE = sliceFromConstChar("true");
@@ -36,14 +37,6 @@ static bool isDigit(Slice<char> json) {
   return '0' <= json[0] && json[0] <= '9';
 }
 
-static bool isDigitExceptZero(Slice<char> json) {
-  if (json.empty()) {
-    return false;
-  }
-
-  return '1' <= json[0] && json[0] <= '9';
-}
-
 static bool isHex(Slice<char> json, u8 &out) {
   if (json.empty()) {
     return false;
@@ -88,134 +81,6 @@ struct Rollback {
   void disarm() { dst = nullptr; }
 };
 
-static bool tryParseNumber(Slice<char> &json, JsonValue &out) {
-  out.type = JsonType::Number;
-
-  if (json.empty()) {
-    return false;
-  }
-
-  Rollback rollback(json);
-
-  f64 sign = +1;
-
-  if (json[0] == '-') {
-    sign = -1;
-    json.shrinkFromLeft();
-  }
-
-  if (json.empty()) {
-    return false;
-  }
-
-  u64 whole = 0;
-  f64 fraction = 0.0;
-
-  if (json[0] == '0') {
-    whole = 0;
-    json.shrinkFromLeft();
-  } else if (isDigitExceptZero(json)) {
-    while (isDigit(json)) {
-      whole *= 10;
-      whole += (json[0] - '0');
-      json.shrinkFromLeft();
-    }
-
-    if (json.empty()) {
-      rollback.disarm();
-      return true;
-    }
-  } else {
-    return false;
-  }
-
-  if (json.empty()) {
-    out.number = sign * f64(whole);
-    rollback.disarm();
-    return true;
-  }
-
-  if (json[0] == '.') {
-    json.shrinkFromLeft();
-
-    bool seenOneDigit = false;
-
-    const f64 rcp10 = 1.0 / 10.0;
-    f64 rcpDivisor = rcp10;
-    while (isDigit(json)) {
-      fraction += (json[0] - '0') * rcpDivisor;
-      json.shrinkFromLeft();
-      rcpDivisor *= rcp10;
-
-      seenOneDigit = true;
-    }
-
-    if (!seenOneDigit) {
-      return false;
-    }
-  }
-
-  f64 combined = sign * (f64(whole) + fraction);
-  out.number = combined;
-
-  if (json.empty()) {
-    rollback.disarm();
-    return true;
-  }
-
-  if (json[0] == 'e' || json[0] == 'E') {
-    json.shrinkFromLeft();
-
-    if (json.empty()) {
-      return false;
-    }
-
-    i8 exponentSign = 1;
-    u32 exponent = 0;
-
-    if (json[0] == '+') {
-      json.shrinkFromLeft();
-    } else if (json[0] == '-') {
-      exponentSign = -1;
-      json.shrinkFromLeft();
-    }
-
-    if (json.empty() || !isDigit(json)) {
-      return false;
-    }
-
-    bool isInfinite = false;
-
-    while (isDigit(json)) {
-      if (exponent > 1024) {
-        isInfinite = true;
-        break;
-      }
-
-      exponent *= 10;
-      exponent += u32(json[0] - '0');
-      json.shrinkFromLeft();
-    }
-
-    if (isInfinite) {
-      while (isDigit(json)) {
-        json.shrinkFromLeft();
-      }
-
-      if (exponentSign == 1) {
-        out.number = sign * INFINITY;
-      } else {
-        out.number = sign * 0.0f;
-      }
-    } else {
-      out.number = combined * pow(10, exponentSign * exponent);
-    }
-  }
-
-  rollback.disarm();
-  return true;
-}
-
 static bool tryParseUnicodeCodepoint(Slice<char> &json, u32 &out) {
   if (json.length < 5 || json[0] != 'u') {
     return false;
@@ -291,331 +156,362 @@ static bool tryParseEscapedChar(Slice<char> &json, u32 &out) {
   return false;
 }
 
-static void encodeToUtf8(Arena *arena, Vector<char> *vec, u32 codepoint) {
-  auto pushByte = [arena, vec](u8 b) {
-    char tmp;
-    memcpy(&tmp, &b, 1);
-    appendVal(arena, vec, tmp);
-  };
+
+/**
+ * \brief Writes the UTF-8 encoding of the codepoint into `dst`.
+ * \returns The number of bytes written
+ */
+static size_t encodeToUtf8(char *dst, u32 codepoint) {
+  u8 bytes[4];
+  size_t length = 0;
 
   if (codepoint <= 0x7F) {
     // 1 byte: 0xxxxxxx
-    pushByte(u8(codepoint));
+    bytes[length++] = u8(codepoint);
   } else if (codepoint <= 0x7FF) {
     // 2 bytes: 110xxxxx 10xxxxxx
-    pushByte(0xC0 | u8(codepoint >> 6));
-    pushByte(0x80 | u8(codepoint & 0x3F));
+    bytes[length++] = 0xC0 | u8(codepoint >> 6);
+    bytes[length++] = 0x80 | u8(codepoint & 0x3F);
   } else if (codepoint <= 0xFFFF) {
     // 3 bytes: 1110xxxx 10xxxxxx 10xxxxxx
-    pushByte(0xE0 | u8(codepoint >> 12));
-    pushByte(0x80 | u8((codepoint >> 6) & 0x3F));
-    pushByte(0x80 | u8(codepoint & 0x3F));
+    bytes[length++] = 0xE0 | u8(codepoint >> 12);
+    bytes[length++] = 0x80 | u8((codepoint >> 6) & 0x3F);
+    bytes[length++] = 0x80 | u8(codepoint & 0x3F);
   } else if (codepoint <= 0x10FFFF) {
     // 4 bytes: 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx
-    pushByte(0xF0 | u8(codepoint >> 18));
-    pushByte(0x80 | u8((codepoint >> 12) & 0x3F));
-    pushByte(0x80 | u8((codepoint >> 6) & 0x3F));
-    pushByte(0x80 | u8(codepoint & 0x3F));
+    bytes[length++] = 0xF0 | u8(codepoint >> 18);
+    bytes[length++] = 0x80 | u8((codepoint >> 12) & 0x3F);
+    bytes[length++] = 0x80 | u8((codepoint >> 6) & 0x3F);
+    bytes[length++] = 0x80 | u8(codepoint & 0x3F);
   }
+
+  memcpy(dst, bytes, length);
+  return length;
 }
 
-static bool tryParseString(Arena *arena,
-                           Arena *tempArena,
-                           Slice<char> &json,
-                           JsonValue &out) {
-  Arena::Scope temp = tempArena;
+static bool isWhitespace(char c) {
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
 
-  if (json.empty() || json[0] != '"') {
-    return false;
-  }
+static bool isStructural(char c) {
+  return c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',';
+}
 
-  Rollback rollback(json);
+/**
+ * \brief Parses the string whose opening quote is at `json[pos]`.
+ *
+ * Strings without escape sequences point into `json` unless
+ * JSON_PARSE_COPY_STRINGS is set; the others are decoded into `arena`.
+ *
+ * \param end Receives the offset of the byte after the closing quote
+ */
+static bool tryParseString(Arena *arena,
+                           Slice<char> json,
+                           size_t pos,
+                           u32 flags,
+                           JsonValue &out,
+                           size_t &end) {
+  DCHECK(json[pos] == '"');
+  const size_t start = pos + 1;
 
   out.type = JsonType::String;
   out.length = 0;
   out.str = nullptr;
-  json.shrinkFromLeft();  // eat opening quotes
-
-  if (json.empty()) {
-    return false;
-  }
-
-  if (json[0] == '"') {
-    json.shrinkFromLeft();  // eat closing quotes
-    rollback.disarm();
-    return true;
-  }
 
-  Vector<char> vec;
-
-  while (!json.empty() && json[0] != '"') {
-    char ch = json[0];
-    switch (ch) {
-      case '\\': {
-        u32 codepoint;
-        if (!tryParseEscapedChar(json, codepoint)) {
-          return false;
-        }
-        encodeToUtf8(temp, &vec, codepoint);
-        break;
-      }
-      default: {
-        if (0x0000 <= ch && ch <= 0x001F) {
-          // Unescaped control characters, which according to RFC7159 are: "the
-          // control characters (U+0000 through U+001F)."
-          return false;
-        }
-        appendVal(temp, &vec, ch);
-        json.shrinkFromLeft();
-        break;
-      }
+  size_t i = start + jsonFindStringSpecial(json.subarray(start));
+  bool hasEscapes = false;
+  while (i < json.length && json[i] == '\\') {
+    // Skip the escaped character; it's validated while decoding
+    hasEscapes = true;
+    i += 2;
+    if (i >= json.length) {
+      return false;
     }
+    i += jsonFindStringSpecial(json.subarray(i));
   }
 
-  if (json.empty()) {
+  if (i >= json.length || json[i] != '"') {
+    // Unterminated string or unescaped control character, which according to
+    // RFC7159 are: "the control characters (U+0000 through U+001F)."
     return false;
   }
+  end = i + 1;
 
-  json.shrinkFromLeft();  // eat closing quotes
-
-  Slice<char> contents = copyToSlice(arena, vec);
-  out.length = contents.length;
-  out.str = contents.data;
-
-  rollback.disarm();
-  return true;
-}
-
-bool tryParseValue(Arena *arena,
-                   Arena *tempArena,
-                   Slice<char> &json,
-                   JsonValue &out);
-
-static bool tryParseArray(Arena *arena,
-                          Arena *tempArena,
-                          Slice<char> &json,
-                          JsonValue &out) {
-  if (json.empty() || json[0] != '[') {
-    return false;
+  if (i == start) {
+    return true;
   }
 
-  Rollback rollback(json);
-  json.shrinkFromLeft();  // eat [
-
-  out.type = JsonType::Array;
-  out.length = 0;
-  out.arr = nullptr;
-
-  eatWhitespace(json);
-  if (json.empty()) {
-    return false;
+  Slice<char> src = json.subarray(start, i);
+  if (!hasEscapes && !(flags & JSON_PARSE_COPY_STRINGS)) {
+    out.str = src.data;
+    out.length = src.length;
+    return true;
   }
 
-  if (json[0] == ']') {
-    json.shrinkFromLeft();  // eat ]
-    rollback.disarm();
+  // The decoded string is never longer than its source
+  char *dst = allocNZ<char>(arena, src.length);
+  if (!hasEscapes) {
+    memcpy(dst, src.data, src.length);
+    out.str = dst;
+    out.length = src.length;
     return true;
   }
 
-  Arena::Scope temp = tempArena;
-  Vector<JsonValue> values;
-
-  bool sawComma = false;
-
-  while (!json.empty() && json[0] != ']') {
-    sawComma = false;
-    JsonValue *pValue = append(temp, &values);
-    if (!tryParseValue(arena, tempArena, json, *pValue)) {
-      return false;
-    }
-
-    if (json.empty()) {
-      return false;
-    }
-
-    eatWhitespace(json);
-
-    if (json[0] == ']') {
+  size_t length = 0;
+  while (!src.empty()) {
+    Optional<size_t> idxBackslash = src.indexOf('\\');
+    size_t run = idxBackslash.hasValue() ? idxBackslash.value() : src.length;
+    memcpy(dst + length, src.data, run);
+    length += run;
+    if (run == src.length) {
       break;
     }
+    src.shrinkFromLeftByCount(run);
 
-    if (json[0] != ',') {
+    u32 codepoint;
+    if (!tryParseEscapedChar(src, codepoint)) {
       return false;
     }
-
-    json.shrinkFromLeft();  // eat comma
-    sawComma = true;
-  }
-
-  if (sawComma) {
-    return false;
+    length += encodeToUtf8(dst + length, codepoint);
   }
 
-  json.shrinkFromLeft();  // eat ]
-
-  MutSlice<JsonValue> contents = copyToSlice(arena, values);
-  out.length = contents.length;
-  out.arr = contents.data;
-
-  rollback.disarm();
+  out.str = dst;
+  out.length = length;
   return true;
 }
 
-static bool tryParseObject(Arena *arena,
-                           Arena *tempArena,
-                           Slice<char> &json,
-                           JsonValue &out) {
-  if (json.empty() || json[0] != '{') {
-    return false;
+bool impl::tryParseJsonScalar(Arena *arena,
+                              Slice<char> json,
+                              size_t pos,
+                              u32 flags,
+                              JsonValue &out,
+                              size_t &end) {
+  switch (json[pos]) {
+    case '"':
+      return tryParseString(arena, json, pos, flags, out, end);
+    case 'n':
+      if (!compareAsString(json.subarray(pos, pos + NUL.length), NUL)) {
+        return false;
+      }
+      out.type = JsonType::Null;
+      end = pos + NUL.length;
+      break;
+    case 'f':
+      if (!compareAsString(json.subarray(pos, pos + FALSE.length), FALSE)) {
+        return false;
+      }
+      out.type = JsonType::False;
+      end = pos + FALSE.length;
+      break;
+    case 't':
+      if (!compareAsString(json.subarray(pos, pos + TRUE.length), TRUE)) {
+        return false;
+      }
+      out.type = JsonType::True;
+      end = pos + TRUE.length;
+      break;
+    default: {
+      size_t length;
+      if (!tryParseJsonNumber(json.subarray(pos), flags, out, length)) {
+        return false;
+      }
+      end = pos + length;
+      break;
+    }
   }
 
-  Rollback rollback(json);
+  // The scanner reports only the first character of a scalar; make sure that
+  // the whole run was consumed
+  return end == json.length || isWhitespace(json[end]) ||
+         isStructural(json[end]);
+}
 
-  json.shrinkFromLeft();
-  out.type = JsonType::Object;
-  out.length = 0;
-  out.kv = nullptr;
+namespace {
+/** \brief An array or object that is still being parsed */
+struct Frame {
+  /** \brief Index of the slot that receives the container */
+  size_t idxSlot;
+  JsonType type;
+};
 
-  eatWhitespace(json);
+/**
+ * \brief Stage 2 of the JSON parser: builds the tree from the tokens found by
+ * the `JsonScanner`.
+ *
+ * Nesting is tracked on an explicit stack instead of recursion. The elements
+ * of every open container are kept on a single stack in the temp arena and
+ * they're copied into the output arena when the container is closed.
+ */
+struct TreeBuilder {
+  Arena *arena;
+  Arena *temp;
+  Slice<char> json;
+  u32 flags;
+  JsonScanner scanner;
+
+  /** \brief Elements of the open containers; keys are unused in arrays */
+  Vector<JsonKeyValue> slots;
+  Vector<Frame> frames;
+
+  TreeBuilder(Arena *arena, Arena *temp, Slice<char> json, u32 flags)
+      : arena(arena), temp(temp), json(json), flags(flags), scanner(json) {}
+
+  /**
+   * \brief Parses a single value.
+   * \param end Receives the offset of the byte after the value
+   */
+  bool parse(JsonValue &out, size_t &end) {
+    appendVal(temp, &slots, {});
+
+    size_t pos;
+    if (!scanner.next(pos)) {
+      return false;
+    }
 
-  if (json.empty()) {
-    return false;
-  }
+    while (true) {
+      // `pos` is the first token of the value of the topmost slot
+      JsonValue &value = slots[slots.length - 1].value;
+      if (json[pos] == '[' || json[pos] == '{') {
+        value.type = json[pos] == '[' ? JsonType::Array : JsonType::Object;
+        value.length = 0;
+        value.arr = nullptr;
+        appendVal(temp, &frames, {slots.length - 1, value.type});
 
-  if (json[0] == '}') {
-    json.shrinkFromLeft();
-    rollback.disarm();
-    return true;
-  }
+        if (!scanner.next(pos)) {
+          return false;
+        }
 
-  Arena::Scope temp = tempArena;
-  Vector<JsonKeyValue> entries;
-  bool sawComma = false;
+        if (json[pos] != _closingOf(value.type)) {
+          if (!_beginElement(pos)) {
+            return false;
+          }
+          continue;
+        }
 
-  while (!json.empty() && json[0] != '}') {
-    sawComma = false;
-    eatWhitespace(json);
+        // Empty container
+        frames.length -= 1;
+        end = pos + 1;
+      } else if (!impl::tryParseJsonScalar(arena, json, pos, flags, value,
+                                           end)) {
+        return false;
+      }
 
-    JsonKeyValue *kv = append(temp, &entries);
-    JsonValue key = {};
+      // The value is complete, and so may be the containers around it
+      while (true) {
+        if (frames.length == 0) {
+          out = slots[0].value;
+          return true;
+        }
 
-    if (!tryParseString(arena, tempArena, json, key)) {
-      return false;
-    }
+        if (!scanner.next(pos)) {
+          return false;
+        }
 
-    DCHECK(key.type == JsonType::String);
-    kv->key = key.string();
+        const Frame frame = frames[frames.length - 1];
+        if (json[pos] == ',') {
+          if (!scanner.next(pos) || !_beginElement(pos)) {
+            return false;
+          }
+          break;
+        }
 
-    eatWhitespace(json);
+        if (json[pos] != _closingOf(frame.type)) {
+          return false;
+        }
 
-    if (json.empty() || json[0] != ':') {
-      return false;
+        _close(frame);
+        end = pos + 1;
+      }
     }
+  }
 
-    json.shrinkFromLeft();
-    eatWhitespace(json);
+  static char _closingOf(JsonType type) {
+    return type == JsonType::Array ? ']' : '}';
+  }
 
-    if (!tryParseValue(arena, tempArena, json, kv->value)) {
-      return false;
+  /**
+   * \brief Pushes a slot for the next element of the topmost container. In
+   * objects the key and the colon are parsed, too.
+   * \param pos First token of the element; receives the first token of the
+   * value in objects
+   */
+  bool _beginElement(size_t &pos) {
+    JsonKeyValue *slot = appendVal(temp, &slots, {});
+    if (frames[frames.length - 1].type == JsonType::Array) {
+      return true;
     }
 
-    if (json.empty()) {
+    JsonValue key = {};
+    size_t end;
+    if (json[pos] != '"' || !tryParseString(arena, json, pos, flags, key, end)) {
       return false;
     }
+    slot->key = key.string();
 
-    eatWhitespace(json);
-
-    if (json[0] == '}') {
-      break;
-    }
-
-    if (json[0] != ',') {
+    if (!scanner.next(pos) || json[pos] != ':') {
       return false;
     }
 
-    json.shrinkFromLeft();  // eat comma
-    sawComma = true;
-  }
-
-  if (sawComma) {
-    return false;
-  }
-
-  if (json.empty()) {
-    return false;
+    return scanner.next(pos);
   }
 
-  json.shrinkFromLeft();  // eat }
+  /** \brief Moves the elements of the container into the output arena */
+  void _close(const Frame &frame) {
+    const size_t idxFirst = frame.idxSlot + 1;
+    const size_t count = slots.length - idxFirst;
+    JsonValue &value = slots[frame.idxSlot].value;
 
-  MutSlice<JsonKeyValue> contents = copyToSlice(arena, entries);
-  out.length = contents.length;
-  out.kv = contents.data;
+    value.length = count;
+    if (frame.type == JsonType::Array) {
+      value.arr = allocNZ<JsonValue>(arena, count);
+      for (size_t i = 0; i < count; i++) {
+        value.arr[i] = slots[idxFirst + i].value;
+      }
+    } else if ((flags & JSON_PARSE_INDEX_OBJECTS) &&
+               count >= JSON_INDEX_MIN_KEYS &&
+               count <= impl::JSON_INDEX_MAX_KEYS) {
+      value.kv = impl::allocIndexedObject(arena, count);
+      copyElements(value.kv, &slots[idxFirst], count);
+      impl::buildJsonIndex(value);
+    } else {
+      value.kv = allocNZ<JsonKeyValue>(arena, count);
+      copyElements(value.kv, &slots[idxFirst], count);
+    }
 
-  rollback.disarm();
-  return true;
-}
+    slots.length = idxFirst;
+    frames.length -= 1;
+  }
+};
+}  // namespace
 
 bool tryParseValue(Arena *arena,
                    Arena *tempArena,
                    Slice<char> &json,
-                   JsonValue &out) {
+                   JsonValue &out,
+                   u32 flags) {
   if (json.empty()) {
     return false;
   }
 
-  Slice<char> saved = json;
-  eatWhitespace(json);
-
-  if (tryParseNumber(json, out)) {
-    return true;
-  }
-
-  if (compareAsString(json.subarray(0, 4), NUL)) {
-    out.type = JsonType::Null;
-
-    json.shrinkFromLeftByCount(NUL.length);
-    eatWhitespace(json);
-    return true;
-  }
-
-  if (compareAsString(json.subarray(0, 5), FALSE)) {
-    out.type = JsonType::False;
-
-    json.shrinkFromLeftByCount(FALSE.length);
-    eatWhitespace(json);
-    return true;
-  }
-
-  if (compareAsString(json.subarray(0, 4), TRUE)) {
-    out.type = JsonType::True;
-
-    json.shrinkFromLeftByCount(TRUE.length);
-    eatWhitespace(json);
-    return true;
-  }
-
-  if (tryParseString(arena, tempArena, json, out)) {
-    eatWhitespace(json);
-    return true;
-  }
-
-  if (tryParseObject(arena, tempArena, json, out)) {
-    eatWhitespace(json);
-    return true;
-  }
+  Arena::Scope temp = tempArena;
+  TreeBuilder builder(arena, temp, json, flags);
 
-  if (tryParseArray(arena, tempArena, json, out)) {
-    eatWhitespace(json);
-    return true;
+  size_t end;
+  if (!builder.parse(out, end)) {
+    return false;
   }
 
-  json = saved;
-  return false;
+  json.shrinkFromLeftByCount(end);
+  eatWhitespace(json);
+  return true;
 }
 
-bool tryParseValue(Arena *arena, Slice<char> &json, JsonValue &out) {
+bool tryParseValue(Arena *arena,
+                   Slice<char> &json,
+                   JsonValue &out,
+                   u32 flags) {
   Arena::Scope temp = getScratch(&arena, 1);
-  bool accepted = tryParseValue(arena, temp, json, out);
+  bool accepted = tryParseValue(arena, temp, json, out, flags);
 
   eatWhitespace(json);
   if (!json.empty()) {
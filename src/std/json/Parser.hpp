@@ -4,8 +4,47 @@
 #include "std/Slice.hpp"
 #include "std/json/Value.hpp"
 
+enum JsonParseFlags : u32 {
+  /**
+   * Integers that fit into an i64 or a u64 are stored exactly, as
+   * `JsonType::Integer` or `JsonType::UnsignedInteger`, instead of being
+   * converted to f64.
+   */
+  JSON_PARSE_INTEGERS = 1 << 0,
+  /**
+   * Strings and keys are always copied into the output arena. Without this
+   * flag, those that contain no escape sequences point into the input, which
+   * then has to outlive the parsed value.
+   */
+  JSON_PARSE_COPY_STRINGS = 1 << 1,
+  /**
+   * Objects with at least `JSON_INDEX_MIN_KEYS` keys get a hash index for
+   * `getKeyValue`; see `indexJsonObjects`.
+   */
+  JSON_PARSE_INDEX_OBJECTS = 1 << 2,
+};
+
 bool tryParseValue(Arena *arena,
                    Arena *tempArena,
                    Slice<char> &json,
-                   JsonValue &out);
-bool tryParseValue(Arena *arena, Slice<char> &json, JsonValue &out);
+                   JsonValue &out,
+                   u32 flags = 0);
+bool tryParseValue(Arena *arena,
+                   Slice<char> &json,
+                   JsonValue &out,
+                   u32 flags = 0);
+
+namespace impl {
+/**
+ * \brief Parses the number, string or literal that begins at `json[pos]`. The
+ * value has to be followed by whitespace, a structural character or the end of
+ * `json`.
+ * \param end Receives the offset of the byte after the value
+ */
+bool tryParseJsonScalar(Arena *arena,
+                        Slice<char> json,
+                        size_t pos,
+                        u32 flags,
+                        JsonValue &out,
+                        size_t &end);
+}  // namespace impl
@@ -0,0 +1,281 @@
+#include "std/json/Scanner.hpp"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace {
+/** \brief Bit `i` of every mask describes byte `i` of a block */
+struct BlockMasks {
+  u64 quote;
+  u64 backslash;
+  u64 structural;
+  u64 whitespace;
+};
+
+#if !(defined(__SSE2__) || defined(_M_X64)) && \
+    !(defined(__ARM_NEON) && defined(__aarch64__))
+static bool isStructural(u8 c) {
+  return c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',';
+}
+
+static bool isWhitespace(u8 c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+#endif
+
+static bool isStringSpecial(u8 c) {
+  return c == '"' || c == '\\' || c < 0x20;
+}
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+static u32 movemask16(uint8x16_t v) {
+  static const u8 bitOfLane[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                   1, 2, 4, 8, 16, 32, 64, 128};
+  uint8x16_t bits = vandq_u8(v, vld1q_u8(bitOfLane));
+  return u32(vaddv_u8(vget_low_u8(bits))) |
+         (u32(vaddv_u8(vget_high_u8(bits))) << 8);
+}
+#endif
+
+static BlockMasks classifyBlock(const char *block) {
+  BlockMasks ret = {};
+#if defined(__SSE2__) || defined(_M_X64)
+  for (u32 i = 0; i < 4; i++) {
+    __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 16 * i));
+    // '[' and '{' (and ']' and '}') only differ in bit 5
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i structural =
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(lower, _mm_set1_epi8('{')),
+                                  _mm_cmpeq_epi8(lower, _mm_set1_epi8('}'))),
+                     _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')),
+                                  _mm_cmpeq_epi8(v, _mm_set1_epi8(','))));
+    __m128i whitespace =
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                                  _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+                     _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')),
+                                  _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+    __m128i quote = _mm_cmpeq_epi8(v, _mm_set1_epi8('"'));
+    __m128i backslash = _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'));
+
+    ret.quote |= u64(u32(_mm_movemask_epi8(quote))) << (16 * i);
+    ret.backslash |= u64(u32(_mm_movemask_epi8(backslash))) << (16 * i);
+    ret.structural |= u64(u32(_mm_movemask_epi8(structural))) << (16 * i);
+    ret.whitespace |= u64(u32(_mm_movemask_epi8(whitespace))) << (16 * i);
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  for (u32 i = 0; i < 4; i++) {
+    uint8x16_t v = vld1q_u8(reinterpret_cast<const u8 *>(block + 16 * i));
+    uint8x16_t lower = vorrq_u8(v, vdupq_n_u8(0x20));
+    uint8x16_t structural =
+        vorrq_u8(vorrq_u8(vceqq_u8(lower, vdupq_n_u8('{')),
+                          vceqq_u8(lower, vdupq_n_u8('}'))),
+                 vorrq_u8(vceqq_u8(v, vdupq_n_u8(':')),
+                          vceqq_u8(v, vdupq_n_u8(','))));
+    uint8x16_t whitespace =
+        vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')),
+                          vceqq_u8(v, vdupq_n_u8('\t'))),
+                 vorrq_u8(vceqq_u8(v, vdupq_n_u8('\n')),
+                          vceqq_u8(v, vdupq_n_u8('\r'))));
+
+    ret.quote |= u64(movemask16(vceqq_u8(v, vdupq_n_u8('"')))) << (16 * i);
+    ret.backslash |= u64(movemask16(vceqq_u8(v, vdupq_n_u8('\\'))))
+                     << (16 * i);
+    ret.structural |= u64(movemask16(structural)) << (16 * i);
+    ret.whitespace |= u64(movemask16(whitespace)) << (16 * i);
+  }
+#else
+  for (u32 i = 0; i < JsonScanner::BLOCK_SIZE; i++) {
+    u8 c = u8(block[i]);
+    ret.quote |= u64(c == '"') << i;
+    ret.backslash |= u64(c == '\\') << i;
+    ret.structural |= u64(isStructural(c)) << i;
+    ret.whitespace |= u64(isWhitespace(c)) << i;
+  }
+#endif
+  return ret;
+}
+
+/**
+ * \brief Finds the bytes that are escaped by a backslash.
+ * \param backslash Backslashes in the block
+ * \param prevEscaped 1 if the first byte of the block is escaped; receives the
+ * same for the next block
+ */
+static u64 findEscaped(u64 backslash, u64 &prevEscaped) {
+  u64 escaped = prevEscaped;
+  // An escaped backslash doesn't escape the next byte
+  backslash &= ~prevEscaped;
+  prevEscaped = 0;
+
+  // Backslashes are rare, visiting them one by one is cheap
+  while (backslash != 0) {
+    i32 i = countTrailingZeros64(backslash);
+    if (i == 63) {
+      prevEscaped = 1;
+      break;
+    }
+
+    escaped |= u64(1) << (i + 1);
+    backslash &= ~(u64(3) << i);
+  }
+
+  return escaped;
+}
+
+/**
+ * \brief Bit `i` of the result is the XOR of bits `0..i` of `x`; turns quote
+ * positions into a mask of the bytes inside strings.
+ */
+static u64 prefixXor(u64 x) {
+  x ^= x << 1;
+  x ^= x << 2;
+  x ^= x << 4;
+  x ^= x << 8;
+  x ^= x << 16;
+  x ^= x << 32;
+  return x;
+}
+}  // namespace
+
+bool JsonScanner::_refill() {
+  numPositions = 0;
+  idxPosition = 0;
+
+  while (offsetNextBlock < input.length &&
+         numPositions + BLOCK_SIZE <= MAX_POSITIONS) {
+    size_t remaining = input.length - offsetNextBlock;
+    if (remaining >= BLOCK_SIZE) {
+      _scanBlock(input.data + offsetNextBlock, offsetNextBlock);
+    } else {
+      // Pad the last block with whitespace
+      char tail[BLOCK_SIZE];
+      memset(tail, ' ', BLOCK_SIZE);
+      memcpy(tail, input.data + offsetNextBlock, remaining);
+      _scanBlock(tail, offsetNextBlock);
+    }
+    offsetNextBlock += BLOCK_SIZE;
+  }
+
+  return numPositions != 0;
+}
+
+void JsonScanner::_scanBlock(const char *block, size_t offset) {
+  BlockMasks m = classifyBlock(block);
+
+  u64 escaped = findEscaped(m.backslash, prevEscaped);
+  u64 quotes = m.quote & ~escaped;
+  // Includes the opening quote but not the closing one
+  u64 inString = prefixXor(quotes) ^ prevInString;
+  prevInString = u64(i64(inString) >> 63);
+
+  u64 scalar = ~(m.structural | m.whitespace | m.quote | inString);
+  u64 scalarStart = scalar & ~((scalar << 1) | prevScalar);
+  prevScalar = scalar >> 63;
+
+  u64 tokens = (m.structural & ~inString) | (quotes & inString) | scalarStart;
+  while (tokens != 0) {
+    positions[numPositions++] = offset + countTrailingZeros64(tokens);
+    tokens &= tokens - 1;
+  }
+}
+
+size_t jsonFindStringSpecial(Slice<char> s) {
+  size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+  for (; i + 16 <= s.length; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&s[i]));
+    __m128i special =
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')),
+                                  _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))),
+                     // v <= 0x1F, unsigned
+                     _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8(0x1F)),
+                                    _mm_set1_epi8(0x1F)));
+    u32 mask = u32(_mm_movemask_epi8(special));
+    if (mask != 0) {
+      return i + countTrailingZeros(mask);
+    }
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  for (; i + 16 <= s.length; i += 16) {
+    uint8x16_t v = vld1q_u8(reinterpret_cast<const u8 *>(&s[i]));
+    uint8x16_t special = vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')),
+                                           vceqq_u8(v, vdupq_n_u8('\\'))),
+                                  vcleq_u8(v, vdupq_n_u8(0x1F)));
+    if (vmaxvq_u8(special) != 0) {
+      return i + countTrailingZeros(movemask16(special));
+    }
+  }
+#endif
+  for (; i < s.length; i++) {
+    if (isStringSpecial(u8(s[i]))) {
+      return i;
+    }
+  }
+  return s.length;
+}
+
+size_t jsonFindNewline(Slice<char> s) {
+  size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+  for (; i + 16 <= s.length; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&s[i]));
+    u32 mask = u32(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))));
+    if (mask != 0) {
+      return i + countTrailingZeros(mask);
+    }
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  for (; i + 16 <= s.length; i += 16) {
+    uint8x16_t v = vld1q_u8(reinterpret_cast<const u8 *>(&s[i]));
+    uint8x16_t newline = vceqq_u8(v, vdupq_n_u8('\n'));
+    if (vmaxvq_u8(newline) != 0) {
+      return i + countTrailingZeros(movemask16(newline));
+    }
+  }
+#endif
+  for (; i < s.length; i++) {
+    if (s[i] == '\n') {
+      return i;
+    }
+  }
+  return s.length;
+}
+
+size_t jsonCountNewlines(Slice<char> s) {
+  size_t count = 0;
+  size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+  while (i + 16 <= s.length) {
+    // Every lane counts up to 255 newlines before the counters are summed
+    __m128i counters = _mm_setzero_si128();
+    for (u32 n = 0; n < 255 && i + 16 <= s.length; n++, i += 16) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&s[i]));
+      // Matching lanes are all ones, i.e. -1
+      counters =
+          _mm_sub_epi8(counters, _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+    }
+    __m128i sums = _mm_sad_epu8(counters, _mm_setzero_si128());
+    count += size_t(_mm_cvtsi128_si32(sums)) +
+             size_t(_mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  while (i + 16 <= s.length) {
+    uint8x16_t counters = vdupq_n_u8(0);
+    for (u32 n = 0; n < 255 && i + 16 <= s.length; n++, i += 16) {
+      uint8x16_t v = vld1q_u8(reinterpret_cast<const u8 *>(&s[i]));
+      counters = vsubq_u8(counters, vceqq_u8(v, vdupq_n_u8('\n')));
+    }
+    count += vaddlvq_u8(counters);
+  }
+#endif
+  for (; i < s.length; i++) {
+    count += s[i] == '\n';
+  }
+  return count;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "std/Slice.hpp"
+#include "std/Types.h"
+
+/**
+ * \brief Stage 1 of the JSON parser.
+ *
+ * Classifies the input 64 bytes at a time and reports the positions of the
+ * tokens the parser has to look at:
+ * - structural characters (`{`, `}`, `[`, `]`, `:` and `,`) outside strings,
+ * - the opening quote of every string,
+ * - the first character of every other run of non-whitespace characters
+ *   outside strings (numbers, `true`, `false`, `null` and garbage).
+ *
+ * Positions are produced in batches of a few blocks, so the memory used by the
+ * scanner doesn't depend on the size of the input.
+ */
+struct JsonScanner {
+  /** \brief Number of bytes classified at once */
+  static constexpr size_t BLOCK_SIZE = 64;
+  /** \brief Maximum number of positions buffered by the scanner */
+  static constexpr size_t MAX_POSITIONS = 8 * BLOCK_SIZE;
+
+  Slice<char> input;
+  /** \brief Offset of the first block that hasn't been classified yet */
+  size_t offsetNextBlock = 0;
+  /** \brief All ones if the previous block ended inside a string */
+  u64 prevInString = 0;
+  /** \brief 1 if the first byte of the next block is escaped */
+  u64 prevEscaped = 0;
+  /** \brief 1 if the previous block ended inside a scalar */
+  u64 prevScalar = 0;
+
+  size_t positions[MAX_POSITIONS];
+  size_t numPositions = 0;
+  size_t idxPosition = 0;
+
+  explicit JsonScanner(Slice<char> input) : input(input) {}
+
+  /**
+   * \brief Returns the position of the next token.
+   * \returns A value indicating whether there was a token left in the input
+   */
+  bool next(size_t &pos) {
+    if (idxPosition == numPositions && !_refill()) {
+      return false;
+    }
+
+    pos = positions[idxPosition++];
+    return true;
+  }
+
+  /**
+   * \brief Classifies the next few blocks of the input.
+   * \returns A value indicating whether new positions were found
+   */
+  bool _refill();
+  /** \brief Classifies a block and appends the positions of its tokens */
+  void _scanBlock(const char *block, size_t offset);
+};
+
+/**
+ * \brief Finds the first byte in `s` that a string can't contain verbatim:
+ * a quote, a backslash or a control character.
+ * \returns The index of that byte, or `s.length` if there isn't one
+ */
+size_t jsonFindStringSpecial(Slice<char> s);
+
+/**
+ * \brief Finds the first newline in `s`.
+ * \returns The index of the newline, or `s.length` if there isn't one
+ */
+size_t jsonFindNewline(Slice<char> s);
+
+/** \brief Counts the newlines in `s` */
+size_t jsonCountNewlines(Slice<char> s);
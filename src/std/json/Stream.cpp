@@ -0,0 +1,301 @@
+#include "std/json/Stream.hpp"
+#include "std/Arena.h"
+#include "std/Slice.hpp"
+#include "std/Types.h"
+#include "std/Vector.hpp"
+#include "std/json/Parser.hpp"
+#include "std/json/Scanner.hpp"
+#include "std/json/Value.hpp"
+
+#include <string.h>
+
+static bool isWhitespace(char c) {
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static bool isStructural(char c) {
+  return c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',';
+}
+
+static void appendChars(Arena *arena, Vector<char> *dst, Slice<char> src) {
+  if (!src.empty()) {
+    memcpy(append(arena, dst, src.length), src.data, src.length);
+  }
+}
+
+bool JsonStreamParser::feed(Slice<char> chunk) {
+  if (state == State::Failed) {
+    return false;
+  }
+
+  // A token continued from the previous chunk starts at the beginning
+  tokenStart = 0;
+  size_t i = 0;
+  while (i < chunk.length) {
+    bool ok;
+    switch (state) {
+      case State::String:
+        ok = _continueString(chunk, i);
+        break;
+      case State::Scalar:
+        ok = _continueScalar(chunk, i);
+        break;
+      default:
+        ok = _step(chunk, i);
+        break;
+    }
+
+    if (!ok) {
+      state = State::Failed;
+      return false;
+    }
+  }
+
+  if (state == State::String || state == State::Scalar) {
+    appendChars(arena, &token, chunk.subarray(tokenStart));
+  }
+
+  return true;
+}
+
+bool JsonStreamParser::finish() {
+  if (state == State::Scalar) {
+    // The input ended right after a number or a literal
+    tokenStart = 0;
+    if (!_finishToken({}, 0)) {
+      state = State::Failed;
+      return false;
+    }
+  }
+
+  return state == State::Value && stack.length == 0;
+}
+
+bool JsonStreamParser::_step(Slice<char> chunk, size_t &i) {
+  while (i < chunk.length && isWhitespace(chunk[i])) {
+    i++;
+  }
+  if (i == chunk.length) {
+    return true;
+  }
+
+  const char c = chunk[i];
+  switch (state) {
+    case State::Value:
+    case State::ValueOrClose:
+      if (c == ']' && state == State::ValueOrClose) {
+        i++;
+        stack.length -= 1;
+        _afterValue();
+        return handler->onEndArray();
+      }
+
+      switch (c) {
+        case '[':
+          i++;
+          appendVal(arena, &stack, JsonType::Array);
+          state = State::ValueOrClose;
+          return handler->onBeginArray();
+        case '{':
+          i++;
+          appendVal(arena, &stack, JsonType::Object);
+          state = State::KeyOrClose;
+          return handler->onBeginObject();
+        case '"':
+          isKey = false;
+          escapePending = false;
+          tokenStart = i++;
+          state = State::String;
+          return true;
+        default:
+          if (isStructural(c)) {
+            return false;
+          }
+          tokenStart = i++;
+          state = State::Scalar;
+          return true;
+      }
+    case State::KeyOrClose:
+      if (c == '}') {
+        i++;
+        stack.length -= 1;
+        _afterValue();
+        return handler->onEndObject();
+      }
+      [[fallthrough]];
+    case State::Key:
+      if (c != '"') {
+        return false;
+      }
+      isKey = true;
+      escapePending = false;
+      tokenStart = i++;
+      state = State::String;
+      return true;
+    case State::Colon:
+      if (c != ':') {
+        return false;
+      }
+      i++;
+      state = State::Value;
+      return true;
+    case State::CommaOrClose: {
+      const JsonType top = stack[stack.length - 1];
+      i++;
+      if (c == ',') {
+        state = top == JsonType::Array ? State::Value : State::Key;
+        return true;
+      }
+
+      if (top == JsonType::Array && c == ']') {
+        stack.length -= 1;
+        _afterValue();
+        return handler->onEndArray();
+      }
+
+      if (top == JsonType::Object && c == '}') {
+        stack.length -= 1;
+        _afterValue();
+        return handler->onEndObject();
+      }
+
+      return false;
+    }
+    default:
+      return false;
+  }
+}
+
+bool JsonStreamParser::_continueString(Slice<char> chunk, size_t &i) {
+  while (true) {
+    if (escapePending) {
+      if (i == chunk.length) {
+        return true;
+      }
+      // Skip the escaped character; it's validated while decoding
+      i++;
+      escapePending = false;
+    }
+
+    i += jsonFindStringSpecial(chunk.subarray(i));
+    if (i == chunk.length) {
+      return true;
+    }
+
+    if (chunk[i] == '\\') {
+      i++;
+      escapePending = true;
+      continue;
+    }
+
+    if (chunk[i] != '"') {
+      // Unescaped control character
+      return false;
+    }
+
+    i++;
+    return _finishToken(chunk, i);
+  }
+}
+
+bool JsonStreamParser::_continueScalar(Slice<char> chunk, size_t &i) {
+  while (i < chunk.length) {
+    const char c = chunk[i];
+    if (isWhitespace(c) || isStructural(c) || c == '"') {
+      return _finishToken(chunk, i);
+    }
+    i++;
+  }
+
+  return true;
+}
+
+bool JsonStreamParser::_finishToken(Slice<char> chunk, size_t end) {
+  Slice<char> src = chunk.subarray(tokenStart, end);
+  if (token.length != 0) {
+    appendChars(arena, &token, src);
+    src = {token.data, token.length};
+  }
+
+  // Escaped strings are decoded into the scratch arena; the result only has to
+  // live until the handler returns
+  Arena::Scope temp = getScratch(&arena, 1);
+  JsonValue value;
+  size_t length;
+  bool ok = impl::tryParseJsonScalar(temp, src, 0, flags, value, length) &&
+            length == src.length;
+  token.length = 0;
+  if (!ok) {
+    return false;
+  }
+
+  if (isKey) {
+    isKey = false;
+    state = State::Colon;
+    return handler->onKey(value.string());
+  }
+
+  _afterValue();
+  return handler->onScalar(value);
+}
+
+void JsonStreamParser::_afterValue() {
+  state = stack.length == 0 ? State::Value : State::CommaOrClose;
+}
+
+bool JsonNdjsonReader::feed(Slice<char> chunk) {
+  while (!chunk.empty()) {
+    const size_t length = jsonFindNewline(chunk);
+    if (length == chunk.length) {
+      appendChars(arena, &partial, chunk);
+      return true;
+    }
+
+    Slice<char> line = {chunk.data, length};
+    if (partial.length != 0) {
+      appendChars(arena, &partial, line);
+      line = {partial.data, partial.length};
+    }
+
+    bool ok = _parseLine(line);
+    partial.length = 0;
+    if (!ok) {
+      return false;
+    }
+
+    chunk.shrinkFromLeftByCount(length + 1);
+  }
+
+  return true;
+}
+
+bool JsonNdjsonReader::finish() {
+  if (partial.length == 0) {
+    return true;
+  }
+
+  bool ok = _parseLine({partial.data, partial.length});
+  partial.length = 0;
+  return ok;
+}
+
+bool JsonNdjsonReader::_parseLine(Slice<char> line) {
+  const size_t idx = idxLine++;
+
+  bool isBlank = true;
+  for (size_t i = 0; i < line.length && isBlank; i++) {
+    isBlank = isWhitespace(line[i]);
+  }
+  if (isBlank) {
+    return true;
+  }
+
+  Arena::Scope record = recordArena;
+  JsonValue value;
+  Slice<char> src = line;
+  if (!tryParseValue(record, src, value, flags)) {
+    return handler->onInvalidRecord(line, idx);
+  }
+
+  return handler->onRecord(value, idx);
+}
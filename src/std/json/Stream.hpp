@@ -0,0 +1,166 @@
+#pragma once
+
+#include "std/Arena.h"
+#include "std/Slice.hpp"
+#include "std/Types.h"
+#include "std/Vector.hpp"
+#include "std/json/Value.hpp"
+
+/**
+ * \brief Receives the events of a `JsonStreamParser`.
+ *
+ * Strings, both values and keys, are only valid during the call. Returning
+ * false from any of the callbacks stops the parser.
+ */
+struct JsonEventHandler {
+  /** \brief A null, a boolean, a number or a string */
+  virtual bool onScalar(const JsonValue &value) = 0;
+  /** \brief The key of the next value of an object */
+  virtual bool onKey(Slice<char> key) = 0;
+  virtual bool onBeginArray() = 0;
+  virtual bool onEndArray() = 0;
+  virtual bool onBeginObject() = 0;
+  virtual bool onEndObject() = 0;
+};
+
+/**
+ * \brief A resumable JSON parser that accepts its input in chunks and reports
+ * what it finds as events.
+ *
+ * The input may contain any number of top-level values separated by
+ * whitespace. Tokens can be split anywhere between chunks; the parser only
+ * buffers the part of the token that's in the previous chunks, so the memory
+ * it uses depends on the nesting depth and on the size of the largest token,
+ * but not on the size of the input.
+ */
+struct JsonStreamParser {
+  enum class State : u8 {
+    /** \brief Expects a value */
+    Value,
+    /** \brief Expects a value or `]` */
+    ValueOrClose,
+    /** \brief Expects a key or `}` */
+    KeyOrClose,
+    /** \brief Expects a key */
+    Key,
+    Colon,
+    /** \brief Expects `,` or the end of the innermost container */
+    CommaOrClose,
+    /** \brief Inside a string */
+    String,
+    /** \brief Inside a number or a literal */
+    Scalar,
+    /** \brief A syntax error was found or a handler stopped the parser */
+    Failed,
+  };
+
+  /** \brief Holds the stack and the partial tokens */
+  Arena *arena;
+  JsonEventHandler *handler;
+  /** \brief `JsonParseFlags` */
+  u32 flags;
+
+  State state = State::Value;
+  /** \brief The open arrays and objects */
+  Vector<JsonType> stack = {};
+  /** \brief The beginning of the token that is split between chunks */
+  Vector<char> token = {};
+  /** \brief Offset of the current token in the chunk being parsed */
+  size_t tokenStart = 0;
+  /** \brief Whether the string being parsed is a key */
+  bool isKey = false;
+  /** \brief Whether the last character of the previous chunk was a backslash
+   * in a string */
+  bool escapePending = false;
+
+  JsonStreamParser(Arena *arena, JsonEventHandler *handler, u32 flags = 0)
+      : arena(arena), handler(handler), flags(flags) {}
+
+  /**
+   * \brief Parses the next chunk of the input.
+   * \returns false if the input is invalid or a handler stopped the parser
+   */
+  bool feed(Slice<char> chunk);
+
+  /**
+   * \brief Signals the end of the input.
+   * \returns false if the input ended in the middle of a value
+   */
+  bool finish();
+
+  /** \brief Parses a structural character or the beginning of a token */
+  bool _step(Slice<char> chunk, size_t &i);
+  /** \brief Looks for the end of the current string */
+  bool _continueString(Slice<char> chunk, size_t &i);
+  /** \brief Looks for the end of the current number or literal */
+  bool _continueScalar(Slice<char> chunk, size_t &i);
+  /**
+   * \brief Parses the token that ends at `chunk[end]` and emits its event.
+   */
+  bool _finishToken(Slice<char> chunk, size_t end);
+  void _afterValue();
+};
+
+/**
+ * \brief Receives the records of a `JsonNdjsonReader`.
+ *
+ * The value and its strings are only valid during the call. Returning false
+ * stops the reader.
+ */
+struct JsonRecordHandler {
+  /** \param idxLine Zero-based index of the line of the record */
+  virtual bool onRecord(const JsonValue &value, size_t idxLine) = 0;
+  /**
+   * \brief Called for the lines that aren't valid JSON.
+   * \returns true to skip the line, false to stop the reader
+   */
+  virtual bool onInvalidRecord(Slice<char> /* line */, size_t /* idxLine */) {
+    return false;
+  }
+};
+
+/**
+ * \brief Reads newline-delimited JSON chunk by chunk.
+ *
+ * Every line is parsed into a fresh `Arena::Scope` of the record arena, which
+ * is reset once the handler returns, so the memory used by the reader depends
+ * only on the size of the largest record. Blank lines are skipped.
+ */
+struct JsonNdjsonReader {
+  /** \brief Holds the lines that are split between chunks */
+  Arena *arena;
+  /** \brief The records are parsed into this arena */
+  Arena *recordArena;
+  JsonRecordHandler *handler;
+  /** \brief `JsonParseFlags` */
+  u32 flags;
+
+  /** \brief The beginning of the line that is split between chunks */
+  Vector<char> partial = {};
+  /** \brief Index of the next line */
+  size_t idxLine = 0;
+
+  JsonNdjsonReader(Arena *arena,
+                   Arena *recordArena,
+                   JsonRecordHandler *handler,
+                   u32 flags = 0)
+      : arena(arena),
+        recordArena(recordArena),
+        handler(handler),
+        flags(flags) {}
+
+  /**
+   * \brief Parses the complete lines in the chunk and keeps the rest for
+   * later.
+   * \returns false if a handler stopped the reader
+   */
+  bool feed(Slice<char> chunk);
+
+  /**
+   * \brief Signals the end of the input; parses the last line if it wasn't
+   * terminated.
+   */
+  bool finish();
+
+  bool _parseLine(Slice<char> line);
+};
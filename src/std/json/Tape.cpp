@@ -0,0 +1,382 @@
+#include "std/json/Tape.hpp"
+#include "std/Arena.h"
+#include "std/Check.h"
+#include "std/Slice.hpp"
+#include "std/Types.h"
+#include "std/Vector.hpp"
+#include "std/json/Parser.hpp"
+#include "std/json/Scanner.hpp"
+#include "std/json/Value.hpp"
+
+#include <string.h>
+
+static constexpr u64 PAYLOAD_MASK = (u64(1) << 56) - 1;
+static constexpr u64 MAX_COUNT = 0xFFFFFF;
+
+static u64 makeWord(JsonTapeTag tag, u64 payload) {
+  DCHECK(payload <= PAYLOAD_MASK);
+  return (u64(tag) << 56) | payload;
+}
+
+static u64 payloadOf(u64 word) {
+  return word & PAYLOAD_MASK;
+}
+
+JsonType JsonTapeValue::type() const {
+  switch (tag()) {
+    case JSON_TAPE_NULL:
+      return JsonType::Null;
+    case JSON_TAPE_TRUE:
+      return JsonType::True;
+    case JSON_TAPE_FALSE:
+      return JsonType::False;
+    case JSON_TAPE_NUMBER:
+      return JsonType::Number;
+    case JSON_TAPE_INTEGER:
+      return JsonType::Integer;
+    case JSON_TAPE_UNSIGNED_INTEGER:
+      return JsonType::UnsignedInteger;
+    case JSON_TAPE_STRING:
+      return JsonType::String;
+    case JSON_TAPE_BEGIN_ARRAY:
+    case JSON_TAPE_END_ARRAY:
+      return JsonType::Array;
+    default:
+      return JsonType::Object;
+  }
+}
+
+f64 JsonTapeValue::number() const {
+  const u64 bits = tape->words[idx + 1];
+  switch (tag()) {
+    case JSON_TAPE_INTEGER:
+      return f64(i64(bits));
+    case JSON_TAPE_UNSIGNED_INTEGER:
+      return f64(bits);
+    default: {
+      f64 value;
+      memcpy(&value, &bits, sizeof(value));
+      return value;
+    }
+  }
+}
+
+i64 JsonTapeValue::integer() const {
+  return i64(tape->words[idx + 1]);
+}
+
+u64 JsonTapeValue::uinteger() const {
+  return tape->words[idx + 1];
+}
+
+Slice<char> JsonTapeValue::string() const {
+  const u64 offset = payloadOf(tape->words[idx]);
+  u32 length;
+  memcpy(&length, &tape->strings[offset], sizeof(length));
+  return tape->strings.subarray(offset + sizeof(length),
+                                offset + sizeof(length) + length);
+}
+
+size_t JsonTapeValue::length() const {
+  const u64 count = payloadOf(tape->words[idx]) >> 32;
+  if (count < MAX_COUNT) {
+    return count;
+  }
+
+  size_t n = 0;
+  for (JsonTapeValue it = begin(); !it.isEnd(); it = it.next()) {
+    n++;
+  }
+  return tag() == JSON_TAPE_BEGIN_OBJECT ? n / 2 : n;
+}
+
+JsonTapeValue JsonTapeValue::next() const {
+  switch (tag()) {
+    case JSON_TAPE_BEGIN_ARRAY:
+    case JSON_TAPE_BEGIN_OBJECT:
+      return {tape, size_t(u32(tape->words[idx]))};
+    case JSON_TAPE_NUMBER:
+    case JSON_TAPE_INTEGER:
+    case JSON_TAPE_UNSIGNED_INTEGER:
+      return {tape, idx + 2};
+    default:
+      return {tape, idx + 1};
+  }
+}
+
+bool JsonTapeValue::tryGetKeyValue(Slice<char> key, JsonTapeValue &out) const {
+  if (tag() != JSON_TAPE_BEGIN_OBJECT) {
+    return false;
+  }
+
+  for (JsonTapeValue it = begin(); !it.isEnd(); it = it.next().next()) {
+    if (it.string() == key) {
+      out = it.next();
+      return true;
+    }
+  }
+
+  return false;
+}
+
+namespace {
+/** \brief An array or object that is still being parsed */
+struct Frame {
+  /** \brief Index of the opening word */
+  size_t idxOpen;
+  u64 count;
+  JsonTapeTag tag;
+};
+
+/**
+ * \brief Builds the tape from the tokens found by the `JsonScanner`, like the
+ * `TreeBuilder` of the parser builds the tree. The words and the strings grow
+ * in the temp arena and they're copied into the output at the end.
+ */
+struct TapeBuilder {
+  Arena *temp;
+  Slice<char> json;
+  u32 flags;
+  JsonScanner scanner;
+
+  Vector<u64> words;
+  Vector<char> strings;
+  Vector<Frame> frames = {};
+
+  TapeBuilder(Arena *temp, Slice<char> json, u32 flags)
+      : temp(temp),
+        json(json),
+        flags(flags),
+        scanner(json),
+        // Sized so that most documents don't have to grow them: a word per 4
+        // bytes of input, and a length prefix in place of the quotes
+        words(reserve<u64>(temp, json.length / 4 + 16)),
+        strings(reserve<char>(temp, json.length + 16)) {}
+
+  /** \brief Like `vectorWithInitialCapacity`, without zeroing the space */
+  template <typename T>
+  static Vector<T> reserve(Arena *arena, size_t capacity) {
+    Vector<T> ret;
+    ret.data = allocNZ<T>(arena, capacity);
+    ret.capacity = capacity;
+    return ret;
+  }
+
+  bool parse() {
+    size_t pos;
+    if (!scanner.next(pos)) {
+      return false;
+    }
+
+    while (true) {
+      // `pos` is the first token of a value
+      if (json[pos] == '[' || json[pos] == '{') {
+        const JsonTapeTag tag =
+            json[pos] == '[' ? JSON_TAPE_BEGIN_ARRAY : JSON_TAPE_BEGIN_OBJECT;
+        appendVal(temp, &frames, {words.length, 0, tag});
+        appendVal(temp, &words, u64(0));
+
+        if (!scanner.next(pos)) {
+          return false;
+        }
+
+        if (json[pos] != _closingOf(tag)) {
+          if (!_beginElement(pos)) {
+            return false;
+          }
+          continue;
+        }
+
+        _close();
+      } else if (!_appendScalar(pos)) {
+        return false;
+      }
+
+      // The value is complete, and so may be the containers around it
+      while (true) {
+        if (frames.length == 0) {
+          // Nothing but whitespace may follow the root
+          return !scanner.next(pos) && words.length <= UINT32_MAX;
+        }
+
+        if (!scanner.next(pos)) {
+          return false;
+        }
+
+        if (json[pos] == ',') {
+          if (!scanner.next(pos) || !_beginElement(pos)) {
+            return false;
+          }
+          break;
+        }
+
+        if (json[pos] != _closingOf(frames[frames.length - 1].tag)) {
+          return false;
+        }
+
+        _close();
+      }
+    }
+  }
+
+  static char _closingOf(JsonTapeTag tag) {
+    return tag == JSON_TAPE_BEGIN_ARRAY ? ']' : '}';
+  }
+
+  /**
+   * \brief Counts the next element of the topmost container. In objects the
+   * key and the colon are parsed, too.
+   * \param pos First token of the element; receives the first token of the
+   * value in objects
+   */
+  bool _beginElement(size_t &pos) {
+    Frame &frame = frames[frames.length - 1];
+    frame.count++;
+    if (frame.tag == JSON_TAPE_BEGIN_ARRAY) {
+      return true;
+    }
+
+    if (json[pos] != '"' || !_appendScalar(pos)) {
+      return false;
+    }
+
+    if (!scanner.next(pos) || json[pos] != ':') {
+      return false;
+    }
+
+    return scanner.next(pos);
+  }
+
+  bool _appendScalar(size_t pos) {
+    // Escaped strings are decoded into the temp arena before they're copied
+    JsonValue value;
+    size_t end;
+    if (!impl::tryParseJsonScalar(temp, json, pos, flags, value, end)) {
+      return false;
+    }
+
+    switch (value.type) {
+      case JsonType::Null:
+        appendVal(temp, &words, makeWord(JSON_TAPE_NULL, 0));
+        break;
+      case JsonType::True:
+        appendVal(temp, &words, makeWord(JSON_TAPE_TRUE, 0));
+        break;
+      case JsonType::False:
+        appendVal(temp, &words, makeWord(JSON_TAPE_FALSE, 0));
+        break;
+      case JsonType::Number: {
+        u64 bits;
+        memcpy(&bits, &value.number, sizeof(bits));
+        appendVal(temp, &words, makeWord(JSON_TAPE_NUMBER, 0));
+        appendVal(temp, &words, bits);
+        break;
+      }
+      case JsonType::Integer:
+        appendVal(temp, &words, makeWord(JSON_TAPE_INTEGER, 0));
+        appendVal(temp, &words, u64(value.integer));
+        break;
+      case JsonType::UnsignedInteger:
+        appendVal(temp, &words, makeWord(JSON_TAPE_UNSIGNED_INTEGER, 0));
+        appendVal(temp, &words, value.uinteger);
+        break;
+      case JsonType::String: {
+        if (value.length > UINT32_MAX) {
+          return false;
+        }
+        const u32 length = u32(value.length);
+        appendVal(temp, &words, makeWord(JSON_TAPE_STRING, strings.length));
+        char *dst = append(temp, &strings, sizeof(length) + length);
+        memcpy(dst, &length, sizeof(length));
+        memcpy(dst + sizeof(length), value.str, length);
+        break;
+      }
+      default:
+        return false;
+    }
+
+    return true;
+  }
+
+  /** \brief Appends the close of the topmost container and links the two */
+  void _close() {
+    const Frame frame = frames[frames.length - 1];
+    const JsonTapeTag closing = frame.tag == JSON_TAPE_BEGIN_ARRAY
+                                    ? JSON_TAPE_END_ARRAY
+                                    : JSON_TAPE_END_OBJECT;
+    appendVal(temp, &words, makeWord(closing, frame.idxOpen));
+
+    const u64 count = frame.count < MAX_COUNT ? frame.count : MAX_COUNT;
+    words[frame.idxOpen] =
+        makeWord(frame.tag, (count << 32) | u32(words.length));
+    frames.length -= 1;
+  }
+};
+}  // namespace
+
+static void viewTape(const u8 *bytes,
+                     size_t numWords,
+                     size_t numStringBytes,
+                     JsonTape &out) {
+  const size_t offsetWords = sizeof(JsonTapeHeader);
+  const size_t offsetStrings = offsetWords + numWords * sizeof(u64);
+  out.bytes = {bytes, offsetStrings + numStringBytes};
+  out.words = {reinterpret_cast<const u64 *>(bytes + offsetWords), numWords};
+  out.strings = {reinterpret_cast<const char *>(bytes + offsetStrings),
+                 numStringBytes};
+}
+
+bool tryParseJsonTape(Arena *arena,
+                      Slice<char> json,
+                      JsonTape &out,
+                      u32 flags) {
+  static_assert(sizeof(JsonTapeHeader) % alignof(u64) == 0);
+
+  // Strings are copied into the tape anyway
+  Arena::Scope temp = getScratch(&arena, 1);
+  TapeBuilder builder(temp, json, flags & ~JSON_PARSE_COPY_STRINGS);
+  if (!builder.parse()) {
+    return false;
+  }
+
+  const JsonTapeHeader header = {
+      .magic = JsonTapeHeader::MAGIC,
+      .version = JsonTapeHeader::VERSION,
+      .numWords = builder.words.length,
+      .numStringBytes = builder.strings.length,
+  };
+  const size_t size = sizeof(header) + header.numWords * sizeof(u64) +
+                      header.numStringBytes;
+  u8 *bytes = allocNZ(arena, size, alignof(u64), 1);
+  u8 *dst = bytes;
+  memcpy(dst, &header, sizeof(header));
+  dst += sizeof(header);
+  memcpy(dst, builder.words.data, header.numWords * sizeof(u64));
+  dst += header.numWords * sizeof(u64);
+  if (header.numStringBytes != 0) {
+    memcpy(dst, builder.strings.data, header.numStringBytes);
+  }
+
+  viewTape(bytes, header.numWords, header.numStringBytes, out);
+  return true;
+}
+
+bool tryLoadJsonTape(Slice<u8> bytes, JsonTape &out) {
+  JsonTapeHeader header;
+  if (bytes.length < sizeof(header) ||
+      uintptr_t(bytes.data) % alignof(u64) != 0) {
+    return false;
+  }
+
+  memcpy(&header, bytes.data, sizeof(header));
+  if (header.magic != JsonTapeHeader::MAGIC ||
+      header.version != JsonTapeHeader::VERSION || header.numWords == 0 ||
+      header.numWords > (bytes.length - sizeof(header)) / sizeof(u64) ||
+      header.numStringBytes != bytes.length - sizeof(header) -
+                                   header.numWords * sizeof(u64)) {
+    return false;
+  }
+
+  viewTape(bytes.data, header.numWords, header.numStringBytes, out);
+  return true;
+}
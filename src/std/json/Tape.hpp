@@ -0,0 +1,134 @@
+#pragma once
+
+#include "std/Arena.h"
+#include "std/Slice.hpp"
+#include "std/Types.h"
+#include "std/json/Value.hpp"
+
+/**
+ * \brief Tags in the top 8 bits of the words of a `JsonTape`.
+ *
+ * The payload in the low 56 bits:
+ * - `[` and `{`: the index of the word after the matching close in the low 32
+ *   bits, and the number of elements (saturated at `0xFFFFFF`) above them,
+ * - `]` and `}`: the index of the matching open,
+ * - `"`: the offset of the string in `JsonTape::strings`, where it's stored as
+ *   a u32 byte length followed by the bytes,
+ * - `d`, `l` and `u`: nothing; the next word holds the f64, i64 or u64,
+ * - `n`, `t` and `f`: nothing.
+ *
+ * The keys and values of objects alternate; keys are strings.
+ */
+enum JsonTapeTag : u8 {
+  JSON_TAPE_NULL = 'n',
+  JSON_TAPE_TRUE = 't',
+  JSON_TAPE_FALSE = 'f',
+  JSON_TAPE_NUMBER = 'd',
+  JSON_TAPE_INTEGER = 'l',
+  JSON_TAPE_UNSIGNED_INTEGER = 'u',
+  JSON_TAPE_STRING = '"',
+  JSON_TAPE_BEGIN_ARRAY = '[',
+  JSON_TAPE_END_ARRAY = ']',
+  JSON_TAPE_BEGIN_OBJECT = '{',
+  JSON_TAPE_END_OBJECT = '}',
+};
+
+/** \brief Header at the front of the bytes of a `JsonTape` */
+struct JsonTapeHeader {
+  static constexpr u32 MAGIC = 0x544A4E53;  // "SNJT"
+  static constexpr u32 VERSION = 1;
+
+  u32 magic;
+  u32 version;
+  u64 numWords;
+  u64 numStringBytes;
+};
+
+/**
+ * \brief A parsed JSON document as a flat array of 64-bit words, one per node
+ * (two for numbers), in document order; see `JsonTapeTag`.
+ *
+ * The words and the strings hold offsets only, and they're stored in a single
+ * block after a `JsonTapeHeader`, so `bytes` can be written to disk as is and
+ * loaded back, or memory-mapped, with `tryLoadJsonTape`.
+ */
+struct JsonTape {
+  /** \brief The header, the words and the strings */
+  Slice<u8> bytes;
+  Slice<u64> words;
+  Slice<char> strings;
+};
+
+/**
+ * \brief A node of a `JsonTape`.
+ *
+ * Children are navigated forward: the first one is `begin()`, the ones after
+ * it are `next()`. In objects every key is followed by its value.
+ */
+struct JsonTapeValue {
+  const JsonTape *tape;
+  size_t idx;
+
+  JsonTapeTag tag() const { return JsonTapeTag(tape->words[idx] >> 56); }
+  JsonType type() const;
+
+  /** \brief Valid when the type is Number, Integer or UnsignedInteger */
+  f64 number() const;
+  /** \brief Valid when the type is Integer */
+  i64 integer() const;
+  /** \brief Valid when the type is UnsignedInteger */
+  u64 uinteger() const;
+  /** \brief Valid when the type is String */
+  Slice<char> string() const;
+
+  /**
+   * \brief Returns the number of elements of an array or key-values of an
+   * object. Only large containers are walked to find it.
+   */
+  size_t length() const;
+  /** \brief Returns whether an array or object has no elements */
+  bool empty() const { return begin().isEnd(); }
+
+  /** \brief Returns the first element of an array, or key of an object */
+  JsonTapeValue begin() const { return {tape, idx + 1}; }
+  /** \brief Returns the node after this one and its children */
+  JsonTapeValue next() const;
+  /** \brief Returns whether this is the close of the enclosing container */
+  bool isEnd() const {
+    return tag() == JSON_TAPE_END_ARRAY || tag() == JSON_TAPE_END_OBJECT;
+  }
+
+  /**
+   * \brief Finds the value of the first key equal to `key` in an object.
+   * \returns false if the value is not an object or it has no such key
+   */
+  bool tryGetKeyValue(Slice<char> key, JsonTapeValue &out) const;
+};
+
+/**
+ * \brief Parses a whole JSON document into a tape allocated from `arena`.
+ *
+ * Strings are always copied into the tape. Documents that need more than
+ * 2^32 words are rejected.
+ *
+ * \param flags `JsonParseFlags`; `JSON_PARSE_INTEGERS` is supported
+ */
+bool tryParseJsonTape(Arena *arena,
+                      Slice<char> json,
+                      JsonTape &out,
+                      u32 flags = 0);
+
+/**
+ * \brief Views `bytes` that were taken from `JsonTape::bytes` as a tape,
+ * without copying them.
+ *
+ * Only the header is validated, so the bytes must come from a trusted source,
+ * and from a machine with the same byte order. `bytes` must be aligned to 8
+ * bytes, which memory-mapped files are.
+ */
+bool tryLoadJsonTape(Slice<u8> bytes, JsonTape &out);
+
+/** \brief Returns the root of the document */
+inline JsonTapeValue jsonTapeRoot(const JsonTape &tape) {
+  return {&tape, 0};
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "std/SliceUtils.hpp"
+#include "std/json/Index.hpp"
 #include "std/json/Value.hpp"
 
 inline bool hasType(const JsonValue *v, JsonType t) {
@@ -16,7 +17,8 @@ inline bool isBoolean(const JsonValue *v) {
 }
 
 inline bool isNumeric(const JsonValue *v) {
-  return hasType(v, JsonType::Number);
+  return hasType(v, JsonType::Number) || hasType(v, JsonType::Integer) ||
+         hasType(v, JsonType::UnsignedInteger);
 }
 
 inline bool isString(const JsonValue *v) {
@@ -57,7 +59,14 @@ inline bool isObject(const JsonValue &v) {
 
 template <typename T>
 inline T asNumeric(const JsonValue *v) {
-  return T(v->number);
+  switch (v->type) {
+    case JsonType::Integer:
+      return T(v->integer);
+    case JsonType::UnsignedInteger:
+      return T(v->uinteger);
+    default:
+      return T(v->number);
+  }
 }
 
 template <typename T>
@@ -69,6 +78,10 @@ inline f32 coerceToF32(const JsonValue *v) {
   switch (v->type) {
     case JsonType::Number:
       return f32(v->number);
+    case JsonType::Integer:
+      return f32(v->integer);
+    case JsonType::UnsignedInteger:
+      return f32(v->uinteger);
     case JsonType::True:
       return 1.0f;
     default:
@@ -93,6 +106,11 @@ inline bool getKeyValue(JsonValue *obj,
     return false;
   }
 
+  if (obj->indexed) {
+    *out = impl::findIndexedKey(obj, key);
+    return *out != nullptr;
+  }
+
   for (auto [kv, _] : obj->object()) {
     if (compareAsString(kv.key, key)) {
       *out = &kv.value;
@@ -108,6 +126,10 @@ inline JsonValue *getKeyValue(JsonValue *obj, Slice<char> key) {
     return nullptr;
   }
 
+  if (obj->indexed) {
+    return impl::findIndexedKey(obj, key);
+  }
+
   for (auto [kv, _] : obj->object()) {
     if (compareAsString(kv.key, key)) {
       return &kv.value;
@@ -11,6 +11,9 @@ enum class JsonType : u8 {
   String,
   Array,
   Object,
+  // Only produced with JSON_PARSE_INTEGERS
+  Integer,
+  UnsignedInteger,
 };
 
 struct JsonValue;
@@ -19,7 +22,12 @@ struct JsonKeyValue;
 struct JsonValue {
   union {
     f64 number;
-    // Points to utf-8 data of length `length`. Valid when type is String
+    // Valid when type is Integer
+    i64 integer;
+    // Valid when type is UnsignedInteger; always greater than INT64_MAX
+    u64 uinteger;
+    // Points to utf-8 data of length `length`. Valid when type is String.
+    // May point into the parsed input, see JSON_PARSE_COPY_STRINGS
     const char *str;
     // Points to JSON values of count `length`. Valid when type is Array
     JsonValue *arr;
@@ -31,6 +39,9 @@ struct JsonValue {
   // - When `type` is Object, this is the number of key-values on the object
   size_t length;
   JsonType type;
+  // Set on objects that have a hash index after their key-values; see
+  // json/Index.hpp
+  bool indexed = false;
 
   Slice<char> string() const { return {str, length}; }
   Slice<JsonValue> array() const { return {arr, length}; }
@@ -0,0 +1,276 @@
+#include "std/json/Writer.hpp"
+#include "std/Arena.h"
+#include "std/Check.h"
+#include "std/Slice.hpp"
+#include "std/SliceUtils.hpp"
+#include "std/Types.h"
+#include "std/Vector.hpp"
+#include "std/json/Number.hpp"
+#include "std/json/Scanner.hpp"
+#include "std/json/Value.hpp"
+
+#include <string.h>
+
+JsonWriter::JsonWriter(Arena *arena, JsonSink *sink)
+    : arena(arena),
+      sink(sink),
+      buffer(vectorWithInitialCapacity<char>(arena, SINK_BUFFER_SIZE)) {}
+
+void JsonWriter::beginArray() {
+  _separate();
+  _put('[');
+  needComma = false;
+}
+
+void JsonWriter::endArray() {
+  _put(']');
+  needComma = true;
+}
+
+void JsonWriter::beginObject() {
+  _separate();
+  _put('{');
+  needComma = false;
+}
+
+void JsonWriter::endObject() {
+  _put('}');
+  needComma = true;
+}
+
+void JsonWriter::key(Slice<char> key) {
+  _separate();
+  _writeString(key);
+  _put(':');
+  needComma = false;
+}
+
+void JsonWriter::null() {
+  _separate();
+  _write(sliceFromConstChar("null"));
+  needComma = true;
+}
+
+void JsonWriter::boolean(bool value) {
+  _separate();
+  if (value) {
+    _write(sliceFromConstChar("true"));
+  } else {
+    _write(sliceFromConstChar("false"));
+  }
+  needComma = true;
+}
+
+void JsonWriter::number(f64 value) {
+  _separate();
+  char *dst = _reserve(JSON_NUMBER_MAX_LENGTH);
+  buffer.length += formatJsonNumber(dst, value);
+  needComma = true;
+}
+
+void JsonWriter::integer(i64 value) {
+  _separate();
+  char *dst = _reserve(JSON_NUMBER_MAX_LENGTH);
+  buffer.length += formatJsonInteger(dst, value);
+  needComma = true;
+}
+
+void JsonWriter::unsignedInteger(u64 value) {
+  _separate();
+  char *dst = _reserve(JSON_NUMBER_MAX_LENGTH);
+  buffer.length += formatJsonUnsignedInteger(dst, value);
+  needComma = true;
+}
+
+void JsonWriter::string(Slice<char> value) {
+  _separate();
+  _writeString(value);
+  needComma = true;
+}
+
+void JsonWriter::value(const JsonValue &root) {
+  /** \brief An array or object whose elements are being written */
+  struct Frame {
+    const JsonValue *container;
+    size_t idxNext;
+  };
+
+  Arena::Scope temp = getScratch(&arena, 1);
+  Vector<Frame> frames = {};
+
+  const JsonValue *value = &root;
+  while (value != nullptr) {
+    switch (value->type) {
+      case JsonType::Null:
+        null();
+        break;
+      case JsonType::False:
+        boolean(false);
+        break;
+      case JsonType::True:
+        boolean(true);
+        break;
+      case JsonType::Number:
+        number(value->number);
+        break;
+      case JsonType::Integer:
+        integer(value->integer);
+        break;
+      case JsonType::UnsignedInteger:
+        unsignedInteger(value->uinteger);
+        break;
+      case JsonType::String:
+        string(value->string());
+        break;
+      case JsonType::Array:
+        beginArray();
+        appendVal(temp, &frames, {value, 0});
+        break;
+      case JsonType::Object:
+        beginObject();
+        appendVal(temp, &frames, {value, 0});
+        break;
+    }
+
+    // Continue with the next element of the innermost open container, closing
+    // the containers that have none left
+    value = nullptr;
+    while (frames.length != 0) {
+      Frame &frame = frames[frames.length - 1];
+      const JsonValue *container = frame.container;
+      if (frame.idxNext < container->length) {
+        if (container->type == JsonType::Array) {
+          value = &container->arr[frame.idxNext];
+        } else {
+          key(container->kv[frame.idxNext].key);
+          value = &container->kv[frame.idxNext].value;
+        }
+        frame.idxNext++;
+        break;
+      }
+
+      if (container->type == JsonType::Array) {
+        endArray();
+      } else {
+        endObject();
+      }
+      frames.length -= 1;
+    }
+  }
+}
+
+bool JsonWriter::flush() {
+  if (sink != nullptr && buffer.length != 0) {
+    if (!failed && !sink->write(output())) {
+      failed = true;
+    }
+    buffer.length = 0;
+  }
+
+  return !failed;
+}
+
+char *JsonWriter::_reserve(size_t count) {
+  if (buffer.length + count > buffer.capacity) {
+    if (sink != nullptr) {
+      DCHECK(count <= buffer.capacity);
+      flush();
+    } else {
+      append(arena, &buffer, count);
+      buffer.length -= count;
+    }
+  }
+
+  return buffer.data + buffer.length;
+}
+
+void JsonWriter::_write(Slice<char> s) {
+  if (sink == nullptr) {
+    if (!s.empty()) {
+      memcpy(_reserve(s.length), s.data, s.length);
+      buffer.length += s.length;
+    }
+    return;
+  }
+
+  // Large writes are split between chunks
+  while (!s.empty()) {
+    if (buffer.length == buffer.capacity) {
+      flush();
+    }
+
+    size_t count = buffer.capacity - buffer.length;
+    count = count < s.length ? count : s.length;
+    memcpy(buffer.data + buffer.length, s.data, count);
+    buffer.length += count;
+    s.shrinkFromLeftByCount(count);
+  }
+}
+
+void JsonWriter::_writeString(Slice<char> s) {
+  static const char HEX[] = "0123456789abcdef";
+
+  _put('"');
+
+  while (true) {
+    // Copy the run of characters that don't need escaping at once
+    const size_t run = jsonFindStringSpecial(s);
+    _write(s.subarray(0, run));
+    if (run == s.length) {
+      break;
+    }
+
+    const u8 c = u8(s[run]);
+    char *dst = _reserve(6);
+    dst[0] = '\\';
+    size_t length = 2;
+    switch (c) {
+      case '"':
+      case '\\':
+        dst[1] = char(c);
+        break;
+      case '\b':
+        dst[1] = 'b';
+        break;
+      case '\f':
+        dst[1] = 'f';
+        break;
+      case '\n':
+        dst[1] = 'n';
+        break;
+      case '\r':
+        dst[1] = 'r';
+        break;
+      case '\t':
+        dst[1] = 't';
+        break;
+      default:
+        memcpy(dst + 1, "u00", 3);
+        dst[4] = HEX[c >> 4];
+        dst[5] = HEX[c & 0xF];
+        length = 6;
+        break;
+    }
+    buffer.length += length;
+    s.shrinkFromLeftByCount(run + 1);
+  }
+
+  _put('"');
+}
+
+void JsonWriter::_put(char c) {
+  *_reserve(1) = c;
+  buffer.length += 1;
+}
+
+void JsonWriter::_separate() {
+  if (needComma) {
+    _put(',');
+  }
+}
+
+Slice<char> writeJson(Arena *arena, const JsonValue &value) {
+  JsonWriter writer(arena);
+  writer.value(value);
+  return writer.output();
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "std/Arena.h"
+#include "std/Slice.hpp"
+#include "std/Types.h"
+#include "std/Vector.hpp"
+#include "std/json/Value.hpp"
+
+/** \brief Receives the output of a `JsonWriter` in chunks */
+struct JsonSink {
+  /** \returns false if the chunk couldn't be written */
+  virtual bool write(Slice<char> chunk) = 0;
+};
+
+/**
+ * \brief Writes JSON, either a `JsonValue` tree or value by value.
+ *
+ * The output either grows in a buffer in the arena, or it's handed to a
+ * `JsonSink` in chunks of at most `SINK_BUFFER_SIZE` bytes.
+ *
+ * Commas and colons are inserted automatically; calls must follow the
+ * structure of the document, e.g. every value in an object must be preceded
+ * by a `key`. The writer doesn't validate this.
+ *
+ * Strings must be valid UTF-8; only quotes, backslashes and control
+ * characters are escaped.
+ */
+struct JsonWriter {
+  static constexpr size_t SINK_BUFFER_SIZE = 16 * 1024;
+
+  Arena *arena;
+  /** \brief If null, the output accumulates in `buffer` */
+  JsonSink *sink;
+  Vector<char> buffer = {};
+  /** \brief Whether the next value or key has to be preceded by a comma */
+  bool needComma = false;
+  /** \brief Whether the sink has failed */
+  bool failed = false;
+
+  /** \brief Writes into a buffer allocated from `arena` */
+  explicit JsonWriter(Arena *arena) : arena(arena), sink(nullptr) {}
+  /** \brief Writes into `sink`; the buffer is allocated from `arena` */
+  JsonWriter(Arena *arena, JsonSink *sink);
+
+  void beginArray();
+  void endArray();
+  void beginObject();
+  void endObject();
+  void key(Slice<char> key);
+
+  void null();
+  void boolean(bool value);
+  /** \brief See `formatJsonNumber` */
+  void number(f64 value);
+  void integer(i64 value);
+  void unsignedInteger(u64 value);
+  void string(Slice<char> value);
+  /** \brief Writes a whole tree */
+  void value(const JsonValue &value);
+
+  /**
+   * \brief Hands the buffered output to the sink.
+   * \returns false if the sink has failed at any point
+   */
+  bool flush();
+
+  /** \brief The output written so far, when there is no sink */
+  Slice<char> output() const { return {buffer.data, buffer.length}; }
+
+  /** \brief Returns space for `count` bytes at the end of the buffer */
+  char *_reserve(size_t count);
+  void _put(char c);
+  void _write(Slice<char> s);
+  void _writeString(Slice<char> s);
+  /** \brief Writes the comma before a value or a key, if needed */
+  void _separate();
+};
+
+/** \brief Serializes the tree into a string allocated from `arena` */
+Slice<char> writeJson(Arena *arena, const JsonValue &value);
@@ -1,9 +1,12 @@
 #define _CRT_SECURE_NO_WARNINGS
 
+#include "std/Chronometry.h"
 #include "std/Path.hpp"
 #include "std/Slice.hpp"
 #include "std/SliceUtils.hpp"
+#include "std/Vector.hpp"
 #include "std/json/Parser.hpp"
+#include "std/json/Writer.hpp"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -316,9 +319,92 @@ static Arena makeArena() {
 
 static std::jmp_buf gJmpBuf;
 
+static bool tryReadTestFile(Arena *arena,
+                            Slice<char> pathRepo,
+                            Slice<char> filename,
+                            Slice<char> &out) {
+  Slice<char> pathTestFiles =
+      joinSimple(arena, pathRepo, sliceFromConstChar("test_parsing"));
+  Slice<char> pathFile = joinSimple(arena, pathTestFiles, filename);
+  Slice<char> z = concatZeroTerminate(arena, pathFile, {});
+
+  FILE *f = fopen(z.data, "rb");
+  if (!f) {
+    printf("Failed to open for reading: %s\n", z.data);
+    return false;
+  }
+  fseek(f, 0, SEEK_END);
+  long sizFile = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  MutSlice<char> bytes;
+  alloc(arena, sizFile, bytes);
+  fread(bytes.data, sizFile, 1, f);
+  fclose(f);
+
+  out = bytes;
+  return true;
+}
+
+/**
+ * \brief Measures the throughput of `tryParseValue` on the documents that must
+ * be accepted, and how many bytes it allocates for them.
+ */
+static void benchmark(Slice<char> pathRepo, Slice<Slice<char>> files) {
+  ArenaSaved s = getScratch(nullptr, 0);
+  Arena *temp = s.arena;
+
+  Vector<Slice<char>> docs = {};
+  size_t numBytes = 0;
+  for (auto [filename, _] : files) {
+    Slice<char> bytes;
+    if (filename[0] == 'y' &&
+        tryReadTestFile(temp, pathRepo, filename, bytes)) {
+      appendVal(temp, &docs, bytes);
+      numBytes += bytes.length;
+    }
+  }
+
+  // The trees are allocated from the other scratch arena; allocations grow
+  // down from its end
+  ArenaSaved out = getScratch(&temp, 1);
+  size_t numArenaBytes = 0;
+  f64 secondsBest = 0;
+  f64 secondsTotal = 0;
+  u32 numPasses = 0;
+  while (numPasses < 3 || secondsTotal < 0.5) {
+    TimePoint t0 = chrono_getCurrentTime();
+    for (size_t i = 0; i < docs.length; i++) {
+      Arena saved = *out.arena;
+      JsonValue root;
+      Slice<char> src = docs[i];
+      tryParseValue(out.arena, src, root);
+      if (numPasses == 0) {
+        numArenaBytes += size_t(saved.end - out.arena->end);
+      }
+      restoreArena(out.arena, saved);
+    }
+    TimePoint t1 = chrono_getCurrentTime();
+
+    f64 seconds = chrono_secondsBetween(t0, t1);
+    if (numPasses == 0 || seconds < secondsBest) {
+      secondsBest = seconds;
+    }
+    secondsTotal += seconds;
+    numPasses++;
+  }
+
+  printf("[ BNCH ] %zu documents, %zu bytes: %.2f MB/s, %.1f arena bytes "
+         "per document [%u passes]\n",
+         docs.length, numBytes, f64(numBytes) / secondsBest / 1e6,
+         f64(numArenaBytes) / f64(docs.length), numPasses);
+
+  restoreArena(out.arena, out.saved);
+  restoreArena(s.arena, s.saved);
+}
+
 int main(int argc, char **argv) {
   if (argc < 2) {
-    printf("Usage: %s path_to_JSONTestSuite\n", argv[0]);
+    printf("Usage: %s path_to_JSONTestSuite [--bench]\n", argv[0]);
     return 1;
   }
 
@@ -339,27 +425,13 @@ int main(int argc, char **argv) {
     ArenaSaved s = getScratch(nullptr, 0);
     Arena *temp = s.arena;
 
-    Slice<char> pathTestFiles =
-        joinSimple(temp, pathRepo, sliceFromConstChar("test_parsing"));
-    Slice<char> pathFile = joinSimple(temp, pathTestFiles, filename);
-    Slice<char> z = concatZeroTerminate(temp, pathFile, {});
-
-    FILE *f = fopen(z.data, "rb");
-    if (!f) {
-      printf("Failed to open for reading: %s\n", z.data);
+    Slice<char> cbytes;
+    if (!tryReadTestFile(temp, pathRepo, filename, cbytes)) {
       restoreArena(s.arena, s.saved);
       continue;
     }
-    fseek(f, 0, SEEK_END);
-    long sizFile = ftell(f);
-    fseek(f, 0, SEEK_SET);
-    MutSlice<char> bytes;
-    alloc(temp, sizFile, bytes);
-    fread(bytes.data, sizFile, 1, f);
-    fclose(f);
 
     JsonValue root;
-    Slice<char> cbytes = bytes;
     bool accepted;
     bool crashed = true;
     bool expected;
@@ -390,7 +462,19 @@ int main(int argc, char **argv) {
       }
     }
 
-    if (expected == accepted) {
+    // Accepted documents must survive a round trip through the writer
+    bool roundTrips = true;
+    if (accepted) {
+      Slice<char> written = writeJson(temp, root);
+      Slice<char> src = written;
+      JsonValue reparsed;
+      roundTrips = tryParseValue(temp, src, reparsed) &&
+                   writeJson(temp, reparsed) == written;
+    }
+
+    if (!roundTrips) {
+      printf("[ FAIL ] %.*s (round trip)\n", FMT_SLICE(filename));
+    } else if (expected == accepted) {
       printf("[  OK  ] %.*s\n", FMT_SLICE(filename));
     } else {
       printf("[ FAIL ] %.*s\n", FMT_SLICE(filename));
@@ -399,6 +483,12 @@ int main(int argc, char **argv) {
     restoreArena(s.arena, s.saved);
   }
 
+  if (argc > 2 && strcmp(argv[2], "--bench") == 0) {
+    arena0 = arena0Saved;
+    arena1 = arena1Saved;
+    benchmark(pathRepo, test_files);
+  }
+
   return 0;
 }
 
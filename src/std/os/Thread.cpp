@@ -20,15 +20,22 @@ struct WrapperInfo {
 
   ThreadEntryPoint entry;
   void *arg;
+  bool started;
 };
 
 static void *entryPointWrapper(void *arg) {
   auto *pInfo = reinterpret_cast<WrapperInfo *>(arg);
-  WrapperInfo info = *pInfo;
+  ThreadEntryPoint entry = pInfo->entry;
+  void *entryArg = pInfo->arg;
 
+  // The creator is blocked until we signal it; `pInfo` must not be touched
+  // after the lock has been released
+  pthread_mutex_lock(&pInfo->lock);
+  pInfo->started = true;
   pthread_cond_signal(&pInfo->flag);
+  pthread_mutex_unlock(&pInfo->lock);
 
-  info.entry(info.arg);
+  entry(entryArg);
   return 0;
 }
 
@@ -68,7 +75,8 @@ Result<Thread, ThreadError> Thread::create(const ThreadCreateInfo &info) {
     return ThreadError::ValidationFailure;
   }
 
-  WrapperInfo wrapperInfo = {.entry = info.entryPoint, .arg = info.param};
+  WrapperInfo wrapperInfo = {
+      .entry = info.entryPoint, .arg = info.param, .started = false};
 
   int rc;
 
@@ -92,8 +100,10 @@ Result<Thread, ThreadError> Thread::create(const ThreadCreateInfo &info) {
     return ThreadError::ValidationFailure;
   }
 
-  rc = pthread_cond_wait(&wrapperInfo.flag, &wrapperInfo.lock);
-  DCHECK(rc == 0);
+  while (!wrapperInfo.started) {
+    rc = pthread_cond_wait(&wrapperInfo.flag, &wrapperInfo.lock);
+    DCHECK(rc == 0);
+  }
   rc = pthread_mutex_unlock(&wrapperInfo.lock);
   DCHECK(rc == 0);
   rc = pthread_cond_destroy(&wrapperInfo.flag);
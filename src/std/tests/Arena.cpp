@@ -131,6 +131,100 @@ SN_TEST(Arena, alignment) {
   CHECK((ptrB & 255) == 0);
 }
 
+SN_TEST(GrowableArena, createDestroy) {
+  Arena arena = createGrowableArena(1024 * 1024);
+  CHECK(arena.reserveBeg != nullptr);
+  CHECK(arena.reserveBeg < arena.reserveEnd);
+  // Nothing is committed yet
+  CHECK(arena.beg == arena.end);
+
+  destroyGrowableArena(&arena);
+  CHECK(arena.reserveBeg == nullptr);
+}
+
+SN_TEST(GrowableArena, growsOnDemand) {
+  Arena arena = createGrowableArena(256 * 1024 * 1024);
+  CHECK(arena.reserveBeg != nullptr);
+
+  // Allocate way more than the commit granularity; every byte must be writable
+  for (u32 i = 0; i < 64; i++) {
+    u8 *bytes = alloc<u8>(&arena, 1024 * 1024);
+    CHECK(bytes != nullptr);
+    CHECK(bytes[0] == 0);
+    CHECK(bytes[1024 * 1024 - 1] == 0);
+    bytes[0] = 1;
+    bytes[1024 * 1024 - 1] = 1;
+  }
+
+  CHECK(size_t(arena.reserveEnd - arena.end) >= 64 * 1024 * 1024);
+  CHECK(arena.reserveBeg <= arena.beg);
+  CHECK(arena.beg <= arena.end);
+
+  destroyGrowableArena(&arena);
+}
+
+SN_TEST(GrowableArena, scopeDecommitsReleasedPages) {
+  Arena arena = createGrowableArena(256 * 1024 * 1024);
+
+  u8 *first = alloc<u8>(&arena, 64);
+  CHECK(first != nullptr);
+  const Arena saved = arena;
+
+  {
+    Arena::Scope temp = &arena;
+    for (u32 i = 0; i < 32; i++) {
+      alloc<u8>(temp, 1024 * 1024);
+    }
+    CHECK(size_t(arena.reserveEnd - arena.beg) >= 32 * 1024 * 1024);
+  }
+
+  // Allocation state is restored and most of the pages committed during the
+  // burst are released
+  CHECK(arena.end == saved.end);
+  CHECK(size_t(saved.beg - arena.beg) <= 64 * 1024);
+
+  // The arena can grow again after a decommit
+  u8 *bytes = alloc<u8>(&arena, 8 * 1024 * 1024);
+  CHECK(bytes != nullptr);
+  CHECK(bytes[0] == 0);
+
+  destroyGrowableArena(&arena);
+}
+
+SN_TEST(GrowableArena, outOfOrderRestore) {
+  Arena arena = createGrowableArena(64 * 1024 * 1024);
+  const Arena empty = arena;
+
+  u8 *bytes = alloc<u8>(&arena, 4 * 1024 * 1024);
+  const Arena grown = arena;
+  restoreArena(&arena, empty);
+
+  // Restoring to a state with more committed memory recommits the pages
+  restoreArena(&arena, grown);
+  bytes[0] = 1;
+  bytes[4 * 1024 * 1024 - 1] = 1;
+
+  destroyGrowableArena(&arena);
+}
+
+SN_TEST(GrowableArena, alignment) {
+  Arena arena = createGrowableArena(16 * 1024 * 1024);
+
+  for (size_t align = 1; align <= 4096; align *= 2) {
+    uintptr_t ptr = (uintptr_t)alloc(&arena, 3, align, 5);
+    CHECK((ptr & (align - 1)) == 0);
+  }
+
+  destroyGrowableArena(&arena);
+}
+
+SN_TEST_MUST_FAIL(GrowableArena, callsHandleOomWhenReservationIsExhausted) {
+  Arena arena = createGrowableArena(1024 * 1024);
+  CHECK(arena.reserveBeg != nullptr);
+
+  alloc<u8>(&arena, 2 * 1024 * 1024);
+}
+
 static constexpr u64 a =
     6364136223846793005ULL; /* see TAOCP Vol 2, 3.3.4, page 108 */
 static constexpr u64 c = 9754186451795953191ULL; /* some random start value */
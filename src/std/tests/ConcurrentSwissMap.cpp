@@ -0,0 +1,97 @@
+#include <std/ConcurrentSwissMap.hpp>
+#include <std/Parallel.hpp>
+#include <std/Testing.hpp>
+#include <std/WorkerPool.hpp>
+
+#include <atomic>
+
+SN_TEST(ConcurrentSwissMap, insertGet) {
+  Arena::Scope temp;
+
+  ConcurrentSwissMap<u32, u32> map(temp, 100);
+  CHECK(map.numGroups == 16);
+  CHECK(map.get(1) == nullptr);
+
+  bool inserted = false;
+  u32 *value = map.insert(1, 10, &inserted);
+  CHECK(inserted);
+  CHECK(*value == 10);
+
+  // The existing value is kept
+  CHECK(map.insert(1, 20, &inserted) == value);
+  CHECK(!inserted);
+  CHECK(*map.get(1) == 10);
+
+  for (u32 i = 2; i <= 100; i++) {
+    CHECK(*map.insert(i, i * 10) == i * 10);
+  }
+  for (u32 i = 1; i <= 100; i++) {
+    CHECK(*map.get(i) == i * 10);
+  }
+  CHECK(map.get(101) == nullptr);
+}
+
+SN_TEST(ConcurrentSwissMap, full) {
+  Arena::Scope temp;
+
+  // One group of eight slots
+  ConcurrentSwissMap<u32, u32> map(temp, 4);
+  CHECK(map.numGroups == 1);
+  for (u32 i = 0; i < 8; i++) {
+    CHECK(map.insert(i, i) != nullptr);
+  }
+
+  bool inserted = true;
+  CHECK(map.insert(8, 8, &inserted) == nullptr);
+  CHECK(!inserted);
+  CHECK(map.get(8) == nullptr);
+  // Keys that are present can still be found
+  CHECK(*map.insert(3, 0) == 3);
+  for (u32 i = 0; i < 8; i++) {
+    CHECK(*map.get(i) == i);
+  }
+}
+
+SN_TEST(ConcurrentSwissMap, concurrentInsertsDeduplicate) {
+  Arena arena = createGrowableArena(64 * 1024 * 1024);
+  CHECK(arena.reserveBeg != nullptr);
+
+  WorkerPoolCreateInfo createInfo = {
+      .numThreads = 4,
+      .workerInitializer = {},
+      .scheduler = WorkerPoolScheduler::WorkStealing,
+      .workerScratchSize = 1024 * 1024,
+  };
+  WorkerPool *wp = createWorkerPool(&arena, createInfo);
+
+  // Every task inserts all keys, in a different order
+  const u32 numKeys = 20000;
+  const size_t numTasks = 8;
+  ConcurrentSwissMap<u32, u32> map(&arena, numKeys);
+  std::atomic<u32> numInserted(0);
+  impl::parallelTasks(wp, numTasks, [&](size_t idxTask) {
+    u32 n = 0;
+    for (u32 i = 0; i < numKeys; i++) {
+      u32 key = (i * 7919 + u32(idxTask) * 104729) % numKeys;
+      bool inserted;
+      u32 *value = map.insert(key, key + 1, &inserted);
+      CHECK(value != nullptr);
+      CHECK(*value == key + 1);
+      n += inserted ? 1 : 0;
+
+      value = map.get(key);
+      CHECK(value != nullptr);
+      CHECK(*value == key + 1);
+    }
+    numInserted.fetch_add(n);
+  });
+
+  CHECK(numInserted.load() == numKeys);
+  for (u32 i = 0; i < numKeys; i++) {
+    CHECK(*map.get(i) == i + 1);
+  }
+  CHECK(map.get(numKeys) == nullptr);
+
+  wp->shutdown();
+  destroyGrowableArena(&arena);
+}
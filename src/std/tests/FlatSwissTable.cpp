@@ -0,0 +1,229 @@
+#include <std/FlatSwissTable.hpp>
+#include <std/Testing.hpp>
+
+SN_TEST(FlatSwissTable, hasKey16) {
+  alignas(16) u8 group[16] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+                              0x01, 0x02, 0x03, 0x04, 0x80, 0xFE, 0x80, 0x7F};
+
+  CHECK(impl::hasKey16(group, 0x01) == 0x0101);
+  CHECK(impl::hasKey16(group, 0x08) == 0x0080);
+  CHECK(impl::hasKey16(group, 0x7F) == 0x8000);
+  CHECK(impl::hasKey16(group, 0x10) == 0x0000);
+  CHECK(impl::unusedSlots16(group) == 0x5000);
+  CHECK(impl::emptySlots16(group) == 0x7000);
+}
+
+SN_TEST(FlatSwissTable, putGet) {
+  Arena::Scope temp;
+
+  FlatSwissTable<char, u64> table(temp);
+  CHECK(table.get(sliceFrom("key")) == nullptr);
+  CHECK(!table.remove(sliceFrom("key")));
+
+  u64 *slot0 = table.put(sliceFrom("key"), 123);
+  CHECK(slot0 != nullptr);
+  CHECK(*slot0 == 123);
+
+  u64 *slot1 = table.put(sliceFrom("key"), 456);
+  CHECK(slot1 == slot0);
+  CHECK(*table.get(sliceFrom("key")) == 456);
+  CHECK(table.numEntries == 1);
+
+  CHECK(table.remove(sliceFrom("key")));
+  CHECK(table.get(sliceFrom("key")) == nullptr);
+  CHECK(!table.remove(sliceFrom("key")));
+  CHECK(table.numEntries == 0);
+}
+
+SN_TEST(FlatSwissTable, grow) {
+  Arena::Scope temp;
+
+  FlatSwissTable<u32, u32> table(temp);
+  for (u32 i = 0; i < 1500; i++) {
+    table.put(i, i * 3);
+  }
+
+  CHECK(table.numEntries == 1500);
+  // Load factor is at most 7/8
+  CHECK(table._capacity() == 2048);
+  for (u32 i = 0; i < 1500; i++) {
+    u32 *slot = table.get(i);
+    CHECK(slot != nullptr);
+    CHECK(*slot == i * 3);
+  }
+  for (u32 i = 1500; i < 3000; i++) {
+    CHECK(table.get(i) == nullptr);
+  }
+}
+
+SN_TEST(FlatSwissTable, keysOfDifferentLengths) {
+  Arena::Scope temp;
+
+  FlatSwissTable<char, u32> table(temp);
+  table.put(sliceFrom("a"), 1);
+  table.put(sliceFrom("ab"), 2);
+  table.put(sliceFrom(""), 3);
+  table.remove(sliceFrom("ab"));
+  // May reuse the key storage of the removed entry
+  table.put(sliceFrom("b"), 4);
+  table.put(sliceFrom("abcdef"), 5);
+
+  CHECK(*table.get(sliceFrom("a")) == 1);
+  CHECK(table.get(sliceFrom("ab")) == nullptr);
+  CHECK(*table.get(sliceFrom("")) == 3);
+  CHECK(*table.get(sliceFrom("b")) == 4);
+  CHECK(*table.get(sliceFrom("abcdef")) == 5);
+}
+
+SN_TEST(FlatSwissTable, tombstones) {
+  Arena::Scope temp;
+
+  // Fill more groups than one, so that removals must leave tombstones behind
+  FlatSwissTable<u32, u32> table(temp);
+  for (u32 i = 0; i < 100; i++) {
+    table.put(i, i);
+  }
+  for (u32 i = 0; i < 100; i += 2) {
+    CHECK(table.remove(i));
+  }
+  for (u32 i = 0; i < 100; i++) {
+    u32 *slot = table.get(i);
+    CHECK((slot != nullptr) == (i % 2 == 1));
+  }
+  for (u32 i = 0; i < 100; i += 2) {
+    table.put(i, i + 1);
+  }
+  for (u32 i = 0; i < 100; i++) {
+    CHECK(*table.get(i) == i + (i % 2 == 0 ? 1 : 0));
+  }
+  CHECK(table.numEntries == 100);
+}
+
+SN_TEST(FlatSwissTable, randomMatchesSwissTable) {
+  // Perform the same random operations on both tables and compare them
+  u64 x = 2113148651ULL;
+  auto next = [&x]() {
+    // xorshift64
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return x;
+  };
+
+  for (u32 round = 0; round < 8; round++) {
+    Arena::Scope temp;
+    FlatSwissTable<u32, u32> flat(temp);
+    SwissTable<u32, u32> reference(temp);
+    size_t numEntries = 0;
+
+    for (u32 i = 0; i < 1 << 13; i++) {
+      u32 key = u32(next() % 512);
+      switch (next() % 3) {
+        case 0: {
+          u32 *expected = reference.get(key);
+          u32 *slot = flat.get(key);
+          CHECK((expected == nullptr) == (slot == nullptr));
+          if (slot != nullptr) {
+            CHECK(*slot == *expected);
+          }
+          break;
+        }
+        case 1: {
+          u32 value = u32(next());
+          numEntries += reference.get(key) == nullptr ? 1 : 0;
+          reference.put(key, value);
+          CHECK(*flat.put(key, value) == value);
+          break;
+        }
+        default: {
+          bool wasPresent = reference.remove(key);
+          numEntries -= wasPresent ? 1 : 0;
+          CHECK(flat.remove(key) == wasPresent);
+          break;
+        }
+      }
+
+      CHECK(flat.numEntries == numEntries);
+    }
+  }
+}
+
+SN_TEST(FlatSwissTable, tombstonesAreReclaimedWithoutGrowing) {
+  Arena::Scope temp;
+
+  // At most 48 keys are present at any time
+  FlatSwissTable<u32, u32> table(temp);
+  for (u32 i = 0; i < 4000; i++) {
+    table.put(i, i);
+    if (i >= 48) {
+      CHECK(table.remove(i - 48));
+    }
+  }
+
+  CHECK(table.numEntries == 48);
+  CHECK(table.numGroups <= 8);
+  for (u32 i = 0; i < 4000; i++) {
+    u32 *slot = table.get(i);
+    CHECK((slot != nullptr) == (i >= 4000 - 48));
+    if (slot != nullptr) {
+      CHECK(*slot == i);
+    }
+  }
+}
+
+SN_TEST(FlatSwissTable, reserve) {
+  Arena::Scope temp;
+
+  FlatSwissTable<u32, u32> table(temp);
+  table.put(1000u, 1000);
+  table.reserve(1000);
+  u32 *first = table.get(1000u);
+  const size_t numGroups = table.numGroups;
+  CHECK(numGroups == 128);
+
+  for (u32 i = 0; i < 1000; i++) {
+    table.put(i, i);
+  }
+  CHECK(table.numGroups == numGroups);
+  // Nothing was moved
+  CHECK(table.get(1000u) == first);
+  for (u32 i = 0; i <= 1000; i++) {
+    CHECK(*table.get(i) == i);
+  }
+}
+
+SN_TEST(FlatSwissTable, getBatch) {
+  // The large table is big enough for getBatch to prefetch
+  for (u32 n : {u32(300), u32(30000)}) {
+    Arena arena = createGrowableArena(64 * 1024 * 1024);
+    CHECK(arena.reserveBeg != nullptr);
+
+    FlatSwissTable<u32, u32> table(&arena);
+    u32 *ids = alloc<u32>(&arena, n);
+    MutSlice<Slice<u32>> keys;
+    MutSlice<u32 *> values;
+    alloc(&arena, n, keys);
+    alloc(&arena, n, values);
+    for (u32 i = 0; i < n; i++) {
+      ids[i] = i;
+      keys[i] = ids[i];
+    }
+
+    table.getBatch(keys, values);
+    for (u32 i = 0; i < n; i++) {
+      CHECK(values[i] == nullptr);
+    }
+
+    for (u32 i = 0; i < n; i += 3) {
+      table.put(ids[i], i + 7);
+    }
+
+    table.getBatch(keys, values);
+    for (u32 i = 0; i < n; i++) {
+      CHECK(values[i] == table.get(ids[i]));
+      CHECK((values[i] != nullptr) == (i % 3 == 0));
+    }
+
+    destroyGrowableArena(&arena);
+  }
+}
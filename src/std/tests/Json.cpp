@@ -1,10 +1,22 @@
 ﻿#include "std/Testing.hpp"
 
+#include "std/SliceUtils.hpp"
+#include "std/Vector.hpp"
+#include "std/WorkerPool.hpp"
+#include "std/json/Cursor.hpp"
+#include "std/json/Index.hpp"
+#include "std/json/Ndjson.hpp"
+#include "std/json/Number.hpp"
 #include "std/json/Parser.hpp"
+#include "std/json/Scanner.hpp"
+#include "std/json/Stream.hpp"
+#include "std/json/Tape.hpp"
 #include "std/json/Utils.hpp"
 #include "std/json/Value.hpp"
+#include "std/json/Writer.hpp"
 
 #include <math.h>
+#include <stdio.h>
 
 #define CHECK_STR(Var, Literal) \
   CHECK((Var) == Slice<char>(sliceFromConstChar(Literal)))
@@ -378,6 +390,271 @@ SN_TEST(JsonParser, ObjectExtraComma) {
   CHECK(!rc);
 }
 
+SN_TEST(JsonScanner, Tokens) {
+  Slice<char> src = sliceFromConstChar("{\"a\\\"]\": [12, true],\"\" :null}");
+  JsonScanner scanner(src);
+
+  const size_t expected[] = {0, 1, 7, 9, 10, 12, 14, 18, 19, 20, 23, 24, 28};
+  for (size_t pos : expected) {
+    size_t actual;
+    CHECK(scanner.next(actual));
+    CHECK(actual == pos);
+  }
+
+  size_t actual;
+  CHECK(!scanner.next(actual));
+}
+
+SN_TEST(JsonScanner, EscapesAcrossBlocks) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  // Every alignment of a run of backslashes against the block boundary
+  for (size_t numBackslashes = 1; numBackslashes <= 4; numBackslashes++) {
+    for (size_t prefix = 50; prefix < 70; prefix++) {
+      Vector<char> src;
+      appendVal(temp, &src, '[');
+      appendVal(temp, &src, '"');
+      for (size_t i = 0; i < prefix; i++) {
+        appendVal(temp, &src, 'x');
+      }
+      for (size_t i = 0; i < numBackslashes; i++) {
+        appendVal(temp, &src, '\\');
+      }
+      // Odd number of backslashes: the quote is escaped
+      if (numBackslashes % 2 == 1) {
+        appendVal(temp, &src, '"');
+      }
+      appendVal(temp, &src, '"');
+      appendVal(temp, &src, ',');
+      appendVal(temp, &src, '1');
+      appendVal(temp, &src, ']');
+
+      JsonValue res;
+      Slice<char> json = {src.data, src.length};
+      CHECK(tryParseValue(temp, json, res));
+      CHECK(res.type == JsonType::Array);
+      CHECK(res.array().length == 2);
+      Slice<char> str = res.array()[0].string();
+      CHECK(str.length == prefix + (numBackslashes + 1) / 2);
+      CHECK(str[str.length - 1] == (numBackslashes % 2 == 1 ? '"' : '\\'));
+      CHECK(res.array()[1].number == 1);
+    }
+  }
+}
+
+SN_TEST(JsonParser, StringEscapes) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  JsonValue res;
+  Slice<char> src =
+      sliceFromConstChar("\"a\\nb\\\\c\\\"d\\u0041\\/\\t0123456789abcdef\"");
+  bool rc = tryParseValue(temp, src, res);
+  CHECK(rc);
+  CHECK(res.type == JsonType::String);
+  CHECK_STR(res.string(), "a\nb\\c\"dA/\t0123456789abcdef");
+}
+
+SN_TEST(JsonParser, StringInvalidEscape) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  JsonValue res;
+  Slice<char> src = sliceFromConstChar("[\"0123456789abcdef\\x\"]");
+  bool rc = tryParseValue(temp, src, res);
+  CHECK(!rc);
+}
+
+SN_TEST(JsonParser, StringZeroCopy) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  const char *json = "{\"key\": [\"plain\", \"esc\\\"aped\"]}";
+  const Slice<char> input = fromCStr(json);
+  auto isInInput = [&](Slice<char> s) {
+    return input.data <= s.data && s.data + s.length <= input.data + input.length;
+  };
+
+  JsonValue res;
+  Slice<char> src = input;
+  CHECK(tryParseValue(temp, src, res));
+  CHECK(isInInput(res.object()[0].key));
+  Slice<JsonValue> arr = res.object()[0].value.array();
+  CHECK(isInInput(arr[0].string()));
+  CHECK(!isInInput(arr[1].string()));
+  CHECK_STR(arr[1].string(), "esc\"aped");
+
+  src = input;
+  CHECK(tryParseValue(temp, src, res, JSON_PARSE_COPY_STRINGS));
+  CHECK(!isInInput(res.object()[0].key));
+  arr = res.object()[0].value.array();
+  CHECK(!isInInput(arr[0].string()));
+  CHECK_STR(arr[0].string(), "plain");
+}
+
+SN_TEST(JsonParser, UnescapedCtrlCharLongString) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  JsonValue res;
+  Slice<char> src = sliceFromConstChar("[\"0123456789abcdef0123\n45\"]");
+  bool rc = tryParseValue(temp, src, res);
+  CHECK(!rc);
+}
+
+SN_TEST(JsonParser, DeeplyNested) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  const size_t depth = 1000;
+  Vector<char> src;
+  for (size_t i = 0; i < depth; i++) {
+    appendVal(temp, &src, '[');
+  }
+  for (size_t i = 0; i < depth; i++) {
+    appendVal(temp, &src, ']');
+  }
+
+  JsonValue res;
+  Slice<char> json = {src.data, src.length};
+  CHECK(tryParseValue(temp, json, res));
+
+  const JsonValue *v = &res;
+  for (size_t i = 1; i < depth; i++) {
+    CHECK(v->type == JsonType::Array);
+    CHECK(v->length == 1);
+    v = &v->arr[0];
+  }
+  CHECK(v->type == JsonType::Array);
+  CHECK(v->length == 0);
+}
+
+SN_TEST(JsonParser, ManyObjects) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  // Long enough for the scanner to refill many times
+  const Slice<char> element =
+      sliceFromConstChar("{\"id\": 7, \"name\": \"x\\ty\", \"tags\": []},\n");
+  const size_t count = 300;
+  Vector<char> src;
+  appendVal(temp, &src, '[');
+  for (size_t i = 0; i < count; i++) {
+    size_t length = i + 1 < count ? element.length : element.length - 2;
+    copyElements(append(temp, &src, length), element.data, length);
+  }
+  appendVal(temp, &src, ']');
+
+  JsonValue res;
+  Slice<char> json = {src.data, src.length};
+  CHECK(tryParseValue(temp, json, res));
+  CHECK(res.type == JsonType::Array);
+  CHECK(res.length == count);
+  for (auto [obj, _] : res.array()) {
+    CHECK(obj.type == JsonType::Object);
+    CHECK(obj.length == 3);
+    CHECK(getKeyValue(&obj, sliceFromConstChar("id"))->number == 7);
+    CHECK_STR(getKeyValue(&obj, sliceFromConstChar("name"))->string(),
+              "x\ty");
+    CHECK(getKeyValue(&obj, sliceFromConstChar("tags"))->length == 0);
+  }
+}
+
+SN_TEST(JsonParser, ValuePrefix) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  // The overload with a temp arena parses a value off the front of the input
+  JsonValue res;
+  Slice<char> src = sliceFromConstChar("  [true] \n{}");
+  CHECK(tryParseValue(temp, temp, src, res));
+  CHECK(res.type == JsonType::Array);
+  CHECK_STR(src, "{}");
+  CHECK(tryParseValue(temp, temp, src, res));
+  CHECK(res.type == JsonType::Object);
+  CHECK(src.empty());
+}
+
+static f64 parseNumber(Arena *arena, const char *literal, u32 flags = 0) {
+  JsonValue res;
+  Slice<char> src = fromCStr(literal);
+  CHECK(tryParseValue(arena, src, res, flags));
+  CHECK(res.type == JsonType::Number);
+  return res.number;
+}
+
+SN_TEST(JsonParser, NumberCorrectlyRounded) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  // Literals are rounded correctly by the compiler
+  CHECK(parseNumber(temp, "0.1") == 0.1);
+  CHECK(parseNumber(temp, "123") == 123.0);
+  CHECK(parseNumber(temp, "-0.3e-2") == -0.3e-2);
+  CHECK(parseNumber(temp, "1e23") == 1e23);
+  CHECK(parseNumber(temp, "8.41e21") == 8.41e21);
+  CHECK(parseNumber(temp, "7.038531e-26") == 7.038531e-26);
+  CHECK(parseNumber(temp, "9007199254740993") == 9007199254740993.0);
+  CHECK(parseNumber(temp, "1.7976931348623157e308") ==
+        1.7976931348623157e308);
+  CHECK(parseNumber(temp, "2.2250738585072011e-308") ==
+        2.2250738585072011e-308);
+  CHECK(parseNumber(temp, "4.9406564584124654e-324") ==
+        4.9406564584124654e-324);
+  CHECK(parseNumber(temp, "2.4703282292062328e-324") ==
+        2.4703282292062328e-324);
+  CHECK(parseNumber(temp, "2.4703282292062327e-324") == 0.0);
+  CHECK(parseNumber(temp, "1.8e308") == INFINITY);
+  CHECK(parseNumber(temp, "0.000000000000000000000000000000000001") ==
+        1e-36);
+  CHECK(parseNumber(temp, "-0") == 0.0);
+  CHECK(signbit(parseNumber(temp, "-0")));
+}
+
+SN_TEST(JsonParser, NumberLongMantissa) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  // More digits than fit into a u64; halfway between 2^53 and 2^53 + 2,
+  // so every digit matters
+  CHECK(parseNumber(temp, "9007199254740993.0000000000000000000000000001") ==
+        9007199254740994.0);
+  CHECK(parseNumber(temp, "9007199254740993.0000000000000000000000000000") ==
+        9007199254740992.0);
+  CHECK(parseNumber(temp, "3.14159265358979323846264338327950288419716939") ==
+        3.14159265358979323846264338327950288419716939);
+  CHECK(parseNumber(temp, "123456789012345678901234567890") ==
+        123456789012345678901234567890.0);
+}
+
+SN_TEST(JsonParser, NumberIntegers) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  JsonValue res;
+  Slice<char> src = sliceFromConstChar(
+      "[9007199254740993, -9223372036854775808, 18446744073709551615, "
+      "18446744073709551616, 1.0, -0, 7]");
+  CHECK(tryParseValue(temp, src, res, JSON_PARSE_INTEGERS));
+  Slice<JsonValue> elems = res.array();
+  CHECK(elems.length == 7);
+
+  CHECK(elems[0].type == JsonType::Integer);
+  CHECK(elems[0].integer == 9007199254740993);
+  CHECK(elems[1].type == JsonType::Integer);
+  CHECK(elems[1].integer == INT64_MIN);
+  CHECK(elems[2].type == JsonType::UnsignedInteger);
+  CHECK(elems[2].uinteger == UINT64_MAX);
+  // Doesn't fit into a u64
+  CHECK(elems[3].type == JsonType::Number);
+  CHECK(elems[3].number == 18446744073709551616.0);
+  CHECK(elems[4].type == JsonType::Number);
+  CHECK(elems[5].type == JsonType::Number);
+
+  for (auto [e, _] : elems) {
+    CHECK(isNumeric(e));
+  }
+  CHECK(asNumeric<i64>(elems[6]) == 7);
+  CHECK(asNumeric<f64>(elems[6]) == 7.0);
+  CHECK(coerceToF32(elems[6]) == 7.0f);
+
+  // Without the flag every number is an f64
+  src = sliceFromConstChar("9007199254740993");
+  CHECK(tryParseValue(temp, src, res));
+  CHECK(res.type == JsonType::Number);
+  CHECK(res.number == 9007199254740992.0);
+}
+
 SN_TEST(JsonUtils, GetKeyValue) {
   Arena::Scope temp = getScratch(nullptr, 0);
 
@@ -432,3 +709,766 @@ SN_TEST(JsonUtils, GetKeyValueOfType) {
       getKeyValueOfType(&res, sliceFromConstChar("arr"), JsonType::Object);
   CHECK(v_invalid == nullptr);
 }
+
+namespace {
+/** \brief Writes the events into a string, one token per event */
+struct EventLog : JsonEventHandler {
+  Arena *arena;
+  Vector<char> log = {};
+
+  explicit EventLog(Arena *arena) : arena(arena) {}
+
+  void write(Slice<char> s) {
+    memcpy(append(arena, &log, s.length), s.data, s.length);
+    appendVal(arena, &log, ' ');
+  }
+
+  bool onScalar(const JsonValue &value) override {
+    char buf[64];
+    switch (value.type) {
+      case JsonType::Null:
+        write(sliceFromConstChar("null"));
+        break;
+      case JsonType::True:
+        write(sliceFromConstChar("true"));
+        break;
+      case JsonType::False:
+        write(sliceFromConstChar("false"));
+        break;
+      case JsonType::String:
+        appendVal(arena, &log, '=');
+        write(value.string());
+        break;
+      default:
+        snprintf(buf, sizeof(buf), "%g", value.number);
+        write(fromCStr(buf));
+        break;
+    }
+    return true;
+  }
+
+  bool onKey(Slice<char> key) override {
+    write(key);
+    appendVal(arena, &log, ':');
+    return true;
+  }
+
+  bool onBeginArray() override {
+    write(sliceFromConstChar("["));
+    return true;
+  }
+  bool onEndArray() override {
+    write(sliceFromConstChar("]"));
+    return true;
+  }
+  bool onBeginObject() override {
+    write(sliceFromConstChar("{"));
+    return true;
+  }
+  bool onEndObject() override {
+    write(sliceFromConstChar("}"));
+    return true;
+  }
+
+  Slice<char> string() const { return {log.data, log.length}; }
+};
+}  // namespace
+
+SN_TEST(JsonStream, Events) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  EventLog events(temp);
+  JsonStreamParser parser(temp, &events);
+  CHECK(parser.feed(sliceFromConstChar(
+      "{\"a\": [1, -2.5e1, \"x\\ty\"], \"b\": {}, \"c\": [null, true, false]}")));
+  CHECK(parser.finish());
+  CHECK_STR(events.string(),
+            "{ a :[ 1 -25 =x\ty ] b :{ } c :[ null true false ] } ");
+}
+
+SN_TEST(JsonStream, SplitAnywhere) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  const Slice<char> json = sliceFromConstChar(
+      "[{\"key\\\"1\": \"value \\u039B\"}, 123456.75, true, [[]]] 42 \"s\"");
+  EventLog whole(temp);
+  {
+    JsonStreamParser parser(temp, &whole);
+    CHECK(parser.feed(json));
+    CHECK(parser.finish());
+  }
+
+  // Every possible split into two chunks
+  for (size_t i = 0; i <= json.length; i++) {
+    Arena::Scope arena = getScratch(&temp.arena, 1);
+    EventLog events(arena);
+    JsonStreamParser parser(arena, &events);
+    CHECK(parser.feed(json.subarray(0, i)));
+    CHECK(parser.feed(json.subarray(i)));
+    CHECK(parser.finish());
+    CHECK(events.string() == whole.string());
+  }
+
+  // One byte at a time
+  EventLog events(temp);
+  JsonStreamParser parser(temp, &events);
+  for (size_t i = 0; i < json.length; i++) {
+    CHECK(parser.feed(json.subarray(i, i + 1)));
+  }
+  CHECK(parser.finish());
+  CHECK(events.string() == whole.string());
+}
+
+SN_TEST(JsonStream, Invalid) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  const char *invalid[] = {
+      "[1,]", "{\"a\" 1}", "{1: 2}", "[1 2]", "]", "[\"a\nb\"]", "tru",
+      "[1}",  "[",        "{\"a\":", "\"abc", "1.",  "[nul]",
+  };
+  for (const char *json : invalid) {
+    EventLog events(temp);
+    JsonStreamParser parser(temp, &events);
+    CHECK(!(parser.feed(fromCStr(json)) && parser.finish()));
+  }
+}
+
+namespace {
+struct RecordLog : JsonRecordHandler {
+  size_t numRecords = 0;
+  f64 sum = 0;
+  size_t numInvalid = 0;
+
+  bool onRecord(const JsonValue &value, size_t) override {
+    CHECK(value.type == JsonType::Object);
+    CHECK_STR(value.object()[0].key, "n");
+    CHECK(value.object()[0].value.type == JsonType::Number);
+    sum += value.object()[0].value.number;
+    numRecords++;
+    return true;
+  }
+
+  bool onInvalidRecord(Slice<char>, size_t idxLine) override {
+    CHECK(idxLine == 3);
+    numInvalid++;
+    return true;
+  }
+};
+}  // namespace
+
+SN_TEST(JsonStream, Ndjson) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  Arena::Scope records = getScratch(&temp.arena, 1);
+  const Arena recordArenaBefore = *records.arena;
+
+  const Slice<char> ndjson = sliceFromConstChar(
+      "{\"n\": 1, \"s\": \"one\"}\n"
+      "{\"n\": 2, \"s\": [\"two\"]}\r\n"
+      "\n"
+      "{\"n\": \n"
+      "{\"n\": 4}");
+
+  for (size_t chunkSize = 1; chunkSize <= ndjson.length; chunkSize++) {
+    RecordLog log;
+    JsonNdjsonReader reader(temp, records, &log);
+    for (size_t i = 0; i < ndjson.length; i += chunkSize) {
+      CHECK(reader.feed(ndjson.subarray(i, i + chunkSize)));
+    }
+    CHECK(reader.finish());
+    CHECK(log.numRecords == 3);
+    CHECK(log.numInvalid == 1);
+    CHECK(log.sum == 7);
+    // The record arena is reset after every record
+    CHECK(records.arena->end == recordArenaBefore.end);
+  }
+}
+
+SN_TEST(JsonScanner, Newlines) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  // Long enough to overflow the 8-bit counters of the vectorized count
+  MutSlice<char> s;
+  alloc(temp, 16 * 300 + 7, s);
+  size_t expected = 0;
+  u32 x = 1;
+  for (size_t i = 0; i < s.length; i++) {
+    x = x * 1103515245 + 12345;
+    s[i] = (x >> 16) % 3 == 0 ? '\n' : 'a';
+    expected += s[i] == '\n';
+  }
+  CHECK(jsonCountNewlines(s) == expected);
+
+  for (size_t i = 0; i < 40; i++) {
+    s[i] = 'a';
+  }
+  s[37] = '\n';
+  CHECK(jsonFindNewline(s) == 37);
+  CHECK(jsonFindNewline(s.subarray(0, 37)) == 37);
+}
+
+SN_TEST(JsonNdjson, ParallelInOrder) {
+  Arena arena = createGrowableArena(16 * 1024 * 1024);
+  CHECK(arena.reserveBeg != nullptr);
+
+  // Record `i` is `{"i": i, "s": "..."}`, with some blank lines in between
+  const size_t NUM_RECORDS = 2000;
+  Vector<char> ndjson = {};
+  char buf[64];
+  for (size_t i = 0; i < NUM_RECORDS; i++) {
+    int length = snprintf(buf, sizeof(buf), "{\"i\": %zu, \"s\": \"r%zu\"}\n%s",
+                          i, i, i % 7 == 0 ? "\r\n" : "");
+    memcpy(append(&arena, &ndjson, length), buf, length);
+  }
+  const Slice<char> input = {ndjson.data, ndjson.length};
+
+  WorkerPoolCreateInfo createInfo = {
+      .numThreads = 3,
+      .workerInitializer = {},
+      .scheduler = WorkerPoolScheduler::WorkStealing,
+      .workerScratchSize = 1024 * 1024,
+  };
+  WorkerPool *wp = createWorkerPool(&arena, createInfo);
+
+  Arena threadArenas[4];
+  Arena *pThreadArenas[4];
+  for (u32 i = 0; i < 4; i++) {
+    threadArenas[i] = createGrowableArena(16 * 1024 * 1024);
+    pThreadArenas[i] = &threadArenas[i];
+  }
+
+  for (WorkerPool *pool : {wp, (WorkerPool *)nullptr}) {
+    for (size_t grainSize : {size_t(0), size_t(100), size_t(1000)}) {
+      Slice<JsonValue> records;
+      CHECK(tryParseNdjson(pool, &arena, sliceFrom(pThreadArenas), input,
+                           records, 0, grainSize));
+      CHECK(records.length == NUM_RECORDS);
+      for (size_t i = 0; i < records.length; i++) {
+        Slice<JsonKeyValue> kvs = records[i].object();
+        CHECK(kvs[0].value.number == f64(i));
+        snprintf(buf, sizeof(buf), "r%zu", i);
+        CHECK(kvs[1].value.string() == fromCStr(buf));
+      }
+    }
+  }
+
+  Slice<JsonValue> records;
+  CHECK(!tryParseNdjson(wp, &arena, sliceFrom(pThreadArenas),
+                        sliceFromConstChar("{}\n[1,\n{}\n"), records, 0, 1));
+
+  wp->shutdown();
+  for (u32 i = 0; i < 4; i++) {
+    destroyGrowableArena(&threadArenas[i]);
+  }
+  destroyGrowableArena(&arena);
+}
+
+static Slice<char> formatNumber(char *buf, f64 value) {
+  return {buf, formatJsonNumber(buf, value)};
+}
+
+SN_TEST(JsonWriter, NumbersShortest) {
+  char buf[JSON_NUMBER_MAX_LENGTH];
+  CHECK_STR(formatNumber(buf, 0.0), "0");
+  CHECK_STR(formatNumber(buf, -0.0), "-0");
+  CHECK_STR(formatNumber(buf, 1.0), "1");
+  CHECK_STR(formatNumber(buf, -1.5), "-1.5");
+  CHECK_STR(formatNumber(buf, 0.1), "0.1");
+  CHECK_STR(formatNumber(buf, 0.1 + 0.2), "0.30000000000000004");
+  CHECK_STR(formatNumber(buf, 1e20), "100000000000000000000");
+  CHECK_STR(formatNumber(buf, 1e21), "1e+21");
+  CHECK_STR(formatNumber(buf, 1.25e-6), "0.00000125");
+  CHECK_STR(formatNumber(buf, 1e-7), "1e-7");
+  CHECK_STR(formatNumber(buf, 9007199254740993.0), "9007199254740992");
+  CHECK_STR(formatNumber(buf, 5e-324), "5e-324");
+  CHECK_STR(formatNumber(buf, 2.2250738585072014e-308),
+            "2.2250738585072014e-308");
+  CHECK_STR(formatNumber(buf, 1.7976931348623157e308),
+            "1.7976931348623157e+308");
+  CHECK_STR(formatNumber(buf, -123456.789e-20), "-1.23456789e-15");
+  CHECK_STR(formatNumber(buf, NAN), "null");
+  CHECK_STR(formatNumber(buf, -INFINITY), "null");
+
+  CHECK_STR(Slice<char>(buf, formatJsonInteger(buf, INT64_MIN)),
+            "-9223372036854775808");
+  CHECK_STR(Slice<char>(buf, formatJsonUnsignedInteger(buf, UINT64_MAX)),
+            "18446744073709551615");
+}
+
+SN_TEST(JsonWriter, NumbersRoundTrip) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  char buf[JSON_NUMBER_MAX_LENGTH];
+  u64 x = 1;
+  for (u32 i = 0; i < 10000; i++) {
+    // xorshift64; skip NaNs and infinities
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    f64 expected;
+    memcpy(&expected, &x, sizeof(expected));
+    if (!isfinite(expected)) {
+      continue;
+    }
+
+    JsonValue value;
+    Slice<char> src = formatNumber(buf, expected);
+    CHECK(tryParseValue(temp, src, value));
+    CHECK(memcmp(&value.number, &expected, sizeof(expected)) == 0);
+  }
+}
+
+SN_TEST(JsonWriter, Tree) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  const char *json =
+      "{\"a\":[1,-2.5,true,false,null,{},[]],\"b\\\"\":\"x\\n\\u0001\\\\\","
+      "\"c\":{\"d\":[[\"\"]]},\"e\":18446744073709551615}";
+  JsonValue value;
+  Slice<char> src = fromCStr(json);
+  CHECK(tryParseValue(temp, src, value, JSON_PARSE_INTEGERS));
+  CHECK(writeJson(temp, value) == fromCStr(json));
+}
+
+SN_TEST(JsonWriter, EscapeLongString) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  // Every special character after a run that is long enough to be scanned
+  // with vectors
+  Vector<char> s = {};
+  for (u32 c = 0; c < 0x80; c++) {
+    for (u32 i = 0; i < 20; i++) {
+      appendVal(temp.arena, &s, 'a');
+    }
+    appendVal(temp.arena, &s, char(c));
+  }
+  const Slice<char> expected = {s.data, s.length};
+
+  JsonWriter writer(temp);
+  writer.string(expected);
+
+  JsonValue value;
+  Slice<char> src = writer.output();
+  CHECK(tryParseValue(temp, src, value));
+  CHECK(value.string() == expected);
+}
+
+namespace {
+struct ChunkCollector : JsonSink {
+  Arena *arena;
+  Vector<char> out = {};
+  size_t numChunks = 0;
+
+  bool write(Slice<char> chunk) override {
+    CHECK(chunk.length <= JsonWriter::SINK_BUFFER_SIZE);
+    memcpy(append(arena, &out, chunk.length), chunk.data, chunk.length);
+    numChunks++;
+    return true;
+  }
+};
+}  // namespace
+
+SN_TEST(JsonWriter, Sink) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  const size_t length = JsonWriter::SINK_BUFFER_SIZE + 1000;
+  char *chars = allocNZ<char>(temp, length);
+  for (size_t i = 0; i < length; i++) {
+    chars[i] = i % 64 == 0 ? '"' : 'x';
+  }
+  const Slice<char> big = {chars, length};
+
+  ChunkCollector sink;
+  sink.arena = temp;
+  JsonWriter writer(temp, &sink);
+  writer.beginArray();
+  writer.string(big);
+  writer.number(1);
+  writer.endArray();
+  CHECK(writer.flush());
+  CHECK(sink.numChunks >= 2);
+
+  JsonWriter expected(temp);
+  expected.beginArray();
+  expected.string(big);
+  expected.number(1);
+  expected.endArray();
+  CHECK(Slice<char>(sink.out.data, sink.out.length) == expected.output());
+}
+
+/** \brief An object with `numKeys` keys `"k0"`... and values 0... */
+static Slice<char> makeWideObject(Arena *arena, u32 numKeys) {
+  Vector<char> json = {};
+  appendVal(arena, &json, '{');
+  for (u32 i = 0; i < numKeys; i++) {
+    char buf[32];
+    int n = snprintf(buf, sizeof(buf), "%s\"k%u\":%u", i ? "," : "", i, i);
+    memcpy(append(arena, &json, size_t(n)), buf, size_t(n));
+  }
+  appendVal(arena, &json, '}');
+  return {json.data, json.length};
+}
+
+static void checkWideObject(JsonValue *obj, u32 numKeys) {
+  for (u32 i = 0; i < numKeys; i++) {
+    char buf[16];
+    int n = snprintf(buf, sizeof(buf), "k%u", i);
+    JsonValue *value = getKeyValue(obj, {buf, size_t(n)});
+    CHECK(value != nullptr);
+    CHECK(value->number == i);
+  }
+  CHECK(getKeyValue(obj, sliceFromConstChar("missing")) == nullptr);
+  CHECK(getKeyValue(obj, sliceFromConstChar("k")) == nullptr);
+}
+
+SN_TEST(JsonIndex, ParseFlag) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  JsonValue value;
+  Slice<char> src = makeWideObject(temp, 300);
+  CHECK(tryParseValue(temp, src, value, JSON_PARSE_INDEX_OBJECTS));
+  CHECK(value.indexed);
+  checkWideObject(&value, 300);
+
+  // Small objects are searched linearly
+  src = makeWideObject(temp, JSON_INDEX_MIN_KEYS - 1);
+  CHECK(tryParseValue(temp, src, value, JSON_PARSE_INDEX_OBJECTS));
+  CHECK(!value.indexed);
+  checkWideObject(&value, JSON_INDEX_MIN_KEYS - 1);
+}
+
+SN_TEST(JsonIndex, DuplicateKeys) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  // Like the linear search, the index finds the first of duplicate keys
+  Vector<char> json = {};
+  appendVal(temp.arena, &json, '[');
+  for (u32 i = 0; i < 40; i++) {
+    char buf[32];
+    int n = snprintf(buf, sizeof(buf), "%s\"k%u\":%u", i ? "," : "{", i % 8, i);
+    memcpy(append(temp.arena, &json, size_t(n)), buf, size_t(n));
+  }
+  appendVal(temp.arena, &json, '}');
+  appendVal(temp.arena, &json, ']');
+
+  JsonValue value;
+  Slice<char> src = {json.data, json.length};
+  CHECK(tryParseValue(temp, src, value));
+  JsonValue *obj = &value.arr[0];
+  CHECK(!obj->indexed);
+
+  JsonValue *expected[8];
+  for (u32 i = 0; i < 8; i++) {
+    char buf[16];
+    int n = snprintf(buf, sizeof(buf), "k%u", i);
+    expected[i] = getKeyValue(obj, {buf, size_t(n)});
+    CHECK(expected[i]->number == i);
+  }
+
+  indexJsonObjects(temp, value);
+  obj = &value.arr[0];
+  CHECK(obj->indexed);
+  for (u32 i = 0; i < 8; i++) {
+    char buf[16];
+    int n = snprintf(buf, sizeof(buf), "k%u", i);
+    JsonValue *found = getKeyValue(obj, {buf, size_t(n)});
+    CHECK(found->number == i);
+    // The key-values have been moved next to the index
+    CHECK(found != expected[i]);
+  }
+}
+
+SN_TEST(JsonIndex, Nested) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  Slice<char> inner = makeWideObject(temp, 50);
+  Vector<char> json = {};
+  const Slice<char> prefix = sliceFromConstChar("[{\"a\":[");
+  const Slice<char> suffix = sliceFromConstChar("]}]");
+  memcpy(append(temp.arena, &json, prefix.length), prefix.data, prefix.length);
+  memcpy(append(temp.arena, &json, inner.length), inner.data, inner.length);
+  memcpy(append(temp.arena, &json, suffix.length), suffix.data, suffix.length);
+
+  JsonValue value;
+  Slice<char> src = {json.data, json.length};
+  CHECK(tryParseValue(temp, src, value));
+  Slice<char> before = writeJson(temp, value);
+
+  indexJsonObjects(temp, value);
+  JsonValue *outer = &value.arr[0];
+  CHECK(!outer->indexed);
+  JsonValue *a = getKeyValue(outer, sliceFromConstChar("a"));
+  CHECK(a != nullptr && a->arr[0].indexed);
+  checkWideObject(&a->arr[0], 50);
+  CHECK(writeJson(temp, value) == before);
+}
+
+static const char *CURSOR_DOCUMENT =
+    "{\"a\": {\"x\": [1, 2, {\"y\": \"}]\"}], \"z\": null},"
+    " \"b\": \"s\\\"tr\", \"c\": [true, [], {}],"
+    " \"d\": 12.5, \"e\\u0041\": \"escaped key\"}";
+
+SN_TEST(JsonCursor, FindKeys) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  JsonCursor cursor(fromCStr(CURSOR_DOCUMENT));
+  u32 root;
+  CHECK(cursor.tryEnterObject(root));
+
+  // Skips "a", "b" and "c" without decoding them
+  const Arena before = *temp.arena;
+  f64 d;
+  CHECK(cursor.findKey(root, sliceFromConstChar("d")));
+  CHECK(cursor.tryReadNumber(d));
+  CHECK(d == 12.5);
+  CHECK(temp.arena->end == before.end);
+
+  Slice<char> e;
+  CHECK(cursor.findKey(root, sliceFromConstChar("eA")));
+  CHECK(cursor.tryReadString(temp, e));
+  CHECK_STR(e, "escaped key");
+
+  // Keys are only searched forward
+  CHECK(!cursor.findKey(root, sliceFromConstChar("a")));
+  CHECK(!cursor.failed);
+}
+
+SN_TEST(JsonCursor, Iterate) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  JsonCursor cursor(fromCStr(CURSOR_DOCUMENT));
+  u32 root;
+  CHECK(cursor.tryEnterObject(root));
+
+  Slice<char> key;
+  CHECK(cursor.nextKey(root, temp, key));
+  CHECK_STR(key, "a");
+  u32 a;
+  CHECK(cursor.tryEnterObject(a));
+  CHECK(cursor.nextKey(a, temp, key));
+  CHECK_STR(key, "x");
+  u32 x;
+  CHECK(cursor.tryEnterArray(x));
+  f64 sum = 0;
+  while (cursor.nextElement(x)) {
+    if (cursor.type() == JsonType::Number) {
+      f64 n;
+      CHECK(cursor.tryReadNumber(n));
+      sum += n;
+    }
+  }
+  CHECK(sum == 3);
+  // "z" is left unvisited
+
+  CHECK(cursor.nextKey(root, temp, key));
+  CHECK_STR(key, "b");
+  Slice<char> b;
+  CHECK(cursor.tryReadString(temp, b));
+  CHECK_STR(b, "s\"tr");
+
+  CHECK(cursor.nextKey(root, temp, key));
+  CHECK_STR(key, "c");
+  u32 c;
+  CHECK(cursor.tryEnterArray(c));
+  CHECK(cursor.nextElement(c));
+  CHECK(cursor.type() == JsonType::True);
+  // The rest of "c" is left unvisited
+
+  u32 numKeys = 0;
+  while (cursor.nextKey(root, temp, key)) {
+    numKeys++;
+  }
+  CHECK(numKeys == 2);
+  CHECK(!cursor.failed);
+  CHECK(cursor.pos == fromCStr(CURSOR_DOCUMENT).length);
+}
+
+SN_TEST(JsonCursor, ReadSubtree) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  JsonCursor cursor(fromCStr(CURSOR_DOCUMENT));
+  u32 root;
+  CHECK(cursor.tryEnterObject(root));
+  CHECK(cursor.findKey(root, sliceFromConstChar("a")));
+  JsonValue a;
+  CHECK(cursor.tryRead(temp, a));
+  CHECK(writeJson(temp, a) ==
+        fromCStr("{\"x\":[1,2,{\"y\":\"}]\"}],\"z\":null}"));
+
+  // A value can only be consumed once
+  CHECK(!cursor.tryRead(temp, a));
+  CHECK(cursor.failed);
+}
+
+SN_TEST(JsonCursor, Invalid) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  const char *cases[] = {
+      "{\"a\" 1}", "{\"a\": 1 \"b\": 2}", "[1,]", "[1", "{1: 2}", "[1}",
+  };
+  for (const char *json : cases) {
+    JsonCursor cursor(fromCStr(json));
+    u32 level;
+    Slice<char> key;
+    if (cursor.type() == JsonType::Array) {
+      CHECK(cursor.tryEnterArray(level));
+      while (cursor.nextElement(level)) {
+        JsonValue value;
+        cursor.tryRead(temp, value);
+      }
+    } else {
+      CHECK(cursor.tryEnterObject(level));
+      while (cursor.nextKey(level, temp, key)) {
+      }
+    }
+    CHECK(cursor.failed);
+  }
+
+  // Skipped values are only checked for balanced brackets
+  JsonCursor cursor(fromCStr("[[1 2 garbage], 3]"));
+  u32 level;
+  f64 n;
+  CHECK(cursor.tryEnterArray(level));
+  CHECK(cursor.nextElement(level));
+  CHECK(cursor.nextElement(level));
+  CHECK(cursor.tryReadNumber(n));
+  CHECK(n == 3);
+  CHECK(!cursor.nextElement(level));
+  CHECK(!cursor.failed);
+}
+
+/** \brief Compares a tape node with the same value parsed into a tree */
+static bool tapeEquals(JsonTapeValue node, const JsonValue &value) {
+  if (node.type() != value.type) {
+    return false;
+  }
+
+  switch (value.type) {
+    case JsonType::Number:
+      return node.number() == value.number;
+    case JsonType::Integer:
+      return node.integer() == value.integer;
+    case JsonType::UnsignedInteger:
+      return node.uinteger() == value.uinteger;
+    case JsonType::String:
+      return node.string() == value.string();
+    case JsonType::Array: {
+      JsonTapeValue it = node.begin();
+      for (size_t i = 0; i < value.length; i++, it = it.next()) {
+        if (it.isEnd() || !tapeEquals(it, value.arr[i])) {
+          return false;
+        }
+      }
+      return it.isEnd() && node.length() == value.length;
+    }
+    case JsonType::Object: {
+      JsonTapeValue it = node.begin();
+      for (size_t i = 0; i < value.length; i++, it = it.next().next()) {
+        if (it.isEnd() || it.string() != value.kv[i].key ||
+            !tapeEquals(it.next(), value.kv[i].value)) {
+          return false;
+        }
+      }
+      return it.isEnd() && node.length() == value.length;
+    }
+    default:
+      return true;
+  }
+}
+
+SN_TEST(JsonTape, Layout) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  JsonTape tape;
+  CHECK(tryParseJsonTape(temp, sliceFromConstChar("[1, \"ab\", {\"k\": null}]"),
+                         tape));
+
+  const u64 words[] = {
+      (u64('[') << 56) | (u64(3) << 32) | 9,
+      u64('d') << 56,
+      0x3FF0000000000000,
+      (u64('"') << 56) | 0,
+      (u64('{') << 56) | (u64(1) << 32) | 8,
+      (u64('"') << 56) | 6,
+      u64('n') << 56,
+      (u64('}') << 56) | 4,
+      (u64(']') << 56) | 0,
+  };
+  CHECK(tape.words.length == 9);
+  for (size_t i = 0; i < 9; i++) {
+    CHECK(tape.words[i] == words[i]);
+  }
+  CHECK(tape.strings.length == 4 + 2 + 4 + 1);
+}
+
+SN_TEST(JsonTape, SameAsTree) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  const char *docs[] = {
+      CURSOR_DOCUMENT,
+      "[]",
+      "{}",
+      "\"top\"",
+      "-0.5",
+      "[[[]], [{}], {\"a\": [{\"b\": {}}]}, \"\", \"\\u00e9\\n\"]",
+      "[9223372036854775807, -9223372036854775808, 18446744073709551615]",
+  };
+  for (const char *doc : docs) {
+    for (u32 flags : {0u, u32(JSON_PARSE_INTEGERS)}) {
+      JsonTape tape;
+      CHECK(tryParseJsonTape(temp, fromCStr(doc), tape, flags));
+
+      JsonValue value;
+      Slice<char> src = fromCStr(doc);
+      CHECK(tryParseValue(temp, src, value, flags));
+      CHECK(tapeEquals(jsonTapeRoot(tape), value));
+      CHECK(jsonTapeRoot(tape).next().idx == tape.words.length);
+    }
+  }
+
+  JsonTape tape;
+  CHECK(tryParseJsonTape(temp, fromCStr(CURSOR_DOCUMENT), tape));
+  JsonTapeValue d;
+  CHECK(jsonTapeRoot(tape).tryGetKeyValue(sliceFromConstChar("d"), d));
+  CHECK(d.number() == 12.5);
+  CHECK(!jsonTapeRoot(tape).tryGetKeyValue(sliceFromConstChar("x"), d));
+}
+
+SN_TEST(JsonTape, Load) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  JsonTape tape;
+  CHECK(tryParseJsonTape(temp, fromCStr(CURSOR_DOCUMENT), tape));
+
+  // As if it was read from a file
+  u64 *buffer = alloc<u64>(temp, tape.bytes.length / 8 + 1);
+  u8 *bytes = reinterpret_cast<u8 *>(buffer);
+  memcpy(bytes, tape.bytes.data, tape.bytes.length);
+
+  JsonTape loaded;
+  CHECK(tryLoadJsonTape({bytes, tape.bytes.length}, loaded));
+  JsonValue value;
+  Slice<char> src = fromCStr(CURSOR_DOCUMENT);
+  CHECK(tryParseValue(temp, src, value));
+  CHECK(tapeEquals(jsonTapeRoot(loaded), value));
+
+  // Truncated, misaligned and foreign bytes are rejected
+  CHECK(!tryLoadJsonTape({bytes, tape.bytes.length - 1}, loaded));
+  CHECK(!tryLoadJsonTape({bytes, 8}, loaded));
+  memmove(bytes + 1, bytes, tape.bytes.length);
+  CHECK(!tryLoadJsonTape({bytes + 1, tape.bytes.length}, loaded));
+  memmove(bytes, bytes + 1, tape.bytes.length);
+  bytes[0] ^= 1;
+  CHECK(!tryLoadJsonTape({bytes, tape.bytes.length}, loaded));
+}
+
+SN_TEST(JsonTape, Invalid) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  const char *cases[] = {
+      "", "[1,]", "[1", "{\"a\" 1}", "{1: 2}", "[1}", "[] []", "tru", "\"a",
+  };
+  for (const char *json : cases) {
+    JsonTape tape;
+    CHECK(!tryParseJsonTape(temp, fromCStr(json), tape));
+  }
+}
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2026 Daniel Meszaros
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <std/Parallel.hpp>
+#include <std/Sort.hpp>
+#include <std/Testing.hpp>
+#include <std/WorkerPool.hpp>
+
+#include <atomic>
+
+/**
+ * Calls `fn` with a pool of every scheduler kind, then with no pool at all.
+ * The workers of the pools have scratch arenas.
+ */
+template <typename Fn>
+static void forEachPool(const Fn &fn) {
+  for (WorkerPoolScheduler scheduler :
+       {WorkerPoolScheduler::SignalTree, WorkerPoolScheduler::WorkStealing}) {
+    // The signal tree pool doesn't fit into the test arena next to the data
+    Arena arena = createGrowableArena(16 * 1024 * 1024);
+    CHECK(arena.reserveBeg != nullptr);
+
+    WorkerPoolCreateInfo createInfo = {
+        .numThreads = 3,
+        .workerInitializer = {},
+        .scheduler = scheduler,
+        .workerScratchSize = 1024 * 1024,
+    };
+    WorkerPool *wp = createWorkerPool(&arena, createInfo);
+    fn(wp);
+    wp->shutdown();
+
+    destroyGrowableArena(&arena);
+  }
+
+  fn(nullptr);
+}
+
+static void fillRandom(MutSlice<u32> s, u64 seed, u32 mod) {
+  u64 x = seed;
+  for (auto [elem, i] : s) {
+    // xorshift64
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    elem = u32(x >> 32) % mod;
+  }
+}
+
+SN_TEST(Parallel, forVisitsEveryElementOnce) {
+  forEachPool([](WorkerPool *wp) {
+    Arena::Scope temp = getScratch(nullptr, 0);
+    MutSlice<u32> s;
+    alloc(temp, 10007, s);
+
+    for (size_t grainSize : {size_t(0), size_t(1), size_t(100)}) {
+      parallelFor(
+          wp, s,
+          [](u32 &elem, size_t idx) {
+            CHECK(elem == 0);
+            elem = u32(idx) + 1;
+          },
+          grainSize);
+
+      for (auto [elem, i] : s) {
+        CHECK(elem == i + 1);
+        elem = 0;
+      }
+    }
+  });
+}
+
+SN_TEST(Parallel, forCanUseWorkerScratch) {
+  forEachPool([](WorkerPool *wp) {
+    Arena::Scope temp = getScratch(nullptr, 0);
+    MutSlice<u32> s;
+    alloc(temp, 5000, s);
+
+    parallelFor(
+        wp, s,
+        [](u32 &elem, size_t idx) {
+          Arena::Scope temp = getScratch(nullptr, 0);
+          u32 *digits = alloc<u32>(temp, 64);
+          digits[idx % 64] = u32(idx);
+          elem = digits[idx % 64];
+        },
+        64);
+
+    for (auto [elem, i] : s) {
+      CHECK(elem == i);
+    }
+  });
+}
+
+SN_TEST(Parallel, forBackToBackWithContinuations) {
+  forEachPool([](WorkerPool *wp) {
+    if (wp == nullptr) {
+      return;
+    }
+
+    Arena::Scope temp = getScratch(nullptr, 0);
+    MutSlice<u32> s;
+    alloc(temp, 64, s);
+
+    auto addOne = [](const Dispatch *D) {
+      D->parametersAs<std::atomic<u32>>().fetch_add(1);
+    };
+
+    // The contracts of every round, and of `parallelFor`, get the same
+    // addresses in the scratch arena as the ones of the previous round
+    for (u32 round = 0; round < 2000; round++) {
+      Arena::Scope temp = getScratch(nullptr, 0);
+      std::atomic<u32> counter = 0;
+      WorkContract *wcA = wp->createWorkContract(temp, addOne, 0, 1);
+      WorkContract *wcB = wp->createWorkContract(temp, addOne, 0, 1);
+      wp->dispatch(wcA, &counter, 8);
+      wp->dispatchAfter(temp, wcB, wcA, &counter, 8);
+
+      parallelFor(
+          wp, s, [round](u32 &elem, size_t) { elem = round; }, 1);
+
+      wp->release(wcB);
+      wp->release(wcA);
+      CHECK(counter.load() == 16);
+      for (auto [elem, _] : s) {
+        CHECK(elem == round);
+      }
+    }
+  });
+}
+
+SN_TEST(Parallel, reduceSum) {
+  forEachPool([](WorkerPool *wp) {
+    Arena::Scope temp = getScratch(nullptr, 0);
+    MutSlice<u64> s;
+    alloc(temp, 10000, s);
+    for (auto [elem, i] : s) {
+      elem = i + 1;
+    }
+
+    auto add = [](u64 lhs, u64 rhs) { return lhs + rhs; };
+    CHECK(parallelReduce<u64>(wp, s, 0, add) == 10000ull * 10001 / 2);
+    CHECK(parallelReduce<u64>(wp, s, 0, add, 7) == 10000ull * 10001 / 2);
+    CHECK(parallelReduce<u64>(wp, s.subarray(0, 0), 0, add) == 0);
+  });
+}
+
+SN_TEST(Parallel, reduceKeepsOrder) {
+  forEachPool([](WorkerPool *wp) {
+    Arena::Scope temp = getScratch(nullptr, 0);
+    MutSlice<u32> s;
+    alloc(temp, 10000, s);
+    s[4321] = 5;
+    s[4500] = 7;
+    s[9999] = 9;
+
+    // Associative, but not commutative
+    auto firstNonZero = [](u32 lhs, u32 rhs) { return lhs != 0 ? lhs : rhs; };
+    CHECK(parallelReduce<u32>(wp, s, 0, firstNonZero, 100) == 5);
+  });
+}
+
+SN_TEST(Parallel, scanMatchesSerial) {
+  forEachPool([](WorkerPool *wp) {
+    Arena::Scope temp = getScratch(nullptr, 0);
+    MutSlice<u32> src, dst;
+    alloc(temp, 9000, src);
+    alloc(temp, 9000, dst);
+    fillRandom(src, 1, 1000);
+
+    auto add = [](u32 lhs, u32 rhs) { return lhs + rhs; };
+    for (size_t grainSize : {size_t(0), size_t(1), size_t(333)}) {
+      parallelScan<u32>(wp, dst, src, 0, add, grainSize);
+
+      u32 acc = 0;
+      for (auto [elem, i] : src) {
+        acc += elem;
+        CHECK(dst[i] == acc);
+      }
+    }
+
+    // In place
+    parallelScan<u32>(wp, src, src, 0, add, 100);
+    for (auto [elem, i] : src) {
+      CHECK(elem == dst[i]);
+    }
+  });
+}
+
+SN_TEST(Parallel, mergeSortMatchesSerial) {
+  forEachPool([](WorkerPool *wp) {
+    for (size_t n : {size_t(0), size_t(1), size_t(2), size_t(513),
+                     size_t(4096), size_t(6007)}) {
+      for (u32 mod : {u32(7), u32(0xFFFFFFFF)}) {
+        Arena::Scope temp = getScratch(nullptr, 0);
+        MutSlice<u32> s, expected;
+        alloc(temp, n, s);
+        alloc(temp, n, expected);
+        fillRandom(s, n + 1, mod);
+        expected.copy(s);
+
+        mergeSort(expected);
+        parallelMergeSort(wp, s, impl::Less<u32>{}, 100);
+        CHECK(s == expected);
+      }
+    }
+  });
+}
+
+SN_TEST(Parallel, mergeSortCustomComparator) {
+  forEachPool([](WorkerPool *wp) {
+    Arena::Scope temp = getScratch(nullptr, 0);
+    MutSlice<u32> s;
+    alloc(temp, 5000, s);
+    fillRandom(s, 42, 1000);
+
+    auto greater = [](u32 lhs, u32 rhs) { return lhs > rhs; };
+    parallelMergeSort(wp, s, greater, 64);
+    for (size_t i = 1; i < s.length; i++) {
+      CHECK(s[i - 1] >= s[i]);
+    }
+
+    parallelMergeSort(wp, s);
+    for (size_t i = 1; i < s.length; i++) {
+      CHECK(s[i - 1] <= s[i]);
+    }
+  });
+}
@@ -44,6 +44,25 @@ SN_TEST(SegmentArray, push67) {
   }
 }
 
+SN_TEST(SegmentArray, popKeepsSegments) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  SegmentArray<u32> s(temp);
+
+  for (u32 i = 0; i < 67; i++) {
+    s.push(i);
+  }
+  CHECK(s.pop() == 66);
+  CHECK(s.pop() == 65);
+  CHECK(s.length == 65);
+  CHECK(s.numSegments == 2);
+
+  s.push(100);
+  CHECK(s.length == 66);
+  CHECK(s[65] == 100);
+  CHECK(s[64] == 64);
+}
+
 SN_TEST(SegmentArray, multiPush) {
   Arena::Scope temp = getScratch(nullptr, 0);
 
@@ -124,3 +143,21 @@ SN_TEST(SegmentArray, multiPushWithGrowNonEmpty) {
     CHECK(s[i] == buf[i - 1]);
   }
 }
+
+SN_TEST(SegmentArray, reserve) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  SegmentArray<u32> s(temp);
+  s.reserve(0);
+  CHECK(s.numSegments == 0);
+
+  s.reserve(65);
+  CHECK(s.numSegments == 2);
+  CHECK(s.length == 0);
+
+  for (u32 i = 0; i < 192; i++) {
+    s.push(i);
+  }
+  CHECK(s.numSegments == 2);
+  CHECK(s[191] == 191);
+}
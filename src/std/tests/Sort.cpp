@@ -1,8 +1,12 @@
 #include <std/Check.h>
 #include <std/Slice.hpp>
 #include <std/RadixSort.hpp>
+#include <std/RadixSortParallel.hpp>
 #include <std/Sort.hpp>
 #include <std/Testing.hpp>
+#include <std/WorkerPool.hpp>
+
+#include <math.h>
 
 SN_TEST(RadixSort_u32, emptySortSucceeds) {
   radixSort(0, nullptr, nullptr, (const u32*)nullptr);
@@ -44,6 +48,18 @@ SN_TEST(RadixSort_i32, sortSucceeds) {
   }
 }
 
+SN_TEST(RadixSort_i32, negativeKeysSortFirst) {
+  u32 indices[5] = {0, 1, 2, 3, 4};
+  i32 keys[5] = {7, -3, 0, -2147483647 - 1, 2147483647};
+  u32 temp[5];
+  const u32 indicesExpected[5] = {3, 1, 2, 0, 4};
+  radixSort(5, indices, temp, keys);
+
+  for (u32 i = 0; i < 5; i++) {
+    CHECK(indices[i] == indicesExpected[i]);
+  }
+}
+
 SN_TEST(RadixSort_u64, sortSucceeds) {
   u32 indices[4] = {0, 1, 2, 3};
   u64 keys[4] = {5264794389990322948ULL, 8773299985955849259ULL,
@@ -57,6 +73,185 @@ SN_TEST(RadixSort_u64, sortSucceeds) {
   }
 }
 
+/**
+ * Sorts the keys with the parallel radix sort, with and without a pool, and
+ * compares the result to the serial one.
+ */
+template <typename K>
+static void checkParallelRadixSort(Slice<K> keys) {
+  Arena poolArena = createGrowableArena(16 * 1024 * 1024);
+  CHECK(poolArena.reserveBeg != nullptr);
+  WorkerPool *wp = createWorkerPool(&poolArena, 3);
+
+  Arena::Scope temp = getScratch(nullptr, 0);
+  const u32 N = u32(keys.length);
+  u32 *expected = alloc<u32>(temp, N);
+  u32 *indices = alloc<u32>(temp, N);
+  u32 *scratch = alloc<u32>(temp, N);
+
+  for (u32 i = 0; i < N; i++) {
+    expected[i] = i;
+  }
+  radixSort(N, expected, scratch, keys.data);
+
+  for (WorkerPool *pool : {wp, (WorkerPool *)nullptr}) {
+    for (u32 i = 0; i < N; i++) {
+      indices[i] = i;
+    }
+    radixSort(pool, N, indices, scratch, keys.data);
+
+    for (u32 i = 0; i < N; i++) {
+      CHECK(indices[i] == expected[i]);
+    }
+  }
+
+  wp->shutdown();
+  destroyGrowableArena(&poolArena);
+}
+
+SN_TEST(RadixSortParallel, emptySortSucceeds) {
+  radixSort(nullptr, 0, nullptr, nullptr, (const u32 *)nullptr);
+}
+
+SN_TEST(RadixSortParallel, u32MatchesSerial) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  const u32 N = 5000;
+  u32 *keys = alloc<u32>(temp, N);
+
+  u32 x = 0x12345678;
+  for (u32 i = 0; i < N; i++) {
+    // xorshift32
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    keys[i] = x;
+  }
+  checkParallelRadixSort<u32>({keys, N});
+
+  // Lots of duplicates; only the lowest digit is non-trivial
+  for (u32 i = 0; i < N; i++) {
+    keys[i] = 0xAB000000 | (keys[i] & 0x7F);
+  }
+  checkParallelRadixSort<u32>({keys, N});
+
+  // Every digit is trivial
+  for (u32 i = 0; i < N; i++) {
+    keys[i] = 42;
+  }
+  checkParallelRadixSort<u32>({keys, N});
+}
+
+SN_TEST(RadixSortParallel, u64MatchesSerial) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  const u32 N = 5000;
+  u64 *keys = alloc<u64>(temp, N);
+
+  u64 x = 0x9E3779B97F4A7C15ull;
+  for (u32 i = 0; i < N; i++) {
+    // xorshift64
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    // Leave the middle digits trivial
+    keys[i] = x & 0xFF00000000FFFFFFull;
+  }
+  checkParallelRadixSort<u64>({keys, N});
+}
+
+/**
+ * Sorts the keys along with their original positions as values, then checks
+ * that the keys are ordered, that the sort was stable and that the values
+ * were moved with their keys.
+ */
+template <typename K>
+static void checkRadixSortKeyValue(Slice<K> input) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  MutSlice<K> keys, keysTemp;
+  MutSlice<u32> values, valuesTemp;
+  alloc(temp, input.length, keys);
+  alloc(temp, input.length, keysTemp);
+  alloc(temp, input.length, values);
+  alloc(temp, input.length, valuesTemp);
+
+  keys.copy(input);
+  for (auto [value, i] : values) {
+    value = u32(i);
+  }
+
+  radixSort(keys, values, keysTemp, valuesTemp);
+
+  for (size_t i = 0; i < keys.length; i++) {
+    CHECK(keys[i] == input[values[i]]);
+    if (i != 0) {
+      CHECK(keys[i - 1] <= keys[i]);
+      CHECK(keys[i - 1] < keys[i] || values[i - 1] < values[i]);
+    }
+  }
+
+  // Keys only
+  keys.copy(input);
+  radixSort(keys, keysTemp);
+  for (size_t i = 1; i < keys.length; i++) {
+    CHECK(keys[i - 1] <= keys[i]);
+  }
+}
+
+SN_TEST(RadixSortKeyValue, unsignedKeys) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  const u32 N = 3000;
+  MutSlice<u32> keys32;
+  MutSlice<u64> keys64;
+  alloc(temp, N, keys32);
+  alloc(temp, N, keys64);
+
+  u64 x = 0x9E3779B97F4A7C15ull;
+  for (u32 i = 0; i < N; i++) {
+    // xorshift64
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    keys32[i] = u32(x >> 32);
+    keys64[i] = x;
+  }
+  checkRadixSortKeyValue<u32>(keys32);
+  checkRadixSortKeyValue<u64>(keys64);
+
+  // Few distinct keys; every pass but the first one is trivial
+  for (u32 i = 0; i < N; i++) {
+    keys32[i] %= 17;
+    keys64[i] %= 17;
+  }
+  checkRadixSortKeyValue<u32>(keys32);
+  checkRadixSortKeyValue<u64>(keys64);
+}
+
+SN_TEST(RadixSortKeyValue, signedKeys) {
+  const i32 keys32[] = {5,  -1, 0,         2147483647, -2147483647 - 1,
+                        -1, 42, -1000000, 0,          1000000};
+  const i64 keys64[] = {5,  -1, 0,     9223372036854775807ll,
+                        -9223372036854775807ll - 1,
+                        -1, 42, -1ll << 40, 0, 1ll << 40};
+  checkRadixSortKeyValue<i32>(sliceFrom(keys32));
+  checkRadixSortKeyValue<i64>(sliceFrom(keys64));
+}
+
+SN_TEST(RadixSortKeyValue, floatKeys) {
+  const f32 keys32[] = {1.5f,  -0.25f, 0.0f,  -1e30f, 1e30f, -1.5f,
+                        1e-40f, -1e-40f, 3.0f, -0.25f, 1.5f};
+  const f64 keys64[] = {1.5,   -0.25,  0.0,  -1e300, 1e300, -1.5,
+                        1e-310, -1e-310, 3.0, -0.25, 1.5};
+  checkRadixSortKeyValue<f32>(sliceFrom(keys32));
+  checkRadixSortKeyValue<f64>(sliceFrom(keys64));
+}
+
+SN_TEST(RadixSortKeyValue, negativeZeroGoesFirst) {
+  f32 keys[2] = {0.0f, -0.0f};
+  f32 keysTemp[2];
+  radixSort(sliceFrom(keys), sliceFrom(keysTemp));
+  CHECK(signbit(keys[0]));
+  CHECK(!signbit(keys[1]));
+}
+
 SN_TEST(MergeSort, emptySortSucceeds) {
   MutSlice<u32> src, dst;
   mergeSort(dst, src);
@@ -215,3 +410,142 @@ SN_TEST(MergeSort_ComparableStruct, customCmpByConstRefSucceeds) {
     CHECK(elems[i + 1] < elems[i]);
   }
 }
+
+namespace {
+struct KeyAndSeq {
+  u32 key;
+  u32 seq;
+};
+}  // namespace
+
+enum class SortInputKind {
+  Random,
+  Sorted,
+  Reversed,
+  FewUnique,
+  OrganPipe,
+};
+
+static void fillSortInput(MutSlice<KeyAndSeq> s, SortInputKind kind) {
+  u32 x = 0xC0FFEE;
+  for (auto [elem, i] : s) {
+    // xorshift32
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+
+    switch (kind) {
+      case SortInputKind::Random:
+        elem.key = x;
+        break;
+      case SortInputKind::Sorted:
+        elem.key = u32(i);
+        break;
+      case SortInputKind::Reversed:
+        elem.key = u32(s.length - i);
+        break;
+      case SortInputKind::FewUnique:
+        elem.key = x % 5;
+        break;
+      case SortInputKind::OrganPipe:
+        elem.key = u32(i < s.length / 2 ? i : s.length - i);
+        break;
+    }
+    elem.seq = u32(i);
+  }
+}
+
+static bool compareKeys(const KeyAndSeq &lhs, const KeyAndSeq &rhs) {
+  return lhs.key < rhs.key;
+}
+
+/** Checks that the keys are ordered, and if `isStable`, the sequence too. */
+static void checkSorted(Slice<KeyAndSeq> s, bool isStable) {
+  u64 sumSeq = 0;
+  for (size_t i = 0; i < s.length; i++) {
+    sumSeq += s[i].seq;
+    if (i == 0) {
+      continue;
+    }
+
+    CHECK(s[i - 1].key <= s[i].key);
+    if (isStable && s[i - 1].key == s[i].key) {
+      CHECK(s[i - 1].seq < s[i].seq);
+    }
+  }
+
+  // Every element is still there
+  CHECK(sumSeq == u64(s.length) * (s.length - 1) / 2 || s.length == 0);
+}
+
+SN_TEST(HybridSort, sortsEveryDistribution) {
+  for (SortInputKind kind :
+       {SortInputKind::Random, SortInputKind::Sorted, SortInputKind::Reversed,
+        SortInputKind::FewUnique, SortInputKind::OrganPipe}) {
+    for (size_t n : {size_t(0), size_t(1), size_t(2), size_t(23), size_t(33),
+                     size_t(100), size_t(1000), size_t(4099)}) {
+      Arena::Scope temp = getScratch(nullptr, 0);
+      MutSlice<KeyAndSeq> s;
+      alloc(temp, n, s);
+
+      fillSortInput(s, kind);
+      stableSort(s, compareKeys);
+      checkSorted(s, true);
+
+      fillSortInput(s, kind);
+      mergeSort(s, compareKeys);
+      checkSorted(s, true);
+
+      fillSortInput(s, kind);
+      unstableSort(s, compareKeys);
+      checkSorted(s, false);
+    }
+  }
+}
+
+SN_TEST(HybridSort, stableSortWithBuffer) {
+  KeyAndSeq elems[200];
+  KeyAndSeq buffer[100];
+  fillSortInput(sliceFrom(elems), SortInputKind::FewUnique);
+  stableSort(sliceFrom(elems), sliceFrom(buffer), compareKeys);
+  checkSorted(sliceFrom(elems), true);
+}
+
+SN_TEST(HybridSort, mergeSortIntoDstIsStable) {
+  KeyAndSeq src[300];
+  KeyAndSeq dst[300];
+  fillSortInput(sliceFrom(src), SortInputKind::FewUnique);
+  mergeSort(sliceFrom(dst), sliceFrom(src), compareKeys);
+  checkSorted(sliceFrom(dst), true);
+}
+
+SN_TEST(HybridSort, heapSortFallback) {
+  KeyAndSeq elems[500];
+  fillSortInput(sliceFrom(elems), SortInputKind::Random);
+  // Run out of recursion depth right away
+  impl::unstableSort<KeyAndSeq>(elems, elems + 500, nullptr, 0, compareKeys);
+  checkSorted(sliceFrom(elems), false);
+}
+
+SN_TEST(HybridSort, unstableSortDefaultComparator) {
+  u32 keys[64];
+  for (u32 i = 0; i < 64; i++) {
+    keys[i] = (i * 37) % 64;
+  }
+  unstableSort(sliceFrom(keys));
+  for (u32 i = 0; i < 64; i++) {
+    CHECK(keys[i] == i);
+  }
+}
+
+SN_TEST(HybridSort, stableSortWithBufferDefaultComparator) {
+  u32 keys[200];
+  u32 buffer[100];
+  for (u32 i = 0; i < 200; i++) {
+    keys[i] = (i * 37) % 200;
+  }
+  stableSort(sliceFrom(keys), sliceFrom(buffer));
+  for (u32 i = 0; i < 200; i++) {
+    CHECK(keys[i] == i);
+  }
+}
@@ -0,0 +1,232 @@
+#include <std/SwissMap.hpp>
+#include <std/SwissTable.hpp>
+#include <std/Testing.hpp>
+#include <std/Uuid.hpp>
+
+// No operator==; compared by its bytes
+struct SwissMapPodKey {
+  u32 a;
+  u16 b;
+  u16 c;
+};
+
+enum class SwissMapEnumKey : u8 { A, B, C };
+
+// Puts every key into the same group
+struct SwissMapConstantHash {
+  u64 operator()(u32) const { return 0x1234; }
+};
+
+SN_TEST(SwissMap, hashMixSpreadsSequentialKeys) {
+  // Sequential keys must not share the few control bytes an identity hash
+  // would give them
+  HashMix<u64> hash;
+  bool seenH2[128] = {};
+  u32 numDistinct = 0;
+  for (u64 i = 0; i < 64; i++) {
+    u8 h2 = hash(i) & 0x7F;
+    numDistinct += seenH2[h2] ? 0 : 1;
+    seenH2[h2] = true;
+  }
+  CHECK(numDistinct >= 32);
+}
+
+SN_TEST(SwissMap, integerKeys) {
+  Arena::Scope temp;
+
+  SwissMap<u64, u32> map(temp);
+  CHECK(map.get(1) == nullptr);
+  CHECK(!map.remove(1));
+
+  for (u64 i = 0; i < 1000; i++) {
+    CHECK(*map.put(i << 32, u32(i)) == i);
+  }
+  CHECK(map.numEntries == 1000);
+
+  CHECK(*map.put(u64(5) << 32, 123) == 123);
+  CHECK(map.numEntries == 1000);
+
+  for (u64 i = 0; i < 1000; i += 2) {
+    CHECK(map.remove(i << 32));
+  }
+  for (u64 i = 0; i < 1000; i++) {
+    u32 *value = map.get(i << 32);
+    if (i % 2 == 0) {
+      CHECK(value == nullptr);
+    } else {
+      CHECK(value != nullptr);
+      CHECK(*value == (i == 5 ? 123 : i));
+    }
+  }
+}
+
+SN_TEST(SwissMap, uuidKeys) {
+  Arena::Scope temp;
+
+  SwissMap<Uuid, u32> map(temp);
+  for (u32 i = 0; i < 200; i++) {
+    map.put(Uuid(Uuid::Version4{}, i, u16(i), i * 7919), i);
+  }
+
+  for (u32 i = 0; i < 200; i++) {
+    u32 *value = map.get(Uuid(Uuid::Version4{}, i, u16(i), i * 7919));
+    CHECK(value != nullptr);
+    CHECK(*value == i);
+  }
+  CHECK(map.get(Uuid()) == nullptr);
+}
+
+SN_TEST(SwissMap, podKeys) {
+  Arena::Scope temp;
+
+  SwissMap<SwissMapPodKey, u32> map(temp);
+  map.put({1, 2, 3}, 1);
+  map.put({1, 2, 4}, 2);
+  map.put({1, 2, 3}, 3);
+
+  CHECK(map.numEntries == 2);
+  CHECK(*map.get({1, 2, 3}) == 3);
+  CHECK(*map.get({1, 2, 4}) == 2);
+  CHECK(map.get({2, 2, 3}) == nullptr);
+}
+
+SN_TEST(SwissMap, enumAndPointerKeys) {
+  Arena::Scope temp;
+
+  SwissMap<SwissMapEnumKey, u32> enums(temp);
+  enums.put(SwissMapEnumKey::A, 1);
+  enums.put(SwissMapEnumKey::C, 3);
+  CHECK(*enums.get(SwissMapEnumKey::A) == 1);
+  CHECK(enums.get(SwissMapEnumKey::B) == nullptr);
+  CHECK(*enums.get(SwissMapEnumKey::C) == 3);
+
+  u32 objects[4];
+  SwissMap<const u32 *, u32> pointers(temp);
+  for (u32 i = 0; i < 4; i++) {
+    pointers.put(&objects[i], i);
+  }
+  for (u32 i = 0; i < 4; i++) {
+    CHECK(*pointers.get(&objects[i]) == i);
+  }
+}
+
+SN_TEST(SwissMap, customHasher) {
+  Arena::Scope temp;
+
+  // Every key collides; the table must still tell them apart
+  SwissMap<u32, u32, SwissMapConstantHash> map(temp);
+  for (u32 i = 0; i < 100; i++) {
+    map.put(i, i + 1);
+  }
+  for (u32 i = 0; i < 100; i += 3) {
+    CHECK(map.remove(i));
+  }
+  for (u32 i = 0; i < 100; i++) {
+    u32 *value = map.get(i);
+    CHECK((value == nullptr) == (i % 3 == 0));
+    if (value != nullptr) {
+      CHECK(*value == i + 1);
+    }
+  }
+}
+
+SN_TEST(SwissMap, randomMatchesSwissTable) {
+  u64 x = 0x9E3779B97F4A7C15ULL;
+  auto next = [&x]() {
+    // xorshift64
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return x;
+  };
+
+  for (u32 round = 0; round < 8; round++) {
+    Arena::Scope temp;
+    SwissMap<u32, u32> map(temp);
+    SwissTable<u32, u32> reference(temp);
+
+    for (u32 i = 0; i < 1 << 13; i++) {
+      u32 key = u32(next() % 512);
+      switch (next() % 3) {
+        case 0: {
+          u32 *expected = reference.get(key);
+          u32 *value = map.get(key);
+          CHECK((expected == nullptr) == (value == nullptr));
+          if (value != nullptr) {
+            CHECK(*value == *expected);
+          }
+          break;
+        }
+        case 1: {
+          u32 value = u32(next());
+          reference.put(key, value);
+          CHECK(*map.put(key, value) == value);
+          break;
+        }
+        default: {
+          CHECK(map.remove(key) == reference.remove(key));
+          break;
+        }
+      }
+    }
+
+    CHECK(map.numEntries == reference.numEntries);
+  }
+}
+
+SN_TEST(SwissMap, getBatch) {
+  // The large map is big enough for getBatch to prefetch
+  for (u64 n : {u64(1000), u64(60000)}) {
+    Arena arena = createGrowableArena(64 * 1024 * 1024);
+    CHECK(arena.reserveBeg != nullptr);
+
+    SwissMap<u64, u64> map(&arena);
+    MutSlice<u64> keys;
+    MutSlice<u64 *> values;
+    alloc(&arena, n, keys);
+    alloc(&arena, n, values);
+    for (u64 i = 0; i < n; i++) {
+      keys[i] = i * 0x100000001ULL;
+      if (i % 4 != 0) {
+        map.put(keys[i], i);
+      }
+    }
+
+    map.getBatch(keys, values);
+    for (u64 i = 0; i < n; i++) {
+      CHECK(values[i] == map.get(keys[i]));
+      if (i % 4 != 0) {
+        CHECK(*values[i] == i);
+      } else {
+        CHECK(values[i] == nullptr);
+      }
+    }
+
+    destroyGrowableArena(&arena);
+  }
+}
+
+SN_TEST(SwissSet, putContainsRemove) {
+  Arena::Scope temp;
+
+  SwissSet<u64> set(temp);
+  CHECK(!set.contains(42));
+
+  for (u64 i = 0; i < 500; i++) {
+    CHECK(set.put(i * 3));
+  }
+  CHECK(!set.put(3));
+  CHECK(set.numEntries == 500);
+  // No values are stored next to the keys
+  CHECK(sizeof(SwissSet<u64>::Slot) == sizeof(u64));
+
+  for (u64 i = 0; i < 1500; i++) {
+    CHECK(set.contains(i) == (i % 3 == 0));
+  }
+
+  CHECK(set.remove(3));
+  CHECK(!set.remove(3));
+  CHECK(!set.contains(3));
+  CHECK(set.put(3));
+  CHECK(set.contains(3));
+}
@@ -186,6 +186,246 @@ SN_TEST(SwissTable, valueSlotReuseAfterRemove) {
   CHECK(*slot == 456);
 }
 
+SN_TEST(SwissTable, markFullSlotsDeleted) {
+  CHECK(impl::markFullSlotsDeleted(0x0180FE7F00FE8080) == 0xFE8080FEFE808080);
+  CHECK(impl::markFullSlotsDeleted(impl::CW_MASK_EMPTY) == impl::CW_MASK_EMPTY);
+}
+
+SN_TEST(SwissTable, deletedSlotsAreReclaimedWithoutGrowing) {
+  Arena::Scope temp;
+
+  // At most 16 keys are present at any time
+  SwissTable<u32, u32> table(temp);
+  for (u32 i = 0; i < 4000; i++) {
+    table.put(i, i);
+    if (i >= 16) {
+      CHECK(table.remove(i - 16));
+    }
+  }
+
+  CHECK(table.numEntries == 16);
+  CHECK(table.controlWords.length <= 8);
+  for (u32 i = 0; i < 4000; i++) {
+    u32 *slot = table.get(i);
+    CHECK((slot != nullptr) == (i >= 4000 - 16));
+  }
+}
+
+SN_TEST(SwissTable, valuePointersSurviveRehash) {
+  Arena::Scope temp;
+
+  SwissTable<u32, u32> table(temp);
+  u32 *first = table.put(0u, 123);
+  for (u32 i = 1; i < 1000; i++) {
+    table.put(i, i);
+    if (i % 3 == 0) {
+      table.remove(i);
+    }
+  }
+
+  CHECK(table.get(0u) == first);
+  CHECK(*first == 123);
+  for (u32 i = 1; i < 1000; i++) {
+    u32 *slot = table.get(i);
+    if (i % 3 == 0) {
+      CHECK(slot == nullptr);
+    } else {
+      CHECK(slot != nullptr);
+      CHECK(*slot == i);
+    }
+  }
+}
+
+SN_TEST(SwissTable, reserve) {
+  Arena::Scope temp;
+
+  SwissTable<u32, u32> table(temp);
+  table.put(1000u, 1000);
+  table.reserve(1000);
+  const size_t numGroups = table.controlWords.length;
+  CHECK(numGroups * 7 >= 1000);
+
+  for (u32 i = 0; i < 1000; i++) {
+    table.put(i, i);
+  }
+  CHECK(table.controlWords.length == numGroups);
+  CHECK(table.numEntries == 1001);
+  for (u32 i = 0; i <= 1000; i++) {
+    CHECK(*table.get(i) == i);
+  }
+
+  // Never shrinks
+  table.reserve(1);
+  CHECK(table.controlWords.length == numGroups);
+}
+
+SN_TEST(SwissTable, getBatch) {
+  // The large table is big enough for getBatch to prefetch
+  for (u32 n : {u32(501), u32(30000)}) {
+    Arena arena = createGrowableArena(64 * 1024 * 1024);
+    CHECK(arena.reserveBeg != nullptr);
+
+    SwissTable<u32, u32> table(&arena);
+    u32 *ids = alloc<u32>(&arena, n);
+    MutSlice<Slice<u32>> keys;
+    MutSlice<u32 *> values;
+    alloc(&arena, n, keys);
+    alloc(&arena, n, values);
+    for (u32 i = 0; i < n; i++) {
+      ids[i] = i;
+      keys[i] = ids[i];
+    }
+
+    // Empty table
+    table.getBatch(keys, values);
+    for (u32 i = 0; i < n; i++) {
+      CHECK(values[i] == nullptr);
+    }
+
+    for (u32 i = 0; i < n; i += 2) {
+      table.put(ids[i], i * 10);
+    }
+
+    // The number of keys is not a multiple of the batch size
+    table.getBatch(keys, values);
+    for (u32 i = 0; i < n; i++) {
+      CHECK(values[i] == table.get(ids[i]));
+      if (i % 2 == 0) {
+        CHECK(*values[i] == i * 10);
+      } else {
+        CHECK(values[i] == nullptr);
+      }
+    }
+
+    destroyGrowableArena(&arena);
+  }
+}
+
+SN_TEST(SwissTable, iterate) {
+  Arena::Scope temp;
+
+  SwissTable<u32, u32> table(temp);
+  for (auto entry : table) {
+    (void)entry;
+    CHECK(0);
+  }
+
+  for (u32 i = 0; i < 300; i++) {
+    table.put(i, i * 2);
+  }
+  for (u32 i = 0; i < 300; i += 3) {
+    table.remove(i);
+  }
+
+  bool visited[300] = {};
+  size_t numVisited = 0;
+  for (auto entry : table) {
+    CHECK(entry.key.length == 1);
+    u32 key = entry.key[0];
+    CHECK(key % 3 != 0);
+    CHECK(!visited[key]);
+    CHECK(entry.value == key * 2);
+    CHECK(table.resolve(entry.handle) == &entry.value);
+    visited[key] = true;
+    numVisited += 1;
+  }
+  CHECK(numVisited == table.numEntries);
+}
+
+SN_TEST(SwissTable, removeWhileIterating) {
+  Arena::Scope temp;
+
+  SwissTable<u32, u32> table(temp);
+  for (u32 i = 0; i < 500; i++) {
+    table.put(i, i);
+  }
+
+  // Removes the current entry, and the next key, which may not have been
+  // visited yet
+  size_t numVisited = 0;
+  for (auto entry : table) {
+    u32 key = entry.key[0];
+    CHECK(entry.value == key);
+    numVisited += 1;
+    if (key % 2 == 0) {
+      CHECK(table.remove(entry.handle));
+      table.remove(key + 1);
+    }
+  }
+
+  CHECK(numVisited <= 500);
+  CHECK(table.values.length == table.numEntries);
+  size_t numLeft = 0;
+  for (auto entry : table) {
+    u32 key = entry.key[0];
+    CHECK(entry.value == key);
+    CHECK(*table.get(key) == key);
+    CHECK(table.get(key - key % 2) == nullptr);
+    numLeft += 1;
+  }
+  CHECK(numLeft == table.numEntries);
+}
+
+SN_TEST(SwissTable, valuesAreCompacted) {
+  Arena::Scope temp;
+
+  // At most 100 keys are present at any time; the values must not pile up
+  SwissTable<u32, u32> table(temp);
+  for (u32 i = 0; i < 5000; i++) {
+    table.put(i, i);
+    if (i >= 100) {
+      CHECK(table.remove(i - 100));
+    }
+    CHECK(table.values.length == table.numEntries);
+  }
+
+  CHECK(table.values.numSegments <= 2);
+  CHECK(table.handles.length <= 101);
+  for (u32 i = 0; i < 5000; i++) {
+    u32 *slot = table.get(i);
+    CHECK((slot != nullptr) == (i >= 4900));
+    if (slot != nullptr) {
+      CHECK(*slot == i);
+    }
+  }
+}
+
+SN_TEST(SwissTable, handlesSurviveRemovalsAndRehashes) {
+  Arena::Scope temp;
+
+  SwissTable<u32, u32> table(temp);
+  using Handle = SwissTable<u32, u32>::Handle;
+
+  CHECK(table.resolve(Handle{}) == nullptr);
+  CHECK(table.handleOf(1u).index == table.INVALID_INDEX);
+
+  table.put(1000u, 1000);
+  Handle handle = table.handleOf(1000u);
+  CHECK(*table.resolve(handle) == 1000);
+
+  // Removals move values around, insertions rehash the table
+  for (u32 i = 0; i < 1000; i++) {
+    table.put(i, i);
+    if (i % 4 == 0) {
+      table.remove(i / 2);
+    }
+  }
+  CHECK(*table.resolve(handle) == 1000);
+  CHECK(table.resolve(handle) == table.get(1000u));
+
+  CHECK(table.remove(handle));
+  CHECK(table.resolve(handle) == nullptr);
+  CHECK(table.get(1000u) == nullptr);
+  CHECK(!table.remove(handle));
+
+  // The freed handle is reused for a new key, but the old one stays dead
+  table.put(2000u, 2000);
+  Handle other = table.handleOf(2000u);
+  CHECK(other.index == handle.index);
+  CHECK(table.resolve(handle) == nullptr);
+  CHECK(*table.resolve(other) == 2000);
+}
+
 static constexpr u64 a =
     6364136223846793005ULL; /* see TAOCP Vol 2, 3.3.4, page 108 */
 static constexpr u64 c = 9754186451795953191ULL; /* some random start value */
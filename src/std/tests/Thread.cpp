@@ -207,3 +207,446 @@ SN_TEST(WorkerPool, init) {
 
   CHECK(mask == expected);
 }
+
+static WorkerPool *createWorkStealingPool(Arena *arena, u32 numThreads) {
+  WorkerPoolCreateInfo createInfo = {
+      .numThreads = numThreads,
+      .workerInitializer = {},
+      .scheduler = WorkerPoolScheduler::WorkStealing,
+  };
+  return createWorkerPool(arena, createInfo);
+}
+
+SN_TEST(WorkerPool, workStealing_one_thread) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  WorkerPool *wp = createWorkStealingPool(temp, 1);
+
+  auto func = [](const Dispatch *D) {
+    size_t *buf = &D->parametersAs<size_t>();
+    buf[D->threadIndex.x] = D->threadIndex.x;
+  };
+
+  WorkContract *wc = wp->createWorkContract(temp, func);
+
+  size_t buffer[32];
+  for (u32 i = 0; i < 32; i++) {
+    buffer[i] = 0xFFFFFFFF;
+  }
+
+  wp->dispatch(wc, buffer, 32);
+
+  wp->release(wc);
+
+  for (u32 i = 0; i < 32; i++) {
+    CHECK(buffer[i] == i);
+  }
+
+  wp->shutdown();
+}
+
+SN_TEST(WorkerPool, workStealing_multi_thread) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  WorkerPool *wp = createWorkStealingPool(temp, 8);
+
+  auto func = [](const Dispatch *D) {
+    u32 *buf = &D->parametersAs<u32>();
+    u32 idx = D->threadIndex.z * 64 + D->threadIndex.y * 8 + D->threadIndex.x;
+    buf[idx] = idx;
+  };
+
+  WorkContract *wc = wp->createWorkContract(temp, func);
+
+  // Three dimensional grid, dispatched repeatedly
+  u32 *buffer = alloc<u32>(temp, 4096);
+  for (u32 round = 0; round < 4; round++) {
+    for (u32 i = 0; i < 4096; i++) {
+      buffer[i] = 0xFFFFFFFF;
+    }
+
+    wp->dispatch(wc, buffer, 8, 8, 64);
+    wp->release(wc);
+
+    for (u32 i = 0; i < 4096; i++) {
+      CHECK(buffer[i] == i);
+    }
+  }
+
+  wp->shutdown();
+}
+
+namespace {
+struct TreeNode {
+  struct TreeCtx *ctx;
+  u32 index;
+};
+
+struct TreeCtx {
+  WorkerPool *wp;
+  WorkContract *wc;
+  TreeNode *nodes;
+  u32 numNodes;
+  std::atomic<u32> *visited;
+};
+}  // namespace
+
+SN_TEST(WorkerPool, workStealing_nestedDispatch) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  WorkerPool *wp = createWorkStealingPool(temp, 4);
+
+  // Every node dispatches its children from within the kernel
+  auto func = [](const Dispatch *D) {
+    TreeNode &node = D->parametersAs<TreeNode>();
+    TreeCtx *ctx = node.ctx;
+    ctx->visited[node.index].fetch_add(1);
+
+    for (u32 idxChild = 2 * node.index + 1;
+         idxChild <= 2 * node.index + 2 && idxChild < ctx->numNodes;
+         idxChild++) {
+      D->workerPool->dispatch(ctx->wc, &ctx->nodes[idxChild]);
+    }
+  };
+
+  TreeCtx ctx;
+  ctx.wp = wp;
+  ctx.wc = wp->createWorkContract(temp, func);
+  ctx.numNodes = 2047;
+  ctx.nodes = alloc<TreeNode>(temp, ctx.numNodes);
+  ctx.visited = alloc<std::atomic<u32>>(temp, ctx.numNodes);
+  for (u32 i = 0; i < ctx.numNodes; i++) {
+    ctx.nodes[i] = {&ctx, i};
+  }
+
+  wp->dispatch(ctx.wc, &ctx.nodes[0]);
+  wp->release(ctx.wc);
+
+  for (u32 i = 0; i < ctx.numNodes; i++) {
+    CHECK(ctx.visited[i].load() == 1);
+  }
+
+  wp->shutdown();
+}
+
+SN_TEST(WorkerPool, workStealing_init) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  auto init = [](const Dispatch *D) {
+    std::atomic<u32> &mask = D->parametersAs<std::atomic<u32>>();
+    mask.fetch_or(u32(1) << D->idxPhysicalThread);
+  };
+
+  std::atomic<u32> mask = 0;
+
+  WorkerPoolCreateInfo createInfo = {
+      .numThreads = 4,
+      .workerInitializer =
+          WorkerPoolWorkerInitializer{
+              .func = init,
+              .parameters = &mask,
+          },
+      .scheduler = WorkerPoolScheduler::WorkStealing,
+  };
+  WorkerPool *wp = createWorkerPool(temp, createInfo);
+
+  wp->shutdown();
+
+  CHECK(mask.load() == 0xF);
+}
+
+static void checkEveryIndexRunsOnce(WorkerPool *wp,
+                                    u32 grainSize,
+                                    u32 numThreadsX,
+                                    u32 numThreadsY,
+                                    u32 numThreadsZ) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  struct Params {
+    std::atomic<u8> *counters;
+    u32 numThreadsX, numThreadsY;
+  };
+
+  auto func = [](const Dispatch *D) {
+    Params &P = D->parametersAs<Params>();
+    const ThreadIndex &i = D->threadIndex;
+    size_t idx = (i.z * P.numThreadsY + i.y) * P.numThreadsX + i.x;
+    P.counters[idx].fetch_add(1);
+  };
+
+  const u32 numTotal = numThreadsX * numThreadsY * numThreadsZ;
+  Params params = {
+      .counters = alloc<std::atomic<u8>>(temp, numTotal),
+      .numThreadsX = numThreadsX,
+      .numThreadsY = numThreadsY,
+  };
+
+  WorkContract *wc = wp->createWorkContract(temp, func, 0, grainSize);
+  wp->dispatch(wc, &params, numThreadsX, numThreadsY, numThreadsZ);
+  wp->release(wc);
+
+  for (u32 i = 0; i < numTotal; i++) {
+    CHECK(params.counters[i].load() == 1);
+  }
+}
+
+SN_TEST(WorkerPool, rangeBatching) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  WorkerPool *wp = createWorkerPool(temp, 8);
+
+  checkEveryIndexRunsOnce(wp, 0, 40, 20, 25);
+  checkEveryIndexRunsOnce(wp, 1, 37, 3, 5);
+  checkEveryIndexRunsOnce(wp, 7, 10007, 1, 1);
+  checkEveryIndexRunsOnce(wp, 1000000, 3, 1, 7);
+
+  wp->shutdown();
+}
+
+SN_TEST(WorkerPool, workStealing_rangeBatching) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  WorkerPool *wp = createWorkStealingPool(temp, 8);
+
+  checkEveryIndexRunsOnce(wp, 0, 40, 20, 25);
+  checkEveryIndexRunsOnce(wp, 1, 37, 3, 5);
+  checkEveryIndexRunsOnce(wp, 7, 10007, 1, 1);
+  checkEveryIndexRunsOnce(wp, 1000000, 3, 1, 7);
+
+  wp->shutdown();
+}
+
+SN_TEST(WorkerPool, millionThreadIndices) {
+  auto func = [](const Dispatch *D) {
+    D->parametersAs<std::atomic<u64>>().fetch_add(1,
+                                                  std::memory_order_relaxed);
+  };
+
+  for (WorkerPoolScheduler scheduler :
+       {WorkerPoolScheduler::SignalTree, WorkerPoolScheduler::WorkStealing}) {
+    Arena::Scope temp = getScratch(nullptr, 0);
+    WorkerPoolCreateInfo createInfo = {
+        .numThreads = 4,
+        .workerInitializer = {},
+        .scheduler = scheduler,
+    };
+    WorkerPool *wp = createWorkerPool(temp, createInfo);
+
+    std::atomic<u64> counter = 0;
+    WorkContract *wc = wp->createWorkContract(temp, func);
+    wp->dispatch(wc, &counter, 1000, 1000);
+    wp->release(wc);
+    CHECK(counter.load() == 1000000);
+
+    wp->shutdown();
+  }
+}
+
+namespace {
+struct StageParams {
+  const u32 *input;
+  u32 *output;
+  u32 addend;
+};
+}  // namespace
+
+static void stageKernel(const Dispatch *D) {
+  StageParams &P = D->parametersAs<StageParams>();
+  size_t i = D->threadIndex.x;
+  P.output[i] = (P.input != nullptr ? P.input[i] : 0) + P.addend;
+}
+
+static void checkContinuations(WorkerPoolScheduler scheduler) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  WorkerPoolCreateInfo createInfo = {
+      .numThreads = 4,
+      .workerInitializer = {},
+      .scheduler = scheduler,
+  };
+  WorkerPool *wp = createWorkerPool(temp, createInfo);
+
+  constexpr u32 N = 1000;
+  u32 *a = alloc<u32>(temp, N);
+  u32 *b = alloc<u32>(temp, N);
+  u32 *c = alloc<u32>(temp, N);
+  u32 *d = alloc<u32>(temp, N);
+
+  for (u32 round = 0; round < 16; round++) {
+    Arena::Scope temp = getScratch(nullptr, 0);
+
+    // A -> B -> D and A -> C -> D
+    StageParams pA = {nullptr, a, round};
+    StageParams pB = {a, b, 1};
+    StageParams pC = {a, c, 2};
+
+    WorkContract *wcA = wp->createWorkContract(temp, stageKernel);
+    WorkContract *wcB = wp->createWorkContract(temp, stageKernel, 0, 1);
+    WorkContract *wcC = wp->createWorkContract(temp, stageKernel);
+    WorkContract *wcD = wp->createWorkContract(
+        temp, [](const Dispatch *D) {
+          StageParams &P = D->parametersAs<StageParams>();
+          size_t i = D->threadIndex.x;
+          P.output[i] = P.input[i] + P.input[N + i];
+        });
+
+    wp->dispatch(wcA, &pA, N);
+    wp->dispatchAfter(temp, wcB, wcA, &pB, N);
+    wp->dispatchAfter(temp, wcC, wcA, &pC, N);
+
+    // D reads the outputs of both B and C
+    u32 *bc = alloc<u32>(temp, 2 * N);
+    StageParams pBCopy = {b, bc, 0};
+    StageParams pCCopy = {c, bc + N, 0};
+    WorkContract *wcCopyB = wp->createWorkContract(temp, stageKernel);
+    WorkContract *wcCopyC = wp->createWorkContract(temp, stageKernel);
+    wp->dispatchAfter(temp, wcCopyB, wcB, &pBCopy, N);
+    wp->dispatchAfter(temp, wcCopyC, wcC, &pCCopy, N);
+
+    StageParams pD = {bc, d, 0};
+    WorkContract *deps[] = {wcCopyB, wcCopyC};
+    wp->dispatchAfter(temp, wcD, Slice<WorkContract *>(deps, 2), &pD, N);
+
+    wp->release(wcD);
+    for (u32 i = 0; i < N; i++) {
+      CHECK(d[i] == 2 * round + 3);
+    }
+
+    wp->release(wcA);
+    wp->release(wcB);
+    wp->release(wcC);
+    wp->release(wcCopyB);
+    wp->release(wcCopyC);
+  }
+
+  // Dependencies that are already finished don't hold up the dispatch
+  StageParams pA = {nullptr, a, 5};
+  StageParams pB = {a, b, 1};
+  WorkContract *wcA = wp->createWorkContract(temp, stageKernel);
+  WorkContract *wcB = wp->createWorkContract(temp, stageKernel);
+  wp->dispatch(wcA, &pA, N);
+  wp->release(wcA);
+  wp->dispatchAfter(temp, wcB, wcA, &pB, N);
+  wp->release(wcB);
+  for (u32 i = 0; i < N; i++) {
+    CHECK(b[i] == 6);
+  }
+
+  wp->shutdown();
+}
+
+SN_TEST(WorkerPool, continuations) {
+  checkContinuations(WorkerPoolScheduler::SignalTree);
+}
+
+SN_TEST(WorkerPool, workStealing_continuations) {
+  checkContinuations(WorkerPoolScheduler::WorkStealing);
+}
+
+namespace {
+struct NestedParams {
+  WorkerPool *wp;
+  WorkContract **children;
+  std::atomic<u32> *counters;
+};
+}  // namespace
+
+static void checkNestedRelease(WorkerPoolScheduler scheduler) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  WorkerPoolCreateInfo createInfo = {
+      .numThreads = 2,
+      .workerInitializer = {},
+      .scheduler = scheduler,
+  };
+  WorkerPool *wp = createWorkerPool(temp, createInfo);
+
+  auto childFunc = [](const Dispatch *D) {
+    D->parametersAs<std::atomic<u32>>().fetch_add(1);
+  };
+
+  // More parents than workers; every parent blocks on its child contract
+  constexpr u32 NumParents = 8;
+  NestedParams params = {
+      .wp = wp,
+      .children = alloc<WorkContract *>(temp, NumParents),
+      .counters = alloc<std::atomic<u32>>(temp, NumParents),
+  };
+  for (u32 i = 0; i < NumParents; i++) {
+    params.children[i] = wp->createWorkContract(temp, childFunc, 0, 1);
+  }
+
+  auto parentFunc = [](const Dispatch *D) {
+    NestedParams &P = D->parametersAs<NestedParams>();
+    size_t i = D->threadIndex.x;
+    P.wp->dispatch(P.children[i], &P.counters[i], 64);
+    P.wp->release(P.children[i]);
+    CHECK(P.counters[i].load() == 64);
+  };
+
+  WorkContract *wc = wp->createWorkContract(temp, parentFunc, 0, 1);
+  wp->dispatch(wc, &params, NumParents);
+  wp->release(wc);
+
+  for (u32 i = 0; i < NumParents; i++) {
+    CHECK(params.counters[i].load() == 64);
+  }
+
+  wp->shutdown();
+}
+
+SN_TEST(WorkerPool, nestedRelease) {
+  checkNestedRelease(WorkerPoolScheduler::SignalTree);
+}
+
+SN_TEST(WorkerPool, workStealing_nestedRelease) {
+  checkNestedRelease(WorkerPoolScheduler::WorkStealing);
+}
+
+static void checkReleaseHelps(WorkerPoolScheduler scheduler) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  WorkerPoolCreateInfo createInfo = {
+      .numThreads = 1,
+      .workerInitializer = {},
+      .scheduler = scheduler,
+  };
+  WorkerPool *wp = createWorkerPool(temp, createInfo);
+  CHECK(wp->numWorkerThreads() == 1);
+
+  struct Params {
+    std::atomic<bool> flag;
+    std::atomic<u32> maskThreads;
+  };
+
+  // One contract waits for the other to run; with a single worker, at least
+  // one of them has to run on the releasing thread
+  auto waitFunc = [](const Dispatch *D) {
+    Params &P = D->parametersAs<Params>();
+    P.maskThreads.fetch_or(u32(1) << D->idxPhysicalThread);
+    while (!P.flag.load()) {
+      std::this_thread::yield();
+    }
+  };
+  auto signalFunc = [](const Dispatch *D) {
+    Params &P = D->parametersAs<Params>();
+    P.maskThreads.fetch_or(u32(1) << D->idxPhysicalThread);
+    P.flag.store(true);
+  };
+
+  Params params;
+  params.flag.store(false);
+  params.maskThreads.store(0);
+
+  WorkContract *wcWait = wp->createWorkContract(temp, waitFunc);
+  WorkContract *wcSignal = wp->createWorkContract(temp, signalFunc);
+  wp->dispatch(wcWait, &params);
+  wp->dispatch(wcSignal, &params);
+  wp->release(wcWait);
+  wp->release(wcSignal);
+
+  CHECK(params.flag.load());
+  CHECK(params.maskThreads.load() == 0b11);
+
+  wp->shutdown();
+}
+
+SN_TEST(WorkerPool, releaseHelps) {
+  checkReleaseHelps(WorkerPoolScheduler::SignalTree);
+}
+
+SN_TEST(WorkerPool, workStealing_releaseHelps) {
+  checkReleaseHelps(WorkerPoolScheduler::WorkStealing);
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2026 Daniel Meszaros
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <std/Check.h>
+#include <std/Testing.hpp>
+#include <std/WorkStealingDeque.hpp>
+#include <std/os/Thread.hpp>
+
+#include <atomic>
+
+SN_TEST(WorkStealingDeque, popIsLifo) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  WorkStealingDeque<u32> d;
+  d.init(temp, 16);
+
+  CHECK(!d.pop());
+  CHECK(d.push(1));
+  CHECK(d.push(2));
+  CHECK(d.push(3));
+  CHECK(d.sizeApprox() == 3);
+
+  CHECK(*d.pop() == 3);
+  CHECK(*d.pop() == 2);
+  CHECK(*d.pop() == 1);
+  CHECK(!d.pop());
+}
+
+SN_TEST(WorkStealingDeque, stealIsFifo) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  WorkStealingDeque<u32> d;
+  d.init(temp, 16);
+
+  CHECK(!d.steal());
+  CHECK(d.push(1));
+  CHECK(d.push(2));
+  CHECK(d.push(3));
+
+  CHECK(*d.steal() == 1);
+  CHECK(*d.pop() == 3);
+  CHECK(*d.steal() == 2);
+  CHECK(!d.steal());
+  CHECK(!d.pop());
+}
+
+SN_TEST(WorkStealingDeque, full) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  WorkStealingDeque<u32> d;
+  d.init(temp, 4);
+
+  for (u32 i = 0; i < 4; i++) {
+    CHECK(d.push(i));
+  }
+  CHECK(!d.push(4));
+
+  CHECK(*d.steal() == 0);
+  CHECK(d.push(4));
+  CHECK(*d.pop() == 4);
+}
+
+namespace {
+constexpr u32 NumItems = 4096;
+constexpr u32 NumThieves = 3;
+
+struct StealCtx {
+  WorkStealingDeque<u32> deque;
+  std::atomic<u32> numTaken;
+  std::atomic<u8> seen[NumItems];
+};
+
+void take(StealCtx *ctx, u32 item) {
+  CHECK(item < NumItems);
+  u8 prev = ctx->seen[item].fetch_add(1);
+  CHECK(prev == 0);
+  ctx->numTaken.fetch_add(1);
+}
+}  // namespace
+
+SN_TEST(WorkStealingDeque, concurrentSteal) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+
+  StealCtx *ctx = alloc<StealCtx>(temp);
+  ctx->deque.init(temp, 64);
+
+  auto thief = [](void *arg) {
+    StealCtx *ctx = reinterpret_cast<StealCtx *>(arg);
+    while (ctx->numTaken.load() != NumItems) {
+      if (Optional<u32> item = ctx->deque.steal()) {
+        take(ctx, *item);
+      }
+    }
+  };
+
+  Thread thieves[NumThieves];
+  for (u32 i = 0; i < NumThieves; i++) {
+    thieves[i] = Thread::create({.entryPoint = thief, .param = ctx}).unwrap();
+  }
+
+  // Owner pushes everything and pops every other element
+  for (u32 i = 0; i < NumItems; i++) {
+    while (!ctx->deque.push(i)) {
+      if (Optional<u32> item = ctx->deque.pop()) {
+        take(ctx, *item);
+      }
+    }
+
+    if (i % 2 == 0) {
+      if (Optional<u32> item = ctx->deque.pop()) {
+        take(ctx, *item);
+      }
+    }
+  }
+
+  while (Optional<u32> item = ctx->deque.pop()) {
+    take(ctx, *item);
+  }
+
+  for (u32 i = 0; i < NumThieves; i++) {
+    thieves[i].join();
+  }
+
+  CHECK(ctx->numTaken.load() == NumItems);
+  for (u32 i = 0; i < NumItems; i++) {
+    CHECK(ctx->seen[i].load() == 1);
+  }
+}
+
+SN_TEST(MpmcQueue, fifo) {
+  Arena::Scope temp = getScratch(nullptr, 0);
+  MpmcQueue<u64> q;
+  q.init(temp, 4);
+
+  CHECK(!q.dequeue());
+  for (u64 i = 0; i < 4; i++) {
+    CHECK(q.enqueue(i));
+  }
+  CHECK(!q.enqueue(4));
+
+  for (u64 i = 0; i < 4; i++) {
+    CHECK(*q.dequeue() == i);
+  }
+  CHECK(!q.dequeue());
+
+  // Wrap around
+  CHECK(q.enqueue(5));
+  CHECK(*q.dequeue() == 5);
+}